@@ -6,6 +6,11 @@ export type Vec3 = {number}
 export type Color = {number}
 export type Quat = {number}
 export type DVec3 = {number}
+-- native Luau vector, accepted everywhere Vec3 or DVec3 is
+export type Vector = any
+declare vector: {
+	create : (number, number, number) -> Vector,
+}
 declare ImGui: {
 	AlignTextToFramePadding : () -> (),
 	Begin : (string, boolean?) -> (boolean, boolean?),
@@ -339,6 +344,7 @@ type navmesh_zone_component =  {
 	max_climb: number,
 	autoload: boolean,
 	detailed: boolean,
+	streamed: boolean,
 	load: (navmesh_zone_component) -> boolean,
 	drawNavmesh: (navmesh_zone_component, DVec3, boolean, boolean, boolean) -> (),
 	drawCompactHeightfield: (navmesh_zone_component) -> (),
@@ -361,6 +367,7 @@ type navmesh_agent_component =  {
 type physics_module = {
 	raycast: (physics_module, Vec3, Vec3, number, Entity?) -> Entity?,
 	setGravity: (physics_module, Vec3) -> (),
+	enableAsyncSimulation: (physics_module, boolean) -> (),
 }
 
 type physical_heightfield_component =  {
@@ -635,6 +642,9 @@ export type Entity = {
 	rotation : any,
 	position : Vec3,
 	local_position : Vec3,
+	vposition : Vector,
+	vlocal_position : Vector,
+	vscale : Vector,
 	first_child : Entity?,
 	next_sibling : Entity?,
 	scale : Vec3,
@@ -722,6 +732,11 @@ declare this : Entity
 		writeFile : (string, string) -> boolean,
 		createPipeline : () -> Pipeline,
 		destroyPipeline : (Pipeline) -> (),
+		getEntityPositions : (World, entities: buffer | {Entity | number}, out: buffer?) -> buffer,
+		getEntityRotations : (World, entities: buffer | {Entity | number}, out: buffer?) -> buffer,
+		setEntityTransforms : (World, entities: buffer | {Entity | number}, positions: buffer?, rotations: buffer?) -> (),
+		getComponentProperties : (World, entities: buffer | {Entity | number}, component: string, property: string, out: buffer?) -> buffer,
+		setComponentProperties : (World, entities: buffer | {Entity | number}, component: string, property: string, values: buffer) -> (),
 		CursorType : {
 			DEFAULT : number,
 			SIZE_NS : number,
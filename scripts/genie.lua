@@ -1,3 +1,17 @@
+-- `engine` benchmarks link engine and plugins, benchmarks with `plugin` are built only if the plugin is
+local benchmarks = {
+	{ name = "frame_benchmark", engine = true },
+	{ name = "animation_benchmark", engine = true },
+	{ name = "physics_benchmark", engine = true, plugin = "physics", includedirs = { "../external/physx/include/" } },
+	{ name = "lua_benchmark", engine = true, plugin = "lua", includedirs = { "../external/luau/include/" } },
+	{ name = "core_benchmarks" },
+}
+
+local benchmark_names = {}
+for _, benchmark in ipairs(benchmarks) do
+	table.insert(benchmark_names, benchmark.name)
+end
+
 -- simple options
 local simple_options = {
 	{ "plugins", "Add plugins to project, can be a comma-separated list, e.g. --plugins=pluginA,pluginB" },
@@ -23,6 +37,8 @@ local simple_options = {
 	-- Splitting in projects also causes reporting by vcperf or Compile Score to be much less useful
 	{ "split-projects", "Split into project per plugin. Dynamic library plugins are always split." },
 	{ "with-tests", "Build test projects." },
+	{ "with-tools", "Build command line tools (profiler_export)." },
+	{ "with-benchmarks", "Build benchmarks (" .. table.concat(benchmark_names, ", ") .. ")." },
 }
 for _, opt in ipairs(simple_options) do
 	newoption { trigger = opt[1], description = opt[2] }
@@ -44,6 +60,8 @@ newoption {
 build_studio = not _OPTIONS["no-studio"]
 build_app = _OPTIONS["with-app"] or false
 build_tests = _OPTIONS["with-tests"] or false
+build_tools = _OPTIONS["with-tools"] or false
+build_benchmarks = _OPTIONS["with-benchmarks"] or false
 local embed_resources = _OPTIONS["embed-resources"]
 local working_dir = _OPTIONS["working-dir"]
 local debug_args = _OPTIONS["debug-args"]
@@ -175,6 +193,10 @@ function exe_project(name)
 	project(name)
 end
 
+function isBenchmarkBuilt(benchmark)
+	return not benchmark.plugin or hasPlugin(benchmark.plugin)
+end
+
 -- Use this in plugins (which can be static libs) to link other plugins (also possibly static libs).
 -- "Linking" static libs together just creates a dependency between them and hurts build parallelism. So we don't do that.
 function dynamic_link_plugin(plugin_name)
@@ -212,6 +234,15 @@ function plugin(plugin_name)
 				links {plugin_name}
 		end
 
+		if build_benchmarks then
+			for _, benchmark in ipairs(benchmarks) do
+				if benchmark.engine and isBenchmarkBuilt(benchmark) then
+					exe_project(benchmark.name)
+						links {plugin_name}
+				end
+			end
+		end
+
 		lib_project(plugin_name)
 		libType()
 
@@ -368,12 +399,18 @@ lib_project "core"
 	-- Run meta tool before any compilation to generate reflection headers and Lua bindings
 	prebuildcommands { "msbuild $(SolutionDir)meta.vcxproj /p:Configuration=$(Configuration) /p:Platform=$(Platform) /verbosity:minimal", "cd $(ProjectDir)../../../ && $(SolutionDir)bin\\$(Configuration)\\meta.exe" }
 
+	if dynamic_plugins then
+		defines { "LZ4_DLL_EXPORT" }
+	end
+
 	files { "../src/core/**.h",
 			"../src/core/**.c",
 			"../src/core/**.cpp",
 			"../src/core/**.inl",
 			"genie.lua",
-			"../external/wyhash/**.*"
+			"../external/wyhash/**.*",
+			"../external/lz4/**.c",
+			"../external/lz4/**.h",
 	}
 
 	configuration { "linux" }
@@ -388,7 +425,6 @@ lib_project "engine"
 
 	if dynamic_plugins then
 		linkLib "freetype"
-		defines { "LZ4_DLL_EXPORT" }
 	end
 
 	files { "../src/engine/**.h",
@@ -399,8 +435,6 @@ lib_project "engine"
 			"../external/imgui/**.h",
 			"../external/imgui/**.cpp",
 			"../external/imgui/**.inl",
-			"../external/lz4/**.c",
-			"../external/lz4/**.h",
 	}
 	excludes {
 		"../external/imgui/imgui_demo.cpp",
@@ -1038,4 +1072,68 @@ if build_tests then
 		debugdir "../data"
 		
 		linkPlatformLibs()
-end
\ No newline at end of file
+end
+
+-- command line tools
+if build_tools then
+	exe_project "profiler_export"
+		kind "ConsoleApp"
+		defaultConfigurations()
+		includedirs { "../src" }
+		files { "../src/tools/profiler_export.cpp" }
+
+		if split_projects then
+			links { "core" }
+		else
+			links { "engine_merged" }
+		end
+
+		linkPlatformLibs()
+end
+
+-- benchmarks
+if build_benchmarks then
+	for _, benchmark in ipairs(benchmarks) do
+		if isBenchmarkBuilt(benchmark) then
+			exe_project(benchmark.name)
+				kind "ConsoleApp"
+				defaultConfigurations()
+				includedirs { "../src" }
+				if benchmark.includedirs then includedirs(benchmark.includedirs) end
+				files {
+					"../src/benchmarks/benchmark.cpp",
+					"../src/benchmarks/benchmark.h",
+					"../src/benchmarks/" .. benchmark.name .. ".cpp"
+				}
+
+				if benchmark.engine then
+					debugdir "../data"
+
+					buildPluginDefines()
+
+					if split_projects then
+						links { "core", "engine" }
+					else
+						links { "engine_merged" }
+					end
+
+					if not dynamic_plugins then
+						if hasPlugin "lua" then linkLib "Luau" end
+						if hasPlugin "physics" then linkPhysX() end
+						if use_basisu then linkLib "basisu" end
+						linkLib "freetype"
+					end
+
+					libdirs { "../external/pix/bin/x64" }
+				else
+					if split_projects then
+						links { "core" }
+					else
+						links { "engine_merged" }
+					end
+				end
+
+				linkPlatformLibs()
+		end
+	end
+end
@@ -21,12 +21,89 @@ Animation::Animation(const Path& path, ResourceManager& resource_manager, IAlloc
 	, m_const_translations(m_allocator)
 	, m_rotations(m_allocator)
 	, m_const_rotations(m_allocator)
+	, m_keyframed_translations(m_allocator)
+	, m_keyframed_rotations(m_allocator)
+	, m_translation_batches(m_allocator)
+	, m_rotation_batches(m_allocator)
+	, m_covered_bones(m_allocator)
 	, m_root_motion(m_allocator)
 {
 }
 
 
+static u32 getKeyFrame(const u8* frames, u32 key) {
+	u16 frame;
+	memcpy(&frame, frames + key * sizeof(frame), sizeof(frame));
+	return frame;
+}
+
+// index of the last key at or before `frame`, `hint` is the key found by the previous sample
+static u32 findKey(const u8* frames, u32 keys_count, u32 frame, u32 hint) {
+	u32 lo = 0;
+	u32 hi = keys_count - 1;
+	if (hint < hi && getKeyFrame(frames, hint) <= frame) {
+		// sequential playback, `frame` is usually in the same or in the next key
+		if (frame < getKeyFrame(frames, hint + 1)) return hint;
+		if (frame < getKeyFrame(frames, hint + 2)) return hint + 1;
+		lo = hint + 2;
+	}
+	// frames[lo] <= frame < frames[hi], last key is at frame count, so it's never returned
+	while (hi - lo > 1) {
+		const u32 mid = (lo + hi) / 2;
+		if (getKeyFrame(frames, mid) <= frame) lo = mid;
+		else hi = mid;
+	}
+	return lo;
+}
+
 struct AnimationSampler {
+	template <typename Track>
+	static LUMIX_FORCE_INLINE float4 unpackRotation(const u8* stream, u32 offset, const Track& track) {
+		u64 packed;
+		memcpy(&packed, &stream[offset / 8], sizeof(packed));
+		packed >>= offset & 7;
+
+		bool is_negative = packed & 1;
+		packed >>= 1;
+
+		// unpack
+		u64 mask_x = (u64(1) << track.bitsizes[0]) - 1;
+		u64 mask_y = (u64(1) << track.bitsizes[1]) - 1;
+		u64 mask_z = (u64(1) << track.bitsizes[2]) - 1;
+
+		u64 packed_y = packed >> track.bitsizes[0];
+		u64 packed_z = packed_y >> track.bitsizes[1];
+
+		Vec3 v3;
+		v3.x = track.min.x + track.to_range.x * float(packed & mask_x);
+		v3.y = track.min.y + track.to_range.y * float(packed_y & mask_y);
+		v3.z = track.min.z + track.to_range.z * float(packed_z & mask_z);
+
+		float skipped = sqrtf(maximum(0.f, 1 - dot(v3, v3))) * (is_negative ? -1 : 1);
+
+		switch (track.skipped_channel) {
+			case 0: return f4Init(skipped, v3.x, v3.y, v3.z);
+			case 1: return f4Init(v3.x, skipped, v3.y, v3.z);
+			case 2: return f4Init(v3.x, v3.y, skipped, v3.z);
+			case 3: return f4Init(v3.x, v3.y, v3.z, skipped);
+			default: ASSERT(false); return f4Splat(0);
+		}
+	}
+
+	static LUMIX_FORCE_INLINE Vec3 unpackTranslation(const u8* stream, u32 offset, const Animation::KeyframedTranslationTrack& track) {
+		u64 packed;
+		memcpy(&packed, &stream[offset / 8], sizeof(packed));
+		packed >>= offset & 7;
+
+		Vec3 res;
+		res.x = track.min.x + track.to_range.x * float(packed & ((u64(1) << track.bitsizes[0]) - 1));
+		packed >>= track.bitsizes[0];
+		res.y = track.min.y + track.to_range.y * float(packed & ((u64(1) << track.bitsizes[1]) - 1));
+		packed >>= track.bitsizes[1];
+		res.z = track.min.z + track.to_range.z * float(packed & ((u64(1) << track.bitsizes[2]) - 1));
+		return res;
+	}
+
 	static float4 getRotation(const Animation& anim, u32 frame, const Animation::RotationTrack& track, float t) {
 		const auto& rotations = anim.m_rotations;
 		ASSERT(&track >= rotations.begin() && &track < rotations.end());
@@ -36,62 +113,128 @@ struct AnimationSampler {
 			return simd_nlerp(a, b, t);
 		}
 
-		// read packed data
 		const u32 offset1 = anim.m_rotations_frame_size_bits * frame + track.offset_bits;
 		const u32 offset2 = offset1 + anim.m_rotations_frame_size_bits;
+		const float4 q1 = unpackRotation(anim.m_rotation_stream, offset1, track);
+		const float4 q2 = unpackRotation(anim.m_rotation_stream, offset2, track);
+		
+		// interpolate
+		return simd_nlerp(q1, q2, t);
+	}
 
-		u64 packed1;
-		memcpy(&packed1, &anim.m_rotation_stream[offset1 / 8], sizeof(packed1));
-		packed1 >>= offset1 & 7;
-
-		u64 packed2;
-		memcpy(&packed2, &anim.m_rotation_stream[offset2 / 8], sizeof(packed2));
-		packed2 >>= offset2 & 7;
+	// `sample` is fractional frame
+	static LUMIX_FORCE_INLINE float getKeyT(const u8* frames, u32 key, float sample) {
+		const u32 frame0 = getKeyFrame(frames, key);
+		const u32 frame1 = getKeyFrame(frames, key + 1);
+		return (sample - frame0) / float(frame1 - frame0);
+	}
 
-		bool is_negative1 = packed1 & 1;
-		packed1 >>= 1;
+	static LUMIX_FORCE_INLINE Vec3 getTranslation(const Animation::KeyframedTranslationTrack& track, u32 key, float sample) {
+		const u32 bitsize = track.bitsizes[0] + track.bitsizes[1] + track.bitsizes[2];
+		const Vec3 a = unpackTranslation(track.values, bitsize * key, track);
+		const Vec3 b = unpackTranslation(track.values, bitsize * (key + 1), track);
+		return lerp(a, b, getKeyT(track.frames, key, sample));
+	}
 
-		bool is_negative2 = packed2 & 1;
-		packed2 >>= 1;
+	static LUMIX_FORCE_INLINE float4 getRotation(const Animation::KeyframedRotationTrack& track, u32 key, float sample) {
+		const u32 bitsize = track.bitsizes[0] + track.bitsizes[1] + track.bitsizes[2] + 1;
+		const float4 a = unpackRotation(track.values, bitsize * key, track);
+		const float4 b = unpackRotation(track.values, bitsize * (key + 1), track);
+		return simd_nlerp(a, b, getKeyT(track.frames, key, sample));
+	}
 
-		Vec3 v3_1;
-		Vec3 v3_2;
+	static u32* getCursorKeys(const Animation& anim, Animation::Cursor* cursor) {
+		if (!cursor) return nullptr;
+		const u32 count = anim.m_keyframed_translations.size() + anim.m_keyframed_rotations.size();
+		if (count == 0) return nullptr;
+		if (cursor->animation != &anim || cursor->keys.size() != (i32)count) {
+			cursor->animation = &anim;
+			cursor->keys.resize(count);
+			for (u32& key : cursor->keys) key = 0;
+		}
+		return cursor->keys.begin();
+	}
 
-		// unpack
-		u64 mask_x = (u64(1) << track.bitsizes[0]) - 1;
-		u64 mask_y = (u64(1) << track.bitsizes[1]) - 1;
-		u64 mask_z = (u64(1) << track.bitsizes[2]) - 1;
+	// dequantizes `lanes` (1-4) consecutive tracks, starting at `tracks`, of a single frame
+	// lanes past `lanes` repeat the last track, callers ignore them
+	template <bool has_sign, typename Track>
+	static LUMIX_FORCE_INLINE void unpackBatch(const u8* stream
+		, u32 frame_offset_bits
+		, const Track* tracks
+		, u32 lanes
+		, const Animation::TrackBatch& batch
+		, SOAVec3& out
+		, float4& sign)
+	{
+		alignas(16) float quantized[3][4];
+		alignas(16) float signs[4];
+		for (u32 lane = 0; lane < 4; ++lane) {
+			const Track& track = tracks[minimum(lane, lanes - 1)];
+			const u32 offset = frame_offset_bits + track.offset_bits;
+			u64 packed;
+			memcpy(&packed, &stream[offset / 8], sizeof(packed));
+			packed >>= offset & 7;
+			if constexpr (has_sign) {
+				signs[lane] = packed & 1 ? -1.f : 1.f;
+				packed >>= 1;
+			}
+			for (u32 i = 0; i < 3; ++i) {
+				quantized[i][lane] = float(packed & ((u64(1) << track.bitsizes[i]) - 1));
+				packed >>= track.bitsizes[i];
+			}
+		}
 
-		u64 packed1_y = packed1 >> track.bitsizes[0];
-		u64 packed1_z = packed1_y >> track.bitsizes[1];
-		
-		u64 packed2_y = packed2 >> track.bitsizes[0];
-		u64 packed2_z = packed2_y >> track.bitsizes[1];
+		out.x = f4LoadUnaligned(batch.min[0]) + f4LoadUnaligned(batch.to_range[0]) * f4Load(quantized[0]);
+		out.y = f4LoadUnaligned(batch.min[1]) + f4LoadUnaligned(batch.to_range[1]) * f4Load(quantized[1]);
+		out.z = f4LoadUnaligned(batch.min[2]) + f4LoadUnaligned(batch.to_range[2]) * f4Load(quantized[2]);
+		if constexpr (has_sign) sign = f4Load(signs);
+	}
 
-		v3_1.x = track.min.x + track.to_range.x * float(packed1 & mask_x);
-		v3_1.y = track.min.y + track.to_range.y * float(packed1_y & mask_y);
-		v3_1.z = track.min.z + track.to_range.z * float(packed1_z & mask_z);
-		
-		v3_2.x = track.min.x + track.to_range.x * float(packed2 & mask_x);
-		v3_2.y = track.min.y + track.to_range.y * float(packed2_y & mask_y);
-		v3_2.z = track.min.z + track.to_range.z * float(packed2_z & mask_z);
+	// same operations as getRotation, 4 tracks at once
+	static LUMIX_FORCE_INLINE SOAQuat unpackRotationBatch(const Animation& anim, u32 frame, u32 first, u32 lanes) {
+		const Animation::TrackBatch& batch = anim.m_rotation_batches[first / 4];
+		SOAVec3 v;
+		float4 sign;
+		unpackBatch<true>(anim.m_rotation_stream, anim.m_rotations_frame_size_bits * frame, &anim.m_rotations[first], lanes, batch, v, sign);
+
+		const float4 dot = v.x * v.x + v.y * v.y + v.z * v.z;
+		const float4 skipped = f4Sqrt(f4Max(f4Splat(0), f4Splat(1) - dot)) * sign;
+
+		// put the reconstructed component to `skipped_channel` of each lane
+		const float4 skip0 = f4LoadUnaligned(batch.skipped_mask[0]);
+		const float4 skip01 = f4LoadUnaligned(batch.skipped_mask[1]);
+		const float4 skip012 = f4LoadUnaligned(batch.skipped_mask[2]);
+		SOAQuat q;
+		q.x = f4Blend(v.x, skipped, skip0);
+		q.y = f4Blend(f4Blend(v.y, skipped, skip01), v.x, skip0);
+		q.z = f4Blend(f4Blend(v.z, skipped, skip012), v.y, skip01);
+		q.w = f4Blend(skipped, v.z, skip012);
+		return q;
+	}
 
-		float skipped1 = sqrtf(maximum(0.f, 1 - dot(v3_1, v3_1))) * (is_negative1 ? -1 : 1);
-		float skipped2 = sqrtf(maximum(0.f, 1 - dot(v3_2, v3_2))) * (is_negative2 ? -1 : 1);
+	// same operation order as simd_nlerp, so the results match it bit for bit
+	static LUMIX_FORCE_INLINE SOAQuat nlerpBatch(const SOAQuat& a, const SOAQuat& b, float t) {
+		const float4 d = (a.x * b.x + a.y * b.y) + (a.z * b.z + a.w * b.w);
+		const float4 t4 = f4Blend(f4Splat(t), f4Splat(-t), f4CmpLT(d, f4Splat(0)));
+		const float4 inv = f4Splat(1.0f - t);
+		SOAQuat q;
+		q.x = a.x * inv + b.x * t4;
+		q.y = a.y * inv + b.y * t4;
+		q.z = a.z * inv + b.z * t4;
+		q.w = a.w * inv + b.w * t4;
+
+		const float4 l = f4Div(f4Splat(1), f4Sqrt((q.x * q.x + q.y * q.y) + (q.z * q.z + q.w * q.w)));
+		q.x = q.x * l;
+		q.y = q.y * l;
+		q.z = q.z * l;
+		q.w = q.w * l;
+		return q;
+	}
 
-		float4 q1;
-		float4 q2;
-		
-		switch (track.skipped_channel) {
-			case 0: q1 = f4Init(skipped1, v3_1.x, v3_1.y, v3_1.z); q2 = f4Init(skipped2, v3_2.x, v3_2.y, v3_2.z); break;
-			case 1: q1 = f4Init(v3_1.x, skipped1, v3_1.y, v3_1.z); q2 = f4Init(v3_2.x, skipped2, v3_2.y, v3_2.z); break;
-			case 2: q1 = f4Init(v3_1.x, v3_1.y, skipped1, v3_1.z); q2 = f4Init(v3_2.x, v3_2.y, skipped2, v3_2.z); break;
-			case 3: q1 = f4Init(v3_1.x, v3_1.y, v3_1.z, skipped1); q2 = f4Init(v3_2.x, v3_2.y, v3_2.z, skipped2); break;
-			default: ASSERT(false); break;
-		}
-		
-		// interpolate
-		return simd_nlerp(q1, q2, t);
+	static LUMIX_FORCE_INLINE SOAVec3 lerpBatch(const SOAVec3& a, const SOAVec3& b, float t) {
+		const float4 inv = f4Splat(1.0f - t);
+		const float4 t4 = f4Splat(t);
+		return { a.x * inv + b.x * t4, a.y * inv + b.y * t4, a.z * inv + b.z * t4 };
 	}
 
 	static LUMIX_FORCE_INLINE LocalRigidTransform maskRootMotion(Animation::Flags flags, const LocalRigidTransform& transform) {
@@ -149,48 +292,138 @@ struct AnimationSampler {
 			}
 		}
 
-		for (u32 i = 0, c = anim.m_translations.size(); i < c; ++i) {
-			const Animation::TranslationTrack& track = anim.m_translations[i];
+		const u32 root_translation_idx = u32(anim.m_root_motion.translation_track_idx);
+		for (u32 first = 0, c = anim.m_translations.size(); first < c; first += 4) {
+			const u32 lanes = minimum(c - first, 4u);
+			const Animation::TrackBatch& batch = anim.m_translation_batches[first / 4];
+			const Animation::TranslationTrack* tracks = &anim.m_translations[first];
+
+			SOAVec3 pos0, pos1;
+			float4 unused;
+			unpackBatch<false>(anim.m_translation_stream, anim.m_translations_frame_size_bits * sample_idx, tracks, lanes, batch, pos0, unused);
+			unpackBatch<false>(anim.m_translation_stream, anim.m_translations_frame_size_bits * (sample_idx + 1), tracks, lanes, batch, pos1, unused);
+			const SOAVec3 anim_pos = lerpBatch(pos0, pos1, t);
+
+			alignas(16) float xs[4], ys[4], zs[4];
+			f4Store(xs, anim_pos.x);
+			f4Store(ys, anim_pos.y);
+			f4Store(zs, anim_pos.z);
+
+			for (u32 lane = 0; lane < lanes; ++lane) {
+				const Animation::TranslationTrack& track = tracks[lane];
+
+				if constexpr(use_mask) {
+					ASSERT(false);
+					//if (mask->bones.find(track.) == mask->bones.end()) continue;
+				}
+
+				Vec3 lane_pos(xs[lane], ys[lane], zs[lane]);
+				if (first + lane == root_translation_idx) {
+					lane_pos = lerp(anim.getTranslation(sample_idx, track), anim.getTranslation(sample_idx + 1, track), t);
+				}
+
+				if constexpr (use_weight) {
+					pos[track.bone_index] = lerp(pos[track.bone_index], lane_pos, weight);
+				}
+				else {
+					pos[track.bone_index] = lane_pos;
+				}
+			}
+		}
+
+		for (u32 i = 0, c = anim.m_const_rotations.size(); i < c; ++i) {
+			const Animation::ConstRotationTrack& track = anim.m_const_rotations[i];
 
 			if constexpr(use_mask) {
 				ASSERT(false);
 				//if (mask->bones.find(track.) == mask->bones.end()) continue;
 			}
 
-			Vec3 anim_pos = lerp(anim.getTranslation(sample_idx, track), anim.getTranslation(sample_idx + 1, track), t);
-
 			if constexpr (use_weight) {
-				pos[track.bone_index] = lerp(pos[track.bone_index], anim_pos, weight);
+				rot[track.bone_index] = simd_nlerp(rot[track.bone_index], track.value, weight);
 			}
 			else {
-				pos[track.bone_index] = anim_pos;
+				rot[track.bone_index] = track.value;
 			}
 		}
 
-		for (u32 i = 0, c = anim.m_const_rotations.size(); i < c; ++i) {
-			const Animation::ConstRotationTrack& track = anim.m_const_rotations[i];
+		const u32 root_rotation_idx = u32(anim.m_root_motion.rotation_track_idx);
+		for (u32 first = 0, c = anim.m_rotations.size(); first < c; first += 4) {
+			const u32 lanes = minimum(c - first, 4u);
+			SOAQuat anim_rots = nlerpBatch(unpackRotationBatch(anim, sample_idx, first, lanes), unpackRotationBatch(anim, sample_idx + 1, first, lanes), t);
+
+			alignas(16) float rots[16];
+			transposeStore(anim_rots, rots);
+
+			for (u32 lane = 0; lane < lanes; ++lane) {
+				const Animation::RotationTrack& track = anim.m_rotations[first + lane];
+				if constexpr(use_mask) {
+					ASSERT(false);
+					//if (mask->bones.find(track.) == mask->bones.end()) continue;
+				}
+
+				float4 anim_rot = f4Load(&rots[lane * 4]);
+				if (first + lane == root_rotation_idx) anim_rot = getRotation(anim, sample_idx, track, t);
+
+				if constexpr (use_weight) {
+					float4 rotf4 = f4LoadUnaligned(&rot[track.bone_index]);
+					rotf4 = simd_nlerp(rotf4, anim_rot, weight);
+					f4StoreUnaligned(&rot[track.bone_index], rotf4);
+				}
+				else {
+					f4StoreUnaligned(&rot[track.bone_index], anim_rot);
+				}
+			}
+		}
+
+		u32* cursor_keys = getCursorKeys(anim, ctx.cursor);
+		const u32 keyframed_translations_count = anim.m_keyframed_translations.size();
+		for (u32 i = 0; i < keyframed_translations_count; ++i) {
+			const Animation::KeyframedTranslationTrack& track = anim.m_keyframed_translations[i];
 
 			if constexpr(use_mask) {
 				ASSERT(false);
 				//if (mask->bones.find(track.) == mask->bones.end()) continue;
 			}
 
+			Vec3 anim_pos;
+			if (i == u32(anim.m_root_motion.keyframed_translation_track_idx)) {
+				anim_pos = lerp(anim.m_root_motion.pose_translations[sample_idx], anim.m_root_motion.pose_translations[sample_idx + 1], t);
+			}
+			else {
+				const u32 key = findKey(track.frames, track.keys_count, sample_idx, cursor_keys ? cursor_keys[i] : 0);
+				if (cursor_keys) cursor_keys[i] = key;
+				anim_pos = getTranslation(track, key, sample);
+			}
+
 			if constexpr (use_weight) {
-				rot[track.bone_index] = simd_nlerp(rot[track.bone_index], track.value, weight);
+				pos[track.bone_index] = lerp(pos[track.bone_index], anim_pos, weight);
 			}
 			else {
-				rot[track.bone_index] = track.value;
+				pos[track.bone_index] = anim_pos;
 			}
 		}
 
-		for (u32 i = 0, c = anim.m_rotations.size(); i < c; ++i) {
-			const Animation::RotationTrack& track = anim.m_rotations[i];
+		for (u32 i = 0, c = anim.m_keyframed_rotations.size(); i < c; ++i) {
+			const Animation::KeyframedRotationTrack& track = anim.m_keyframed_rotations[i];
+
 			if constexpr(use_mask) {
 				ASSERT(false);
 				//if (mask->bones.find(track.) == mask->bones.end()) continue;
 			}
 
-			float4 anim_rot = getRotation(anim, sample_idx, track, t);
+			float4 anim_rot;
+			if (i == u32(anim.m_root_motion.keyframed_rotation_track_idx)) {
+				float4 a = f4LoadUnaligned(&anim.m_root_motion.pose_rotations[sample_idx]);
+				float4 b = f4LoadUnaligned(&anim.m_root_motion.pose_rotations[sample_idx + 1]);
+				anim_rot = simd_nlerp(a, b, t);
+			}
+			else {
+				u32* cursor_key = cursor_keys ? &cursor_keys[keyframed_translations_count + i] : nullptr;
+				const u32 key = findKey(track.frames, track.keys_count, sample_idx, cursor_key ? *cursor_key : 0);
+				if (cursor_key) *cursor_key = key;
+				anim_rot = getRotation(track, key, sample);
+			}
 
 			if constexpr (use_weight) {
 				float4 rotf4 = f4LoadUnaligned(&rot[track.bone_index]);
@@ -235,15 +468,33 @@ void Animation::setRootMotionBone(BoneNameHash bone_name) {
 			break;
 		}
 	}
+
+	i32 keyframed_translation_idx = -1;
+	for (i32 i = 0, c = m_keyframed_translations.size(); i < c; ++i) {
+		if (m_keyframed_translations[i].bone_name == bone_name) {
+			keyframed_translation_idx = i;
+			break;
+		}
+	}
+
+	i32 keyframed_rotation_idx = -1;
+	for (i32 i = 0, c = m_keyframed_rotations.size(); i < c; ++i) {
+		if (m_keyframed_rotations[i].bone_name == bone_name) {
+			keyframed_rotation_idx = i;
+			break;
+		}
+	}
 	
 	m_root_motion.pose_translations.resize(m_frame_count + 1);
 	m_root_motion.pose_rotations.resize(m_frame_count + 1);
 
-	if (rotation_idx >= 0 && (m_flags & Animation::ROOT_ROTATION)) {
+	const bool has_rotation = rotation_idx >= 0 || keyframed_rotation_idx >= 0;
+	const bool has_translation = translation_idx >= 0 || keyframed_translation_idx >= 0;
+	if (has_rotation && (m_flags & Animation::ROOT_ROTATION)) {
 		m_root_motion.rotations.resize(m_frame_count + 1);
 	}
 
-	if (translation_idx >= 0 && (m_flags & Animation::ANY_ROOT_TRANSLATION)) {
+	if (has_translation && (m_flags & Animation::ANY_ROOT_TRANSLATION)) {
 		m_root_motion.translations.resize(m_frame_count + 1);
 	}
 
@@ -251,6 +502,8 @@ void Animation::setRootMotionBone(BoneNameHash bone_name) {
 		LocalRigidTransform tmp = {Vec3(0), Quat::IDENTITY};
 		if (translation_idx >= 0) tmp.pos = getTranslation(f, m_translations[translation_idx]);
 		if (rotation_idx >= 0) tmp.rot = getRotation(f, m_rotations[rotation_idx]);
+		if (keyframed_translation_idx >= 0) tmp.pos = getTranslation(f, m_keyframed_translations[keyframed_translation_idx]);
+		if (keyframed_rotation_idx >= 0) tmp.rot = getRotation(f, m_keyframed_rotations[keyframed_rotation_idx]);
 		LocalRigidTransform rm = AnimationSampler::maskRootMotion(m_flags, tmp);
 		if (!m_root_motion.translations.empty()) m_root_motion.translations[f] = rm.pos;
 		if (!m_root_motion.rotations.empty()) m_root_motion.rotations[f] = rm.rot;
@@ -267,6 +520,8 @@ void Animation::setRootMotionBone(BoneNameHash bone_name) {
 
 	m_root_motion.rotation_track_idx = rotation_idx;
 	m_root_motion.translation_track_idx = translation_idx;
+	m_root_motion.keyframed_rotation_track_idx = keyframed_rotation_idx;
+	m_root_motion.keyframed_translation_track_idx = keyframed_translation_idx;
 }
 
 LocalRigidTransform Animation::getRootMotion(Time time) const {
@@ -310,6 +565,24 @@ void Animation::getRelativePose(const SampleContext& ctx) {
 	}
 }
 
+static u32 getSkippedChannel(const Animation::TranslationTrack&) { return 3; }
+static u32 getSkippedChannel(const Animation::RotationTrack& track) { return track.skipped_channel; }
+
+template <typename Track>
+static void buildBatches(const Array<Track>& tracks, Array<Animation::TrackBatch>& batches) {
+	batches.resize((tracks.size() + 3) / 4);
+	for (u32 i = 0, c = batches.size() * 4; i < c; ++i) {
+		const Track& track = tracks[minimum(i, tracks.size() - 1)];
+		Animation::TrackBatch& batch = batches[i / 4];
+		const u32 lane = i % 4;
+		for (u32 j = 0; j < 3; ++j) {
+			batch.min[j][lane] = (&track.min.x)[j];
+			batch.to_range[j][lane] = (&track.to_range.x)[j];
+			batch.skipped_mask[j][lane] = getSkippedChannel(track) <= j ? 0xffFFffFF : 0;
+		}
+	}
+}
+
 static float unpackChannel(u64 val, float min, float to_float_range, u32 bitsize) {
 	const u64 mask = (u64(1) << bitsize) - 1;
 	return float(min + to_float_range * double(val & mask));
@@ -363,6 +636,22 @@ Quat Animation::getRotation(u32 frame, const RotationTrack& track) const {
 	return {};
 }
 
+Vec3 Animation::getTranslation(u32 frame, const KeyframedTranslationTrack& track) const {
+	ASSERT(&track >= m_keyframed_translations.begin() && &track < m_keyframed_translations.end());
+	if (&track - m_keyframed_translations.begin() == m_root_motion.keyframed_translation_track_idx) return m_root_motion.pose_translations[frame];
+	const u32 key = findKey(track.frames, track.keys_count, minimum(frame, m_frame_count - 1), 0);
+	return AnimationSampler::getTranslation(track, key, float(frame));
+}
+
+Quat Animation::getRotation(u32 frame, const KeyframedRotationTrack& track) const {
+	ASSERT(&track >= m_keyframed_rotations.begin() && &track < m_keyframed_rotations.end());
+	if (&track - m_keyframed_rotations.begin() == m_root_motion.keyframed_rotation_track_idx) return m_root_motion.pose_rotations[frame];
+	const u32 key = findKey(track.frames, track.keys_count, minimum(frame, m_frame_count - 1), 0);
+	Quat res;
+	f4StoreUnaligned(&res, AnimationSampler::getRotation(track, key, float(frame)));
+	return res;
+}
+
 void Animation::onBeforeReady() {
 	// TODO bake this
 	ASSERT(m_skeleton);
@@ -391,7 +680,45 @@ void Animation::onBeforeReady() {
 		t.bone_index = iter.isValid() ? iter.value() : 0;
 		m_max_accessed_bone_index = maximum(m_max_accessed_bone_index, t.bone_index);
 	}
+	for (KeyframedTranslationTrack& t : m_keyframed_translations) {
+		auto iter = m_skeleton->getBoneIndex(t.bone_name);
+		ASSERT(iter.isValid());
+		t.bone_index = iter.isValid() ? iter.value() : 0;
+		m_max_accessed_bone_index = maximum(m_max_accessed_bone_index, t.bone_index);
+	}
+	for (KeyframedRotationTrack& t : m_keyframed_rotations) {
+		auto iter = m_skeleton->getBoneIndex(t.bone_name);
+		ASSERT(iter.isValid());
+		t.bone_index = iter.isValid() ? iter.value() : 0;
+		m_max_accessed_bone_index = maximum(m_max_accessed_bone_index, t.bone_index);
+	}
 	setRootMotionBone(m_skeleton->getRootMotionBone());
+	computeCoveredBones();
+}
+
+void Animation::computeCoveredBones() {
+	m_covered_bones.clear();
+
+	enum : u8 { TRANSLATION = 1, ROTATION = 2 };
+	Array<u8> channels(m_allocator);
+	channels.resize(m_max_accessed_bone_index + 1);
+	memset(channels.begin(), 0, channels.byte_size());
+	for (const ConstTranslationTrack& t : m_const_translations) channels[t.bone_index] |= TRANSLATION;
+	for (const TranslationTrack& t : m_translations) channels[t.bone_index] |= TRANSLATION;
+	for (const KeyframedTranslationTrack& t : m_keyframed_translations) channels[t.bone_index] |= TRANSLATION;
+	for (const ConstRotationTrack& t : m_const_rotations) channels[t.bone_index] |= ROTATION;
+	for (const RotationTrack& t : m_rotations) channels[t.bone_index] |= ROTATION;
+	for (const KeyframedRotationTrack& t : m_keyframed_rotations) channels[t.bone_index] |= ROTATION;
+
+	for (u32 i = 0, c = channels.size(); i < c; ++i) {
+		if (channels[i] != (TRANSLATION | ROTATION)) continue;
+		if (!m_covered_bones.empty() && m_covered_bones.back().to == i) {
+			m_covered_bones.back().to = i + 1;
+		}
+		else {
+			m_covered_bones.push({i, i + 1});
+		}
+	}
 }
 
 bool Animation::load(Span<const u8> mem) {
@@ -399,6 +726,8 @@ bool Animation::load(Span<const u8> mem) {
 	m_const_translations.clear();
 	m_rotations.clear();
 	m_const_rotations.clear();
+	m_keyframed_translations.clear();
+	m_keyframed_rotations.clear();
 	m_mem.clear();
 	Header header;
 	InputMemoryStream file(mem);
@@ -450,6 +779,21 @@ bool Animation::load(Span<const u8> mem) {
 			track.bone_name = name;
 			blob.read(track.value);
 		}
+		else if (type == Animation::TrackType::KEYFRAMED) {
+			KeyframedTranslationTrack& track = m_keyframed_translations.emplace();
+			track.bone_name = name;
+			blob.read(track.min);
+			blob.read(track.to_range);
+			blob.read(track.bitsizes);
+			blob.read(track.keys_count);
+			if (track.keys_count < 2) {
+				logError(getPath(), ": invalid keyframed track.");
+				return false;
+			}
+			const u32 bitsize = track.bitsizes[0] + track.bitsizes[1] + track.bitsizes[2];
+			track.frames = (const u8*)blob.skip(track.keys_count * sizeof(u16));
+			track.values = (const u8*)blob.skip((track.keys_count * bitsize + 7) / 8);
+		}
 		else {
 			TranslationTrack& track = m_translations.emplace();
 			track.bone_name = name;
@@ -475,6 +819,22 @@ bool Animation::load(Span<const u8> mem) {
 			track.bone_name = bone_name_hash;
 			blob.read(track.value);
 		}
+		else if (type == Animation::TrackType::KEYFRAMED) {
+			KeyframedRotationTrack& track = m_keyframed_rotations.emplace();
+			track.bone_name = bone_name_hash;
+			blob.read(track.min);
+			blob.read(track.to_range);
+			blob.read(track.bitsizes);
+			blob.read(track.skipped_channel);
+			blob.read(track.keys_count);
+			if (track.keys_count < 2) {
+				logError(getPath(), ": invalid keyframed track.");
+				return false;
+			}
+			const u32 bitsize = track.bitsizes[0] + track.bitsizes[1] + track.bitsizes[2] + 1/*sign bit*/;
+			track.frames = (const u8*)blob.skip(track.keys_count * sizeof(u16));
+			track.values = (const u8*)blob.skip((track.keys_count * bitsize + 7) / 8);
+		}
 		else {
 			RotationTrack& track = m_rotations.emplace();
 			track.bone_name = bone_name_hash;
@@ -489,6 +849,9 @@ bool Animation::load(Span<const u8> mem) {
 
 	m_rotation_stream = (const u8*)blob.skip(0);
 
+	buildBatches(m_translations, m_translation_batches);
+	buildBatches(m_rotations, m_rotation_batches);
+
 	return true;
 }
 
@@ -500,6 +863,11 @@ void Animation::unload()
 	m_rotations.clear();
 	m_const_rotations.clear();
 	m_const_translations.clear();
+	m_keyframed_translations.clear();
+	m_keyframed_rotations.clear();
+	m_translation_batches.clear();
+	m_rotation_batches.clear();
+	m_covered_bones.clear();
 	m_mem.clear();
 	m_frame_count = 0;
 	if (m_skeleton) {
@@ -58,12 +58,14 @@ struct Animation final : Resource {
 
 	enum class TrackType : u8 {
 		CONSTANT,
-		ANIMATED
+		ANIMATED,
+		KEYFRAMED
 	};
 
 	enum class Version : u32 {
 		COMPRESSION = 6,
 		SKELETON,
+		KEYFRAMES,
 
 		LAST
 	};
@@ -114,43 +116,106 @@ struct Animation final : Resource {
 		u8 skipped_channel;
 	};
 
+	// stores only some frames (keys), values of keys are packed one after another like frames of TranslationTrack
+	struct KeyframedTranslationTrack {
+		u16 bone_index;
+		Vec3 min;
+		Vec3 to_range;
+		u8 bitsizes[3] = {};
+		u32 keys_count;
+		const u8* frames; // u16[keys_count], unaligned, first key is at frame 0, last at getFramesCount()
+		const u8* values;
+		BoneNameHash bone_name;
+	};
+
+	// see KeyframedTranslationTrack, values are packed like frames of RotationTrack
+	struct KeyframedRotationTrack {
+		BoneNameHash bone_name;
+		Vec3 min;
+		Vec3 to_range;
+		u16 bone_index;
+		u8 bitsizes[3];
+		u8 skipped_channel;
+		u32 keys_count;
+		const u8* frames;
+		const u8* values;
+	};
+
+	// remembers the current key of each keyframed track between samples,
+	// so sequential playback does not need to search for keys
+	struct Cursor {
+		explicit Cursor(IAllocator& allocator) : keys(allocator) {}
+		const Animation* animation = nullptr;
+		Array<u32> keys; // keyframed translations, then keyframed rotations
+	};
+
+	// 4 consecutive animated tracks with dequantization constants in SoA layout, see AnimationSampler
+	struct TrackBatch {
+		float min[3][4];
+		float to_range[3][4];
+		u32 skipped_mask[3][4]; // rotations only, lane is ~0 if skipped_channel <= i
+	};
+
+	// [from, to) range of bones with both translation and rotation track
+	struct BoneRange {
+		u32 from;
+		u32 to;
+	};
+
 	struct SampleContext {
 		Pose* pose;
 		const Model* model;
 		Time time;
 		float weight = 1;
 		const BoneMask* mask = nullptr;
+		Cursor* cursor = nullptr; // optional
 	};
 
 	Animation(const Path& path, ResourceManager& resource_manager, IAllocator& allocator);
 	ResourceType getType() const override { return TYPE; }
+	// decodes 4 tracks at a time in float, rotations match the single track float path bit for bit,
+	// translations differ from getTranslation() (double) by at most ~2^-22 * max(|min|, |min + range|) of the track
 	void getRelativePose(const SampleContext& ctx);
 	Time getLength() const { return Time::fromSeconds(m_frame_count / m_fps); }
 
 	Vec3 getTranslation(u32 frame, const TranslationTrack& track) const;
 	Quat getRotation(u32 sample, const RotationTrack& track) const;
+	Vec3 getTranslation(u32 frame, const KeyframedTranslationTrack& track) const;
+	Quat getRotation(u32 frame, const KeyframedRotationTrack& track) const;
 	
 	const Array<TranslationTrack>& getTranslations() const { return m_translations; }
 	const Array<ConstTranslationTrack>& getConstTranslations() const { return m_const_translations; }
 	const Array<RotationTrack>& getRotations() const { return m_rotations; }
 	const Array<ConstRotationTrack>& getConstRotations() const { return m_const_rotations; }
+	const Array<KeyframedTranslationTrack>& getKeyframedTranslations() const { return m_keyframed_translations; }
+	const Array<KeyframedRotationTrack>& getKeyframedRotations() const { return m_keyframed_rotations; }
 	struct LocalRigidTransform getRootMotion(Time t) const;
 	void setRootMotionBone(BoneNameHash bone_name);
 	u32 getFramesCount() const { return m_frame_count; }
+	float getFPS() const { return m_fps; }
 	u32 getRotationFrameSizeBits() const { return m_rotations_frame_size_bits; }
 	u32 getTranslationFrameSizeBits() const { return m_translations_frame_size_bits; }
+	Model* getSkeleton() const { return m_skeleton; }
+	// bones completely overwritten by getRelativePose with weight 1 and no mask, sorted
+	Span<const BoneRange> getCoveredBones() const { return m_covered_bones; }
 	Flags m_flags = Flags::NONE;
 
 private:
 	void unload() override;
 	bool load(Span<const u8> mem) override;
 	void onBeforeReady() override;
+	void computeCoveredBones();
 
 	TagAllocator m_allocator;
 	Array<TranslationTrack> m_translations;
 	Array<ConstTranslationTrack> m_const_translations;
 	Array<RotationTrack> m_rotations;
 	Array<ConstRotationTrack> m_const_rotations;
+	Array<KeyframedTranslationTrack> m_keyframed_translations;
+	Array<KeyframedRotationTrack> m_keyframed_rotations;
+	Array<TrackBatch> m_translation_batches;
+	Array<TrackBatch> m_rotation_batches;
+	Array<BoneRange> m_covered_bones;
 	
 	struct RootMotion {
 		RootMotion(IAllocator&);
@@ -161,6 +226,8 @@ private:
 		BoneNameHash bone;
 		i32 rotation_track_idx = -1;
 		i32 translation_track_idx = -1;
+		i32 keyframed_rotation_track_idx = -1;
+		i32 keyframed_translation_track_idx = -1;
 	} m_root_motion;
 
 	Array<u8> m_mem;
@@ -15,12 +15,14 @@
 #include "engine/engine.h"
 #include "engine/engine_hash_funcs.h"
 #include "engine/reflection.h"
+#include "engine/plugin.h"
 #include "engine/resource_manager.h"
 #include "engine/world.h"
 #include "nodes.h"
 #include "renderer/model.h"
 #include "renderer/pose.h"
 #include "renderer/render_module.h"
+#include "renderer/renderer.h"
 
 
 namespace Lumix
@@ -52,27 +54,61 @@ struct AnimationModuleImpl final : AnimationModule {
 		Flags flags = Flags::NONE;
 		anim::RuntimeContext* ctx = nullptr;
 		LocalRigidTransform root_motion = {{0, 0, 0}, {0, 0, 0, 1}};
+		// time accumulated while the animator was skipped by update LOD
+		float skipped_time = 0;
+		// pose sharing state, valid only during updateParallel
+		bool pose_pending = false;
+		i32 shared_pose = -1;
+		RuntimeHash pose_key;
 	};
 
+	// pose evaluated once and copied to all animators with the same pose key
+	struct SharedPose {
+		SharedPose(u32 owner) : owner(owner) {}
 
-	struct PropertyAnimator {
-		struct Key {
-			int frame0;
-			int frame1;
-			float value0;
-			float value1;
-		};
+		u32 owner; // index of the animator which evaluates the pose directly into its model instance
+		// owner's pose is unlocked once it's evaluated and copied to all other users
+		AtomicI32 ref_count = 1;
+	};
+
+	// update period is 1 << tier frames, PAUSED animators advance their controller as EIGHTH, but do not evaluate pose
+	enum class UpdateTier : u32 {
+		FULL,
+		HALF,
+		QUARTER,
+		EIGHTH,
+		PAUSED,
 
+		COUNT
+	};
+
+	struct UpdateLODContext {
+		DVec3 camera_pos;
+		float tan_half_fov;
+		bool has_camera;
+		u32 render_frame;
+	};
+
+
+	struct PropertyAnimator {
 		enum Flags {
 			NONE = 0,
 			LOOPED = 1 << 0,
 			DISABLED = 1 << 1
 		};
 
-		PropertyAnimator(IAllocator& allocator) : keys(allocator) {}
+		PropertyAnimator(IAllocator& allocator)
+			: cursors(allocator)
+			, values(allocator)
+			, modules(allocator)
+		{}
 
 		PropertyAnimation* animation;
-		Array<Key> keys;
+		// per PropertyAnimation::compiled_curves, rebuilt when compiled_version changes
+		Array<u32> cursors; // key found in last evaluation, 0 if the curve has no value
+		Array<float> values;
+		Array<IModule*> modules;
+		u32 compiled_version = 0;
 
 		Flags flags = Flags::NONE;
 		float time;
@@ -88,6 +124,8 @@ struct AnimationModuleImpl final : AnimationModule {
 		, m_animators(allocator)
 		, m_allocator(allocator)
 		, m_animator_map(allocator)
+		, m_shared_poses(allocator)
+		, m_shared_pose_map(allocator)
 	{
 		m_is_game_running = false;
 	}
@@ -95,6 +133,8 @@ struct AnimationModuleImpl final : AnimationModule {
 	void init() override {
 		m_render_module = static_cast<RenderModule*>(m_world.getModule("renderer"));
 		ASSERT(m_render_module);
+		m_renderer = static_cast<Renderer*>(m_engine.getSystemManager().getSystem("renderer"));
+		ASSERT(m_renderer);
 	}
 
 
@@ -417,6 +457,7 @@ struct AnimationModuleImpl final : AnimationModule {
 		animator.time = 0;
 		unloadResource(animator.animation);
 		animator.animation = loadPropertyAnimation(path);
+		animator.compiled_version = 0;
 	}
 
 
@@ -593,40 +634,95 @@ struct AnimationModuleImpl final : AnimationModule {
 		Pose* pose = m_render_module->lockPose(entity);
 		if (!pose) return;
 	
-		model->getRelativePose(*pose);
 		evalBlendStack(*animator.ctx, *pose);
 		pose->computeAbsolute(*model);
 		m_render_module->unlockPose(entity, true);
 	}
 
-	void updateAnimator(Animator& animator, float time_delta) {
-		PROFILE_FUNCTION();
-		if (!animator.resource || !animator.resource->isReady()) return;
+	UpdateTier getUpdateTier(const Animator& animator, const UpdateLODContext& lod_ctx) const {
+		// animators without runtime yet must be updated to get a valid pose
+		if (!animator.ctx) return UpdateTier::FULL;
+		if (!m_world.hasComponent(animator.entity, types::model_instance)) return UpdateTier::FULL;
+
+		const ModelInstance* mi = m_render_module->getModelInstance(animator.entity);
+		if (!mi || !mi->pose || !mi->model || !mi->model->isReady()) return UpdateTier::FULL;
+
+		// pose->frame is set by culling (incl. shadows) to the renderer frame in which it was visible
+		const u32 last_visible = (u32)(i32)mi->pose->frame;
+		// never rendered, e.g. no pipeline culls this world, we can't tell whether it's visible
+		if (last_visible == 0xffFFffFF) return UpdateTier::FULL;
+		const bool visible = lod_ctx.render_frame - last_visible <= 2;
+		if (!visible) {
+			// root motion moves the entity, so we can't stop it completely
+			return animator.flags & Animator::USE_ROOT_MOTION ? UpdateTier::EIGHTH : UpdateTier::PAUSED;
+		}
+		if (!lod_ctx.has_camera) return UpdateTier::FULL;
+
+		const DVec3 pos = m_world.getPosition(animator.entity);
+		const float dist = (float)length(pos - lod_ctx.camera_pos);
+		const Vec3 scale = m_world.getScale(animator.entity);
+		const float radius = mi->model->getOriginBoundingRadius() * maximum(scale.x, scale.y, scale.z);
+		if (dist <= radius) return UpdateTier::FULL;
+
+		// approximate fraction of the screen height covered by the bounding sphere
+		const float screen_size = radius / (dist * lod_ctx.tan_half_fov);
+		if (screen_size > 0.1f) return UpdateTier::FULL;
+		if (screen_size > 0.03f) return UpdateTier::HALF;
+		if (screen_size > 0.01f) return UpdateTier::QUARTER;
+		return UpdateTier::EIGHTH;
+	}
+
+	// returns true if the animator should be updated this frame, time_delta is then the time since its last update
+	// eval_pose is false for paused animators, only their controller is updated so their time does not stop
+	bool consumeUpdateLOD(Animator& animator, const UpdateLODContext& lod_ctx, AtomicI32* tier_counts, float& time_delta, bool& eval_pose) {
+		const UpdateTier tier = getUpdateTier(animator, lod_ctx);
+		tier_counts[(u32)tier].inc();
+		eval_pose = tier != UpdateTier::PAUSED;
+		const UpdateTier period_tier = eval_pose ? tier : UpdateTier::EIGHTH;
+
+		animator.skipped_time += time_delta;
+		// stagger animators with the same period over frames
+		const u32 period_mask = (1 << (u32)period_tier) - 1;
+		if (((m_lod_frame + animator.entity.index) & period_mask) != 0) return false;
+
+		time_delta = animator.skipped_time;
+		animator.skipped_time = 0;
+		return true;
+	}
+
+	// runs the controller, returns false if there's no pose to evaluate
+	bool updateAnimatorController(Animator& animator, float time_delta) {
+		if (!animator.resource || !animator.resource->isReady()) return false;
 		if (!animator.ctx) {
 			animator.ctx = animator.resource->createRuntime(animator.default_set);
 		}
 
 		const EntityRef entity = animator.entity;
-		if (!m_world.hasComponent(entity, types::model_instance)) return;
+		if (!m_world.hasComponent(entity, types::model_instance)) return false;
 
 		Model* model = m_render_module->getModelInstanceModel(entity);
-		if (!model || !model->isReady()) return;
+		if (!model || !model->isReady()) return false;
 
 		Pose* pose = m_render_module->lockPose(entity);
-		if (!pose) return;
+		if (!pose) return false;
 
 		animator.ctx->model = model;
 		animator.ctx->time_delta = Time::fromSeconds(time_delta);
 		animator.resource->update(*animator.ctx);
 		animator.root_motion = animator.ctx->root_motion;
+		return true;
+	}
 
-		model->getRelativePose(*pose);
+	// evaluates the blendstack, pose stays locked
+	Pose* evalAnimatorPose(Animator& animator) {
+		Pose* pose = m_render_module->lockPose(animator.entity);
+		Model* model = animator.ctx->model;
 		evalBlendStack(*animator.ctx, *pose);
-		
 		pose->computeAbsolute(*model);
+		return pose;
+	}
 
-		m_render_module->unlockPose(entity, true);
-
+	void applyRootMotion(Animator& animator) {
 		if (animator.flags & Animator::USE_ROOT_MOTION) {
 			Transform tr = m_world.getTransform(animator.entity);
 			tr.pos += tr.rot.rotate(animator.root_motion.pos);
@@ -635,101 +731,229 @@ struct AnimationModuleImpl final : AnimationModule {
 		}
 	}
 
-	void applyPropertyAnimator(EntityRef entity, PropertyAnimator& animator) {
+	void updateAnimator(Animator& animator, float time_delta) {
+		PROFILE_FUNCTION();
+		if (!updateAnimatorController(animator, time_delta)) return;
+
+		evalAnimatorPose(animator);
+		m_render_module->unlockPose(animator.entity, true);
+
+		applyRootMotion(animator);
+	}
+
+	static RuntimeHash computePoseKey(const Animator& animator) {
+		const anim::RuntimeContext& ctx = *animator.ctx;
+		struct {
+			u64 blendstack;
+			u64 animations;
+			const anim::Controller* controller;
+			const Model* model;
+		} key;
+		key.blendstack = RuntimeHash(ctx.blendstack.data(), (u32)ctx.blendstack.size()).getHashValue();
+		key.animations = RuntimeHash(ctx.animations.begin(), ctx.animations.size() * sizeof(ctx.animations[0])).getHashValue();
+		key.controller = animator.resource;
+		key.model = ctx.model;
+		return RuntimeHash(&key, sizeof(key));
+	}
+
+	// full comparison, so hash collisions can not share a wrong pose
+	static bool isSamePoseInput(const Animator& a, const Animator& b) {
+		const anim::RuntimeContext& ctx_a = *a.ctx;
+		const anim::RuntimeContext& ctx_b = *b.ctx;
+		if (a.resource != b.resource || ctx_a.model != ctx_b.model) return false;
+		if (ctx_a.blendstack.size() != ctx_b.blendstack.size()) return false;
+		if (ctx_a.animations.size() != ctx_b.animations.size()) return false;
+		if (memcmp(ctx_a.blendstack.data(), ctx_b.blendstack.data(), ctx_a.blendstack.size()) != 0) return false;
+		return memcmp(ctx_a.animations.begin(), ctx_b.animations.begin(), ctx_a.animations.size() * sizeof(ctx_a.animations[0])) == 0;
+	}
+
+	void releaseSharedPose(SharedPose& shared) {
+		if (shared.ref_count.dec() != 1) return;
+		m_render_module->unlockPose(m_animators[shared.owner].entity, true);
+	}
+
+	void updateWithSharedPoses() {
+		PROFILE_FUNCTION();
+		m_shared_poses.clear();
+		m_shared_pose_map.clear();
+		for (u32 i = 0, c = m_animators.size(); i < c; ++i) {
+			Animator& animator = m_animators[i];
+			// reset also for animators not evaluated this frame, so they are not counted as shared
+			animator.shared_pose = -1;
+			if (!animator.pose_pending) continue;
+
+			auto iter = m_shared_pose_map.find(animator.pose_key);
+			if (!iter.isValid()) {
+				m_shared_pose_map.insert(animator.pose_key, m_shared_poses.size());
+				animator.shared_pose = m_shared_poses.size();
+				m_shared_poses.emplace(i);
+				continue;
+			}
+
+			SharedPose& shared = m_shared_poses[iter.value()];
+			if (isSamePoseInput(m_animators[shared.owner], animator)) {
+				animator.shared_pose = iter.value();
+				shared.ref_count.inc();
+			}
+		}
+
+		jobs::forEach(m_shared_poses.size(), 1, [&](i32 idx, i32){
+			PROFILE_BLOCK("eval shared pose");
+			SharedPose& shared = m_shared_poses[idx];
+			evalAnimatorPose(m_animators[shared.owner]);
+			releaseSharedPose(shared);
+		});
+
+		jobs::forEach(m_animators.size(), 1, [&](i32 idx, i32){
+			Animator& animator = m_animators[idx];
+			if (!animator.pose_pending) return;
+			animator.pose_pending = false;
+
+			if (animator.shared_pose < 0) {
+				// hash collision
+				evalAnimatorPose(animator);
+				m_render_module->unlockPose(animator.entity, true);
+			}
+			else {
+				SharedPose& shared = m_shared_poses[animator.shared_pose];
+				if (shared.owner != (u32)idx) {
+					const Pose* src = m_render_module->lockPose(m_animators[shared.owner].entity);
+					Pose* dst = m_render_module->lockPose(animator.entity);
+					ASSERT(src->count == dst->count);
+					memcpy(dst->positions, src->positions, sizeof(src->positions[0]) * src->count);
+					memcpy(dst->rotations, src->rotations, sizeof(src->rotations[0]) * src->count);
+					dst->is_absolute = src->is_absolute;
+					m_render_module->unlockPose(animator.entity, true);
+					releaseSharedPose(shared);
+				}
+			}
+			applyRootMotion(animator);
+		});
+
+		static const u32 evaluated_counter = profiler::createCounter("Animator poses evaluated", 0);
+		static const u32 shared_counter = profiler::createCounter("Animator poses shared", 0);
+		u32 shared_count = 0;
+		for (const Animator& animator : m_animators) {
+			if (animator.shared_pose >= 0) ++shared_count;
+		}
+		profiler::pushCounter(evaluated_counter, (float)m_shared_poses.size());
+		profiler::pushCounter(shared_counter, float(shared_count - m_shared_poses.size()));
+	}
+
+	// samples all curves into animator.values, does not touch the world so it can run in parallel
+	void evalPropertyAnimator(PropertyAnimator& animator) const {
+		const PropertyAnimation& animation = *animator.animation;
+		const u32 curves_count = animation.compiled_curves.size();
+		if (animator.compiled_version != animation.compiled_version || (u32)animator.cursors.size() != curves_count) {
+			animator.compiled_version = animation.compiled_version;
+			animator.cursors.resize(curves_count);
+			animator.values.resize(curves_count);
+			animator.modules.resize(curves_count);
+			for (u32 i = 0; i < curves_count; ++i) {
+				const PropertyAnimation::CompiledCurve& curve = animation.compiled_curves[i];
+				animator.cursors[i] = 0;
+				animator.modules[i] = curve.type == PropertyAnimation::CurveType::PROPERTY ? m_world.getModule(curve.cmp_type) : nullptr;
+			}
+		}
+
 		const bool is_looped = animator.flags & PropertyAnimator::LOOPED;
-		const PropertyAnimation* animation = animator.animation;
 		Time time = Time::fromSeconds(animator.time);
-		DVec3 local_pos = m_world.getLocalTransform(entity).pos;
-		DVec3 pos = m_world.getPosition(entity);
-		Vec3 scale = m_world.getScale(entity);
-		bool set_local_pos = false;
-		bool set_pos = false;
-		bool set_scale = false;
 		if (is_looped) {
-			time = time % animation->length;
+			time = time % animation.length;
 		}
 		else {
-			time = minimum(time, animation->length);
-		}
-		for (PropertyAnimation::Curve& curve : animation->curves) {
-			if (curve.frames.size() < 2) continue;
-			for (int i = 1, n = curve.frames.size(); i < n; ++i) {
-				if (time <= curve.frames[i]) {
-					float t = (time - curve.frames[i - 1]) / (curve.frames[i] - curve.frames[i - 1]);
-					float v = curve.values[i] * t + curve.values[i - 1] * (1 - t);
-					switch (curve.type) {
-						case PropertyAnimation::CurveType::PROPERTY: {
-							ComponentUID cmp;
-							cmp.type = curve.cmp_type;
-							cmp.module = m_world.getModule(cmp.type);
-							cmp.entity = entity;
-							ASSERT(curve.property->setter);
-							curve.property->set(cmp, -1, v);
-							break;
-						}
-						case PropertyAnimation::CurveType::LOCAL_POS_X:
-							local_pos.x = v;
-							set_local_pos = true;
-							break;
-						case PropertyAnimation::CurveType::LOCAL_POS_Y:
-							local_pos.y = v;
-							set_local_pos = true;
-							break;
-						case PropertyAnimation::CurveType::LOCAL_POS_Z:
-							local_pos.z = v;
-							set_local_pos = true;
-							break;
-						case PropertyAnimation::CurveType::POS_X:
-							pos.x = v;
-							set_pos = true;
-							break;
-						case PropertyAnimation::CurveType::POS_Y:
-							pos.y = v;
-							set_pos = true;
-							break;
-						case PropertyAnimation::CurveType::POS_Z:
-							set_pos = true;
-							pos.z = v;
-							break;
-						case PropertyAnimation::CurveType::NOT_SET:
-							ASSERT(false);
-							break;
-						case PropertyAnimation::CurveType::SCALE_X:
-							scale.x = v;
-							set_scale = true;
-							break;
-						case PropertyAnimation::CurveType::SCALE_Y:
-							scale.y = v;
-							set_scale = true;
-							break;
-						case PropertyAnimation::CurveType::SCALE_Z:
-							scale.z = v;
-							set_scale = true;
-							break;
-					}
+			time = minimum(time, animation.length);
+		}
+
+		const Time* key_times = animation.key_times.begin();
+		const float* key_values = animation.key_values.begin();
+		for (u32 i = 0; i < curves_count; ++i) {
+			const u32 key = animation.findKey(animation.compiled_curves[i], time, animator.cursors[i]);
+			animator.cursors[i] = key;
+			if (key == 0) continue;
+
+			const float t = (time - key_times[key - 1]) / (key_times[key] - key_times[key - 1]);
+			animator.values[i] = key_values[key] * t + key_values[key - 1] * (1 - t);
+		}
+	}
+
+	// applies values from evalPropertyAnimator, transform changes are merged into one set call per space
+	void applyPropertyAnimatorValues(EntityRef entity, const PropertyAnimator& animator) {
+		const PropertyAnimation& animation = *animator.animation;
+		Transform tr;
+		DVec3 local_pos;
+		bool set_local_pos = false;
+		bool set_transform = false;
+		auto getTransform = [&]() -> Transform& {
+			if (!set_transform) tr = m_world.getTransform(entity);
+			set_transform = true;
+			return tr;
+		};
+		auto getLocalPos = [&]() -> DVec3& {
+			if (!set_local_pos) local_pos = m_world.getLocalTransform(entity).pos;
+			set_local_pos = true;
+			return local_pos;
+		};
+
+		for (u32 i = 0, c = animator.cursors.size(); i < c; ++i) {
+			if (animator.cursors[i] == 0) continue;
+
+			const PropertyAnimation::CompiledCurve& curve = animation.compiled_curves[i];
+			const float v = animator.values[i];
+			switch (curve.type) {
+				case PropertyAnimation::CurveType::PROPERTY:
+					if (animator.modules[i]) curve.property->setter(animator.modules[i], entity, -1, v);
 					break;
-				}
+				case PropertyAnimation::CurveType::LOCAL_POS_X: getLocalPos().x = v; break;
+				case PropertyAnimation::CurveType::LOCAL_POS_Y: getLocalPos().y = v; break;
+				case PropertyAnimation::CurveType::LOCAL_POS_Z: getLocalPos().z = v; break;
+				case PropertyAnimation::CurveType::POS_X: getTransform().pos.x = v; break;
+				case PropertyAnimation::CurveType::POS_Y: getTransform().pos.y = v; break;
+				case PropertyAnimation::CurveType::POS_Z: getTransform().pos.z = v; break;
+				case PropertyAnimation::CurveType::SCALE_X: getTransform().scale.x = v; break;
+				case PropertyAnimation::CurveType::SCALE_Y: getTransform().scale.y = v; break;
+				case PropertyAnimation::CurveType::SCALE_Z: getTransform().scale.z = v; break;
+				case PropertyAnimation::CurveType::NOT_SET: ASSERT(false); break;
 			}
 		}
-		if (set_pos) m_world.setPosition(entity, pos);
+		if (set_transform) m_world.setTransform(entity, tr);
 		if (set_local_pos) m_world.setLocalPosition(entity, local_pos);
-		if (set_scale) m_world.setScale(entity, scale);
+	}
+
+	void applyPropertyAnimator(EntityRef entity, PropertyAnimator& animator) {
+		if (!animator.animation || !animator.animation->isReady()) return;
+		evalPropertyAnimator(animator);
+		applyPropertyAnimatorValues(entity, animator);
+	}
+
+	static bool isPropertyAnimatorActive(const PropertyAnimator& animator) {
+		const PropertyAnimation* animation = animator.animation;
+		if (!animation || !animation->isReady()) return false;
+		if (animation->compiled_curves.empty()) return false;
+		return (animator.flags & PropertyAnimator::DISABLED) == 0;
 	}
 
 	void updatePropertyAnimators(float time_delta) {
 		PROFILE_FUNCTION();
-		for (int anim_idx = 0, c = m_property_animators.size(); anim_idx < c; ++anim_idx) {
-			EntityRef entity = m_property_animators.getKey(anim_idx);
-			PropertyAnimator& animator = m_property_animators.at(anim_idx);
-			const PropertyAnimation* animation = animator.animation;
-			if (!animation || !animation->isReady()) continue;
-			if (animation->curves.empty()) continue;
-			if (animation->curves[0].frames.empty()) continue;
-			if (animator.flags & PropertyAnimator::DISABLED) continue;
-
-			animator.time += time_delta;
-			
-			applyPropertyAnimator(entity, animator);
+		if (m_property_animators.size() == 0) return;
+
+		jobs::forEach(m_property_animators.size(), 64, [&](i32 idx, i32 to){
+			PROFILE_BLOCK("eval property animators");
+			for (i32 i = idx; i < to; ++i) {
+				PropertyAnimator& animator = m_property_animators.at(i);
+				if (!isPropertyAnimatorActive(animator)) continue;
+
+				animator.time += time_delta;
+				evalPropertyAnimator(animator);
+			}
+		});
+
+		// setters and transform changes are not thread safe
+		PROFILE_BLOCK("apply property animators");
+		for (i32 i = 0, c = m_property_animators.size(); i < c; ++i) {
+			const PropertyAnimator& animator = m_property_animators.at(i);
+			if (!isPropertyAnimatorActive(animator)) continue;
+			applyPropertyAnimatorValues(m_property_animators.getKey(i), animator);
 		}
 	}
 
@@ -753,10 +977,67 @@ struct AnimationModuleImpl final : AnimationModule {
 		PROFILE_FUNCTION();
 		if (!m_is_game_running) return;
 		
+		UpdateLODContext lod_ctx;
+		if (m_update_lod_enabled) {
+			lod_ctx.render_frame = m_renderer->frameNumber();
+			const EntityPtr camera = m_render_module->getActiveCamera();
+			lod_ctx.has_camera = camera.isValid();
+			if (lod_ctx.has_camera) {
+				const Viewport vp = m_render_module->getCameraViewport(*camera);
+				lod_ctx.camera_pos = vp.pos;
+				lod_ctx.tan_half_fov = vp.is_ortho ? 1.f : tanf(vp.fov * 0.5f);
+				lod_ctx.has_camera = !vp.is_ortho && lod_ctx.tan_half_fov > 0;
+			}
+		}
+
+		AtomicI32 tier_counts[(u32)UpdateTier::COUNT] = {0, 0, 0, 0, 0};
 		jobs::forEach(m_animators.size(), 1, [&](i32 idx, i32){
-			updateAnimator(m_animators[idx], time_delta);
+			Animator& animator = m_animators[idx];
+			float dt = time_delta;
+			bool eval_pose = true;
+			if (m_update_lod_enabled && !consumeUpdateLOD(animator, lod_ctx, tier_counts, dt, eval_pose)) return;
+			if (!eval_pose) {
+				updateAnimatorController(animator, dt);
+				return;
+			}
+
+			if (!m_pose_sharing_enabled) {
+				updateAnimator(animator, dt);
+				return;
+			}
+
+			if (!updateAnimatorController(animator, dt)) return;
+			anim::quantizeBlendStackTime(*animator.ctx, m_pose_sharing_time_quantum);
+			animator.pose_key = computePoseKey(animator);
+			animator.pose_pending = true;
 		});
+
+		if (m_pose_sharing_enabled) updateWithSharedPoses();
+
+		if (!m_update_lod_enabled) return;
+		++m_lod_frame;
+
+		static const u32 counters[] = {
+			profiler::createCounter("Animators full rate", 0),
+			profiler::createCounter("Animators 1/2 rate", 0),
+			profiler::createCounter("Animators 1/4 rate", 0),
+			profiler::createCounter("Animators 1/8 rate", 0),
+			profiler::createCounter("Animators paused", 0),
+		};
+		static_assert(lengthOf(counters) == (u32)UpdateTier::COUNT);
+		for (u32 i = 0; i < (u32)UpdateTier::COUNT; ++i) {
+			profiler::pushCounter(counters[i], (float)(i32)tier_counts[i]);
+		}
+	}
+
+	void enableAnimatorUpdateLOD(bool enable) override { m_update_lod_enabled = enable; }
+	bool isAnimatorUpdateLODEnabled() const override { return m_update_lod_enabled; }
+
+	void enableAnimatorPoseSharing(bool enable, float time_quantum) override {
+		m_pose_sharing_enabled = enable;
+		m_pose_sharing_time_quantum = Time::fromSeconds(time_quantum);
 	}
+	bool isAnimatorPoseSharingEnabled() const override { return m_pose_sharing_enabled; }
 
 	void update(float time_delta) override {
 		PROFILE_FUNCTION();
@@ -828,7 +1109,14 @@ struct AnimationModuleImpl final : AnimationModule {
 	HashMap<EntityRef, u32> m_animator_map;
 	Array<Animator> m_animators;
 	RenderModule* m_render_module;
+	Renderer* m_renderer = nullptr;
 	bool m_is_game_running;
+	bool m_update_lod_enabled = false;
+	u32 m_lod_frame = 0;
+	bool m_pose_sharing_enabled = false;
+	Time m_pose_sharing_time_quantum;
+	Array<SharedPose> m_shared_poses;
+	HashMap<RuntimeHash, u32> m_shared_pose_map;
 };
 
 
@@ -56,6 +56,13 @@ struct AnimationModule : IModule {
 	virtual int getAnimatorInputIndex(EntityRef entity, const char* name) const = 0;	//@ function alias getInputIndex
 	//@ end
 	virtual void updateAnimator(EntityRef entity, float time_delta) = 0;
+	// when enabled, small, distant and invisible animators are updated less often, off by default
+	virtual void enableAnimatorUpdateLOD(bool enable) = 0;
+	virtual bool isAnimatorUpdateLODEnabled() const = 0;
+	// animators with the same controller, model and blendstack (sample times rounded down to time_quantum seconds)
+	// evaluate their pose only once per frame, off by default
+	virtual void enableAnimatorPoseSharing(bool enable, float time_quantum = 1 / 60.f) = 0;
+	virtual bool isAnimatorPoseSharingEnabled() const = 0;
 	virtual bool getAnimatorBoolInput(EntityRef entity, u32 input_idx) = 0;
 	virtual float getAnimatorFloatInput(EntityRef entity, u32 input_idx) = 0;
 	virtual Vec3 getAnimatorVec3Input(EntityRef entity, u32 input_idx) = 0;
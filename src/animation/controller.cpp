@@ -62,6 +62,8 @@ RuntimeContext* Controller::createRuntime(u32 anim_set) {
 			ctx->animations[anim.slot] = anim.animation;
 		}
 	}
+	ctx->cursors.reserve(m_animation_slots_count);
+	for (u32 i = 0; i < m_animation_slots_count; ++i) ctx->cursors.emplace(m_allocator);
 	if (m_root) m_root->enter(*ctx);
 	return ctx;
 }
@@ -139,7 +141,7 @@ bool Controller::deserialize(InputMemoryStream& stream) {
 	return true;
 }
 
-static void getPose(const anim::RuntimeContext& ctx, Time time, float weight, u32 slot, Pose& pose, u32 mask_idx, bool looped) {
+static void getPose(anim::RuntimeContext& ctx, Time time, float weight, u32 slot, Pose& pose, u32 mask_idx, bool looped) {
 	Animation* anim = ctx.animations[slot];
 	ASSERT(anim);
 	ASSERT(ctx.model->isReady());
@@ -153,6 +155,7 @@ static void getPose(const anim::RuntimeContext& ctx, Time time, float weight, u3
 	sample_ctx.model = ctx.model;
 	sample_ctx.weight = weight;
 	sample_ctx.mask = mask_idx < (u32)ctx.controller.m_bone_masks.size() ? &ctx.controller.m_bone_masks[mask_idx] : nullptr;
+	sample_ctx.cursor = &ctx.cursors[slot];
 	anim->getRelativePose(sample_ctx);
 }
 
@@ -264,7 +267,61 @@ void evalIK(float alpha, Vec3 target, BoneNameHash leaf_bone, u32 bones_count, M
 	}
 }
 
-void evalBlendStack(const anim::RuntimeContext& ctx, Pose& pose) {
+void quantizeBlendStackTime(anim::RuntimeContext& ctx, Time quantum) {
+	const u32 q = quantum.raw();
+	if (q <= 1) return;
+
+	u8* data = ctx.blendstack.getMutableData();
+	InputMemoryStream bs(ctx.blendstack);
+	for (;;) {
+		anim::BlendStackInstructions instr;
+		bs.read(instr);
+		switch (instr) {
+			case anim::BlendStackInstructions::END: return;
+			case anim::BlendStackInstructions::IK:
+				bs.skip(sizeof(float) + sizeof(Vec3) + sizeof(BoneNameHash) + sizeof(u32));
+				break;
+			case anim::BlendStackInstructions::SAMPLE: {
+				bs.skip(sizeof(u32) + sizeof(float));
+				u8* time_ptr = data + bs.getPosition();
+				Time time = bs.read<Time>();
+				time = Time(time.raw() - time.raw() % q);
+				memcpy(time_ptr, &time, sizeof(time));
+				bs.read<bool>();
+				break;
+			}
+		}
+	}
+}
+
+// copies bind pose to bones which are not completely overwritten by the first sample in blendstack
+static void initPose(anim::RuntimeContext& ctx, Pose& pose) {
+	Span<const Animation::BoneRange> covered;
+	InputMemoryStream bs(ctx.blendstack);
+	if (bs.read<anim::BlendStackInstructions>() == anim::BlendStackInstructions::SAMPLE) {
+		const u32 slot = bs.read<u32>();
+		const float weight = bs.read<float>();
+		const Animation* anim = ctx.animations[slot];
+		// same condition as the unweighted path in Animation::getRelativePose
+		const bool overwrites = weight >= 0.9999f && ctx.controller.m_bone_masks.empty();
+		if (overwrites && anim && anim->isReady() && anim->getSkeleton() && anim->getSkeleton()->getBones().length() == pose.count) {
+			covered = anim->getCoveredBones();
+		}
+	}
+
+	u32 from = 0;
+	for (const Animation::BoneRange& range : covered) {
+		ctx.model->getRelativePose(pose, from, range.from);
+		from = range.to;
+	}
+	ctx.model->getRelativePose(pose, from, pose.count);
+	pose.is_absolute = false;
+	ctx.bind_pose_bones = pose.count;
+	for (const Animation::BoneRange& range : covered) ctx.bind_pose_bones -= range.to - range.from;
+}
+
+void evalBlendStack(anim::RuntimeContext& ctx, Pose& pose) {
+	initPose(ctx, pose);
 	InputMemoryStream bs(ctx.blendstack);
 
 	for (;;) {
@@ -285,6 +342,8 @@ void evalBlendStack(const anim::RuntimeContext& ctx, Pose& pose) {
 				float weight = bs.read<float>();
 				Time time = bs.read<Time>();
 				bool looped = bs.read<bool>();
+				// blending with zero weight does not change the pose
+				if (weight < 0.0001f) break;
 				getPose(ctx, time, weight, slot, pose, 0, looped);
 				break;
 			}
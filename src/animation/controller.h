@@ -45,6 +45,7 @@ struct RuntimeContext {
 	Controller& controller;
 	Array<Value> inputs;
 	Array<Animation*> animations;
+	Array<Animation::Cursor> cursors; // one per animation slot
 	OutputMemoryStream data;
 	OutputMemoryStream blendstack;
 
@@ -53,6 +54,10 @@ struct RuntimeContext {
 	Model* model = nullptr;
 	InputMemoryStream input_runtime;
 	LocalRigidTransform root_motion;
+	// number of bones copied from bind pose in last evalBlendStack
+	u32 bind_pose_bones = 0;
+
+	u64 getMemoryUsage() const;
 };
 
 enum BlendStackInstructions : u8 {
@@ -68,7 +73,10 @@ enum class ControllerVersion : u32 {
 	LATEST
 };
 
-void evalBlendStack(const anim::RuntimeContext& ctx, Pose& pose);
+// fills whole relative pose; bind pose is copied only to bones not overwritten by the first sample
+void evalBlendStack(anim::RuntimeContext& ctx, Pose& pose);
+// rounds sample times in blendstack down to multiple of quantum
+void quantizeBlendStackTime(anim::RuntimeContext& ctx, Time quantum);
 
 struct Controller final : Resource {
 	Controller(const Path& path, ResourceManager& resource_manager, IAllocator& allocator);
@@ -214,6 +214,8 @@ struct AnimationAssetBrowserPlugin : AssetBrowser::IPlugin {
 			const Array<Animation::ConstRotationTrack>& const_rotations = m_resource->getConstRotations();
 			const Array<Animation::TranslationTrack>& translations = m_resource->getTranslations();
 			const Array<Animation::ConstTranslationTrack>& const_translations = m_resource->getConstTranslations();
+			const Array<Animation::KeyframedTranslationTrack>& keyframed_translations = m_resource->getKeyframedTranslations();
+			const Array<Animation::KeyframedRotationTrack>& keyframed_rotations = m_resource->getKeyframedRotations();
 
 			ImGuiEx::Label("Skeleton");
 			saveUndo(m_app.getAssetBrowser().resourceInput("##ske", m_parent_meta.skeleton, Model::TYPE, -1));
@@ -227,6 +229,8 @@ struct AnimationAssetBrowserPlugin : AssetBrowser::IPlugin {
 			saveUndo(ImGui::DragFloat("##aert", &m_parent_meta.anim_translation_error, 0.01f));
 			ImGuiEx::Label("Animation rotation error");
 			saveUndo(ImGui::DragFloat("##aerr", &m_parent_meta.anim_rotation_error, 0.01f));
+			ImGuiEx::Label("Keyframe reduction error");
+			saveUndo(ImGui::DragFloat("##aerk", &m_parent_meta.anim_keyframe_error, 0.0001f, 0.f, FLT_MAX, "%.4f"));
 
 			ImGuiEx::Label("Frames");
 			ImGui::Text("%d", m_resource->getFramesCount());
@@ -235,13 +239,13 @@ struct AnimationAssetBrowserPlugin : AssetBrowser::IPlugin {
 			ImGuiEx::Label("Rotation frame size");
 			ImGui::Text("%d", m_resource->getRotationFrameSizeBits());
 
-			ImGuiEx::Label("Translation tracks (constant / animated)");
-			ImGui::Text("%d / %d", const_translations.size(), translations.size());
+			ImGuiEx::Label("Translation tracks (constant / animated / keyframed)");
+			ImGui::Text("%d / %d / %d", const_translations.size(), translations.size(), keyframed_translations.size());
 
-			ImGuiEx::Label("Rotation tracks (constant / animated)");
-			ImGui::Text("%d / %d", const_rotations.size(), rotations.size());
+			ImGuiEx::Label("Rotation tracks (constant / animated / keyframed)");
+			ImGui::Text("%d / %d / %d", const_rotations.size(), rotations.size(), keyframed_rotations.size());
 
-			if (!translations.empty() && ImGui::TreeNode("Translations")) {
+			if ((!translations.empty() || !keyframed_translations.empty()) && ImGui::TreeNode("Translations")) {
 				for (const Animation::TranslationTrack& track : translations) {
 
 					const Model::Bone& bone = m_model->getBone(track.bone_index);
@@ -270,6 +274,32 @@ struct AnimationAssetBrowserPlugin : AssetBrowser::IPlugin {
 						ImGui::TreePop();
 					}
 				}
+				for (const Animation::KeyframedTranslationTrack& track : keyframed_translations) {
+					const Model::Bone& bone = m_model->getBone(track.bone_index);
+					ImGuiTreeNodeFlags flags = m_selected_bone == track.bone_index ? ImGuiTreeNodeFlags_Selected : 0;
+					flags |= ImGuiTreeNodeFlags_OpenOnArrow;
+					u32 bits = track.bitsizes[0] + track.bitsizes[1] + track.bitsizes[2];
+					bool open = ImGui::TreeNodeEx(&bone, flags, "%s (%d keys, %d bits)", bone.name.c_str(), track.keys_count, bits);
+					if (ImGui::IsItemHovered() && ImGui::IsMouseReleased(ImGuiMouseButton_Left)) {
+						m_selected_bone = track.bone_index;
+					}
+					if (open) {
+						ImGui::Columns(4);
+						for (u32 i = 0; i < m_resource->getFramesCount(); ++i) {
+							const Vec3 p = m_resource->getTranslation(i, track);
+							ImGui::Text("%d:", i);
+							ImGui::NextColumn();
+							ImGui::Text("%f", p.x);
+							ImGui::NextColumn();
+							ImGui::Text("%f", p.y);
+							ImGui::NextColumn();
+							ImGui::Text("%f", p.z);
+							ImGui::NextColumn();
+						}
+						ImGui::Columns();
+						ImGui::TreePop();
+					}
+				}
 				for (const Animation::ConstTranslationTrack& track : const_translations) {
 					const Model::Bone& bone = m_model->getBone(track.bone_index);
 					ImGuiTreeNodeFlags flags = m_selected_bone == track.bone_index ? ImGuiTreeNodeFlags_Selected : 0;
@@ -286,7 +316,7 @@ struct AnimationAssetBrowserPlugin : AssetBrowser::IPlugin {
 				ImGui::TreePop();
 			}
 
-			if ((!rotations.empty() || !const_rotations.empty()) && ImGui::TreeNode("Rotations")) {
+			if ((!rotations.empty() || !const_rotations.empty() || !keyframed_rotations.empty()) && ImGui::TreeNode("Rotations")) {
 				for (const Animation::RotationTrack& track : rotations) {
 					const Model::Bone& bone = m_model->getBone(track.bone_index);
 					ImGuiTreeNodeFlags flags = m_selected_bone == track.bone_index ? ImGuiTreeNodeFlags_Selected : 0;
@@ -314,6 +344,33 @@ struct AnimationAssetBrowserPlugin : AssetBrowser::IPlugin {
 						ImGui::TreePop();
 					}
 				}
+				for (const Animation::KeyframedRotationTrack& track : keyframed_rotations) {
+					const Model::Bone& bone = m_model->getBone(track.bone_index);
+					ImGuiTreeNodeFlags flags = m_selected_bone == track.bone_index ? ImGuiTreeNodeFlags_Selected : 0;
+					flags |= ImGuiTreeNodeFlags_OpenOnArrow;
+
+					u32 bits = track.bitsizes[0] + track.bitsizes[1] + track.bitsizes[2] + 1;
+					bool open = ImGui::TreeNodeEx(&bone, flags, "%s (%d keys, %d bits)", bone.name.c_str(), track.keys_count, bits);
+					if (ImGui::IsItemHovered() && ImGui::IsMouseReleased(ImGuiMouseButton_Left)) {
+						m_selected_bone = track.bone_index;
+					}
+					if (open) {
+						ImGui::Columns(4);
+						for (u32 i = 0; i < m_resource->getFramesCount(); ++i) {
+							const Vec3 r = radiansToDegrees(m_resource->getRotation(i, track).toEuler());
+							ImGui::Text("%d:", i);
+							ImGui::NextColumn();
+							ImGui::Text("%f", r.x);
+							ImGui::NextColumn();
+							ImGui::Text("%f", r.y);
+							ImGui::NextColumn();
+							ImGui::Text("%f", r.z);
+							ImGui::NextColumn();
+						}
+						ImGui::Columns();
+						ImGui::TreePop();
+					}
+				}
 				for (const Animation::ConstRotationTrack& track : const_rotations) {
 					const Model::Bone& bone = m_model->getBone(track.bone_index);
 					ImGuiTreeNodeFlags flags = m_selected_bone == track.bone_index ? ImGuiTreeNodeFlags_Selected : 0;
@@ -464,6 +521,7 @@ struct PropertyAnimationPlugin : AssetBrowser::IPlugin, AssetCompiler::IPlugin {
 				blob.read(curve.frames.begin(), curve.frames.byte_size());
 				blob.read(curve.values.begin(), curve.values.byte_size());
 			}
+			m_resource->compile();
 		}
 
 		void serialize(OutputMemoryStream& blob) override {
@@ -689,6 +747,7 @@ struct PropertyAnimationPlugin : AssetBrowser::IPlugin, AssetCompiler::IPlugin {
 		void saveUndo(bool changed) {
 			if (!changed) return;
 
+			m_resource->compile();
 			pushUndo(ImGui::GetItemID());
 			m_dirty = true;
 		}
@@ -707,6 +766,7 @@ struct PropertyAnimationPlugin : AssetBrowser::IPlugin, AssetCompiler::IPlugin {
 						curve.frames.push(animation->length);
 						curve.values.push(0);
 						curve.values.push(1);
+						animation->compile();
 					}
 				}
 				ImGui::EndMenu();
@@ -734,6 +794,7 @@ struct PropertyAnimationPlugin : AssetBrowser::IPlugin, AssetCompiler::IPlugin {
 							curve.frames.push(animation->length);
 							curve.values.push(0);
 							curve.values.push(1);
+							animation->compile();
 						}
 					}
 					PropertyAnimation* animation;
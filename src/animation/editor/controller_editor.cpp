@@ -636,7 +636,14 @@ struct ControllerEditorImpl : ControllerEditor, AssetBrowser::IPlugin, AssetComp
 				ImGui::TextUnformatted("Selected entity does not have resource assigned in animator component");
 				return;
 			}
-			
+
+			if (const anim::RuntimeContext* ctx = module->getAnimatorRuntimeContext(entity)) {
+				ImGuiEx::Label("Runtime memory");
+				ImGui::Text("%.1f KB", ctx->getMemoryUsage() / 1024.f);
+				ImGuiEx::Label("Bones from bind pose");
+				ImGui::Text("%d", ctx->bind_pose_bones);
+			}
+
 			for (const anim::Controller::Input& input : ctrl->m_inputs) {
 				ImGui::PushID(&input);
 				const u32 idx = u32(&input - ctrl->m_inputs.begin());
@@ -42,11 +42,23 @@ RuntimeContext::RuntimeContext(Controller& controller, IAllocator& allocator)
 	, inputs(allocator)
 	, controller(controller)
 	, animations(allocator)
+	, cursors(allocator)
 	, blendstack(allocator)
 	, input_runtime(nullptr, 0)
 {
 }
 
+u64 RuntimeContext::getMemoryUsage() const {
+	u64 res = sizeof(*this);
+	res += inputs.capacity() * sizeof(inputs[0]);
+	res += animations.capacity() * sizeof(animations[0]);
+	res += cursors.capacity() * sizeof(cursors[0]);
+	for (const Animation::Cursor& cursor : cursors) res += cursor.keys.capacity() * sizeof(cursor.keys[0]);
+	res += data.capacity();
+	res += blendstack.capacity();
+	return res;
+}
+
 void RuntimeContext::setInput(u32 input_idx, float value) {
 	ASSERT(controller.m_inputs[input_idx].type == Value::NUMBER);
 	inputs[input_idx].f = value;
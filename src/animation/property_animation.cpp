@@ -13,6 +13,9 @@ PropertyAnimation::PropertyAnimation(const Path& path, ResourceManager& resource
 	: Resource(path, resource_manager, allocator)
 	, m_allocator(allocator)
 	, curves(allocator)
+	, compiled_curves(allocator)
+	, key_times(allocator)
+	, key_values(allocator)
 {
 }
 
@@ -23,6 +26,51 @@ PropertyAnimation::Curve& PropertyAnimation::addCurve()
 }
 
 
+void PropertyAnimation::compile() {
+	compiled_curves.clear();
+	key_times.clear();
+	key_values.clear();
+	++compiled_version;
+
+	for (const Curve& curve : curves) {
+		if (curve.frames.size() < 2) continue;
+		if (curve.type == CurveType::NOT_SET) continue;
+		if (curve.type == CurveType::PROPERTY && (!curve.property || !curve.property->setter)) continue;
+
+		CompiledCurve& compiled = compiled_curves.emplace();
+		compiled.type = curve.type;
+		compiled.cmp_type = curve.cmp_type;
+		compiled.property = curve.property;
+		compiled.first_key = key_times.size();
+		compiled.keys_count = curve.frames.size();
+		for (i32 i = 0; i < curve.frames.size(); ++i) {
+			key_times.push(curve.frames[i]);
+			key_values.push(curve.values[i]);
+		}
+	}
+}
+
+u32 PropertyAnimation::findKey(const CompiledCurve& curve, Time time, u32 cursor) const {
+	const u32 first = curve.first_key + 1;
+	const u32 end = curve.first_key + curve.keys_count;
+	if (time > key_times[end - 1]) return 0;
+
+	auto isKey = [&](u32 key) {
+		return key >= first && key < end && time <= key_times[key] && (key == first || time > key_times[key - 1]);
+	};
+	if (isKey(cursor)) return cursor;
+	if (isKey(cursor + 1)) return cursor + 1;
+
+	u32 lo = first;
+	u32 hi = end - 1;
+	while (lo < hi) {
+		const u32 mid = (lo + hi) / 2;
+		if (time <= key_times[mid]) hi = mid;
+		else lo = mid + 1;
+	}
+	return lo;
+}
+
 void PropertyAnimation::deserialize(InputMemoryStream& blob) {
 	bool res = load(Span((const u8*)blob.getData(), (u32)blob.size()));
 	ASSERT(res);
@@ -95,7 +143,7 @@ bool PropertyAnimation::load(Span<const u8> mem) {
 		}
 	}
 
-
+	compile();
 	return !stream.hasOverflow();
 }
 
@@ -103,6 +151,10 @@ bool PropertyAnimation::load(Span<const u8> mem) {
 void PropertyAnimation::unload()
 {
 	curves.clear();
+	compiled_curves.clear();
+	key_times.clear();
+	key_values.clear();
+	++compiled_version;
 }
 
 
@@ -40,6 +40,15 @@ struct PropertyAnimation final : Resource {
 		Array<float> values;
 	};
 
+	// curve with at least 2 keys, keys are in PropertyAnimation::key_times/key_values
+	struct CompiledCurve {
+		CurveType type;
+		ComponentType cmp_type;
+		const reflection::Property<float>* property;
+		u32 first_key;
+		u32 keys_count;
+	};
+
 	struct Header {
 		static const u32 MAGIC = '_PRA';
 		
@@ -52,11 +61,21 @@ struct PropertyAnimation final : Resource {
 	ResourceType getType() const override { return TYPE; }
 	Curve& addCurve();
 	void deserialize(struct InputMemoryStream& blob);
+	// rebuilds compiled_curves from curves, must be called after curves are modified
+	void compile();
+	// returns index of the first key >= time in [first_key + 1, first_key + keys_count), or 0 if time is after the last key
+	// cursor is the result from previous call, to make sequential playback O(1)
+	u32 findKey(const CompiledCurve& curve, Time time, u32 cursor) const;
 
 	IAllocator& m_allocator;
 	Array<Curve> curves;
 	Time length;
 
+	Array<CompiledCurve> compiled_curves;
+	Array<Time> key_times;
+	Array<float> key_values;
+	u32 compiled_version = 0;
+
 	static const ResourceType TYPE;
 
 private:
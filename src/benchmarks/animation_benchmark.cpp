@@ -0,0 +1,273 @@
+// animation sampling benchmark, compares batched Animation::getRelativePose with per-track
+// getTranslation / getRotation decoding on real animations (character rigs) and checks both produce the same pose
+// usage: animation_benchmark -animations <path.ani,path.ani,...> [-samples <count>] [-repetitions <count>]
+//                            [-tolerance <value>] [-output <path.json>]
+// exit code is 1 if the batched pose differs from the per-track pose by more than `tolerance`
+
+#include "animation/animation.h"
+#include "benchmarks/benchmark.h"
+#include "core/array.h"
+#include "core/log.h"
+#include "core/math.h"
+#include "core/os.h"
+#include "core/path.h"
+#include "core/stream.h"
+#include "core/string.h"
+#include "engine/engine.h"
+#include "engine/file_system.h"
+#include "engine/resource_manager.h"
+#include "renderer/model.h"
+#include "renderer/pose.h"
+
+using namespace Lumix;
+
+namespace {
+
+struct Options {
+	const char* animations = "";
+	const char* output = "animation_benchmark.json";
+	u32 samples = 256;
+	u32 repetitions = 20;
+	// relative to max(1, |value|), translations are dequantized in float by the batched path and in double per track
+	float tolerance = 1e-5f;
+};
+
+struct Result {
+	Animation* animation;
+	u32 translation_tracks = 0;
+	u32 rotation_tracks = 0;
+	float batched_ns = 0; // per sample
+	float per_track_ns = 0; // per sample
+	float max_translation_error = 0;
+	float max_rotation_error = 0;
+};
+
+static bool parseOptions(int argc, char* argv[], Options& options) {
+	const bench::Option table[] = {
+		{ "-animations", options.animations },
+		{ "-output", options.output },
+		{ "-samples", options.samples },
+		{ "-repetitions", options.repetitions },
+		{ "-tolerance", options.tolerance },
+	};
+	if (!bench::parseOptions(argc, argv, table)) return false;
+	if (options.animations[0] == '\0') {
+		logError("Missing -animations");
+		return false;
+	}
+	if (options.samples == 0 || options.repetitions == 0) {
+		logError("-samples and -repetitions must be greater than 0");
+		return false;
+	}
+	return true;
+}
+
+// reference, decodes one track at a time with the same interpolation as AnimationSampler
+static void samplePerTrack(const Animation& anim, Time time, Pose& pose) {
+	const float sample = clamp(time.toFrame(anim.getFPS()), 0.f, anim.getFramesCount() - 0.00001f);
+	const u32 sample_idx = u32(sample);
+	const float t = sample - sample_idx;
+
+	for (const Animation::ConstTranslationTrack& track : anim.getConstTranslations()) {
+		pose.positions[track.bone_index] = track.value;
+	}
+	for (const Animation::TranslationTrack& track : anim.getTranslations()) {
+		pose.positions[track.bone_index] = lerp(anim.getTranslation(sample_idx, track), anim.getTranslation(sample_idx + 1, track), t);
+	}
+	for (const Animation::KeyframedTranslationTrack& track : anim.getKeyframedTranslations()) {
+		pose.positions[track.bone_index] = lerp(anim.getTranslation(sample_idx, track), anim.getTranslation(sample_idx + 1, track), t);
+	}
+	for (const Animation::ConstRotationTrack& track : anim.getConstRotations()) {
+		pose.rotations[track.bone_index] = track.value;
+	}
+	for (const Animation::RotationTrack& track : anim.getRotations()) {
+		pose.rotations[track.bone_index] = nlerp(anim.getRotation(sample_idx, track), anim.getRotation(sample_idx + 1, track), t);
+	}
+	for (const Animation::KeyframedRotationTrack& track : anim.getKeyframedRotations()) {
+		pose.rotations[track.bone_index] = nlerp(anim.getRotation(sample_idx, track), anim.getRotation(sample_idx + 1, track), t);
+	}
+}
+
+static float relativeError(float a, float b) {
+	return fabsf(a - b) / maximum(1.f, fabsf(b));
+}
+
+struct Benchmark {
+	Benchmark(const Options& options, IAllocator& allocator)
+		: options(options)
+		, allocator(allocator)
+		, results(allocator)
+	{}
+
+	bool init() {
+		Engine::InitArgs init_args;
+		init_args.log_path = "engine/animation_benchmark.log";
+		engine = Engine::create(static_cast<Engine::InitArgs&&>(init_args), allocator);
+
+		// models can not be loaded without renderer, which needs a window; the window is never shown
+		os::InitWindowArgs window_args;
+		window_args.name = "Animation benchmark";
+		window = os::createWindow(window_args);
+		engine->setMainWindow(window);
+		engine->init();
+		return true;
+	}
+
+	bool loadAnimations() {
+		ResourceManagerHub& rm = engine->getResourceManager();
+		StringView list = options.animations;
+		while (!list.empty()) {
+			const char* comma = find(list, ',');
+			const StringView path(list.begin, comma ? comma : list.end);
+			list.begin = comma ? comma + 1 : list.end;
+			if (path.empty()) continue;
+
+			Result& result = results.emplace();
+			result.animation = rm.load<Animation>(Path(path));
+		}
+
+		FileSystem& fs = engine->getFileSystem();
+		for (;;) {
+			bool loading = false;
+			for (const Result& result : results) {
+				if (result.animation->isEmpty()) loading = true;
+			}
+			if (!loading) break;
+			os::sleep(10);
+			fs.processCallbacks();
+		}
+
+		bool res = true;
+		for (const Result& result : results) {
+			if (!result.animation->isReady()) {
+				logError("Failed to load ", result.animation->getPath());
+				res = false;
+			}
+		}
+		return res;
+	}
+
+	bool run(Result& result) {
+		Animation& anim = *result.animation;
+		Model& skeleton = *anim.getSkeleton();
+		result.translation_tracks = anim.getTranslations().size() + anim.getConstTranslations().size() + anim.getKeyframedTranslations().size();
+		result.rotation_tracks = anim.getRotations().size() + anim.getConstRotations().size() + anim.getKeyframedRotations().size();
+
+		Pose batched(allocator);
+		Pose per_track(allocator);
+		batched.resize(skeleton.getBones().length());
+		per_track.resize(skeleton.getBones().length());
+		for (u32 i = 0; i < batched.count; ++i) {
+			batched.positions[i] = per_track.positions[i] = Vec3::ZERO;
+			batched.rotations[i] = per_track.rotations[i] = Quat::IDENTITY;
+		}
+
+		Animation::Cursor cursor(allocator);
+		Animation::SampleContext ctx;
+		ctx.pose = &batched;
+		ctx.model = &skeleton;
+		ctx.cursor = &cursor;
+
+		auto getTime = [&](u32 sample){
+			return Time::fromSeconds(anim.getLength().seconds() * sample / options.samples);
+		};
+
+		for (u32 i = 0; i < options.samples; ++i) {
+			ctx.time = getTime(i);
+			anim.getRelativePose(ctx);
+			samplePerTrack(anim, ctx.time, per_track);
+			for (u32 j = 0; j < batched.count; ++j) {
+				const Vec3 a = batched.positions[j];
+				const Vec3 b = per_track.positions[j];
+				result.max_translation_error = maximum(result.max_translation_error, relativeError(a.x, b.x), relativeError(a.y, b.y), relativeError(a.z, b.z));
+				const Quat qa = batched.rotations[j];
+				const Quat qb = per_track.rotations[j];
+				result.max_rotation_error = maximum(result.max_rotation_error, fabsf(qa.x - qb.x), fabsf(qa.y - qb.y), fabsf(qa.z - qb.z), fabsf(qa.w - qb.w));
+			}
+		}
+
+		// fastest repetition, the sweep over all samples is short enough to be mostly undisturbed
+		double batched_best = 1e30;
+		double per_track_best = 1e30;
+		const double to_ns = 1e9 / os::Timer::getFrequency();
+		for (u32 r = 0; r < options.repetitions; ++r) {
+			u64 start = os::Timer::getRawTimestamp();
+			for (u32 i = 0; i < options.samples; ++i) {
+				ctx.time = getTime(i);
+				anim.getRelativePose(ctx);
+			}
+			batched_best = minimum(batched_best, (os::Timer::getRawTimestamp() - start) * to_ns);
+
+			start = os::Timer::getRawTimestamp();
+			for (u32 i = 0; i < options.samples; ++i) {
+				samplePerTrack(anim, getTime(i), per_track);
+			}
+			per_track_best = minimum(per_track_best, (os::Timer::getRawTimestamp() - start) * to_ns);
+		}
+		result.batched_ns = float(batched_best / options.samples);
+		result.per_track_ns = float(per_track_best / options.samples);
+
+		logInfo(anim.getPath(), ": batched ", result.batched_ns, " ns, per track ", result.per_track_ns
+			, " ns, max error translation ", result.max_translation_error, " rotation ", result.max_rotation_error);
+		return result.max_translation_error <= options.tolerance && result.max_rotation_error <= options.tolerance;
+	}
+
+	bool writeResults() {
+		OutputMemoryStream out(allocator);
+		out << "{\n";
+		out << "\t\"samples\": " << options.samples << ",\n";
+		out << "\t\"tolerance\": " << options.tolerance << ",\n";
+		out << "\t\"animations\": [\n";
+		for (const Result& result : results) {
+			out << "\t\t{ \"path\": "; writeJSONString(out, result.animation->getPath().c_str());
+			out << ", \"translation_tracks\": " << result.translation_tracks;
+			out << ", \"rotation_tracks\": " << result.rotation_tracks;
+			out << ", \"batched_ns\": " << result.batched_ns;
+			out << ", \"per_track_ns\": " << result.per_track_ns;
+			out << ", \"max_translation_error\": " << result.max_translation_error;
+			out << ", \"max_rotation_error\": " << result.max_rotation_error;
+			out << (&result == &results.last() ? " }\n" : " },\n");
+		}
+		out << "\t]\n}\n";
+		return bench::writeResults(options.output, out);
+	}
+
+	void shutdown() {
+		for (const Result& result : results) result.animation->decRefCount();
+		results.clear();
+		engine.reset();
+		if (window != os::INVALID_WINDOW) os::destroyWindow(window);
+	}
+
+	const Options& options;
+	IAllocator& allocator;
+	UniquePtr<Engine> engine;
+	os::WindowHandle window = os::INVALID_WINDOW;
+	Array<Result> results;
+};
+
+} // anonymous namespace
+
+static int benchmarkMain(int argc, char* argv[], IAllocator& allocator) {
+	Options options;
+	if (!parseOptions(argc, argv, options)) return 1;
+
+	int exit_code = 1;
+	Benchmark benchmark(options, allocator);
+	if (benchmark.init() && benchmark.loadAnimations()) {
+		bool matches = true;
+		for (Result& result : benchmark.results) {
+			if (!benchmark.run(result)) {
+				logError(result.animation->getPath(), ": batched pose differs from per-track pose by more than ", options.tolerance);
+				matches = false;
+			}
+		}
+		if (benchmark.writeResults() && matches) exit_code = 0;
+	}
+	benchmark.shutdown();
+	return exit_code;
+}
+
+int main(int argc, char* argv[]) {
+	return bench::run(argc, argv, benchmarkMain);
+}
@@ -0,0 +1,102 @@
+#include "benchmarks/benchmark.h"
+#include "core/debug.h"
+#include "core/default_allocator.h"
+#include "core/job_system.h"
+#include "core/log.h"
+#include "core/log_callback.h"
+#include "core/os.h"
+#include "core/profiler.h"
+#include "core/stream.h"
+#include "core/string.h"
+#include "core/sync.h"
+#include <stdio.h>
+
+namespace Lumix::bench {
+
+static void consoleLog(LogLevel level, const char* message) {
+	const char* prefix = "";
+	switch (level) {
+		case LogLevel::WARNING: prefix = "[WARNING] "; break;
+		case LogLevel::ERROR: prefix = "[ERROR] "; break;
+		default: break;
+	}
+	printf("%s%s\n", prefix, message);
+}
+
+bool parseOptions(int argc, char* argv[], Span<const Option> options) {
+	for (int i = 1; i < argc; ++i) {
+		const StringView arg = argv[i];
+		const Option* option = nullptr;
+		for (const Option& o : options) {
+			if (equalStrings(arg, o.name)) option = &o;
+		}
+		if (!option) {
+			logError("Unknown option ", arg);
+			return false;
+		}
+		if (i + 1 == argc) {
+			logError("Missing value for ", arg);
+			return false;
+		}
+		const char* value = argv[++i];
+		switch (option->type) {
+			case Option::Type::STRING: *(const char**)option->value = value; break;
+			case Option::Type::U32: fromCString(value, *(u32*)option->value); break;
+			case Option::Type::FLOAT: fromCString(value, *(float*)option->value); break;
+		}
+	}
+	return true;
+}
+
+bool writeResults(const char* path, const OutputMemoryStream& data) {
+	os::OutputFile file;
+	if (!file.open(path)) {
+		logError("Could not create ", path);
+		return false;
+	}
+	const bool res = file.write(data.data(), data.size());
+	file.close();
+	if (!res) logError("Could not write ", path);
+	return res;
+}
+
+int run(int argc, char* argv[], MainFunction main) {
+	registerLogCallback<&consoleLog>();
+	DefaultAllocator allocator;
+	debug::init(allocator);
+	profiler::init(allocator);
+
+	struct Data {
+		Data(IAllocator& allocator) : semaphore(0, 1), allocator(allocator) {}
+		Semaphore semaphore;
+		IAllocator& allocator;
+		MainFunction main;
+		int argc;
+		char** argv;
+		int exit_code = 1;
+	} data(allocator);
+	data.main = main;
+	data.argc = argc;
+	data.argv = argv;
+
+	if (jobs::init(os::getCPUsCount(), allocator)) {
+		profiler::setThreadName("Main thread");
+		jobs::run(&data, [](void* ptr) {
+			Data* data = (Data*)ptr;
+			data->exit_code = data->main(data->argc, data->argv, data->allocator);
+			data->semaphore.signal();
+		}, nullptr, 0);
+		data.semaphore.wait();
+		jobs::shutdown();
+	}
+	else {
+		logError("Failed to initialize job system.");
+	}
+
+	profiler::shutdown();
+	debug::shutdown();
+	unregisterLogCallback<&consoleLog>();
+	return data.exit_code;
+}
+
+} // namespace Lumix::bench
@@ -0,0 +1,46 @@
+#pragma once
+
+// shared parts of benchmark executables - command line parsing, results output and core systems bootstrap
+
+#include "core/core.h"
+#include "core/span.h"
+
+namespace Lumix {
+
+struct IAllocator;
+struct IOutputStream;
+struct OutputMemoryStream;
+
+namespace bench {
+
+// `-name <value>` command line option, `value` points to a member of benchmark's options
+struct Option {
+	enum class Type : u8 {
+		STRING,
+		U32,
+		FLOAT
+	};
+
+	Option(const char* name, const char*& value) : name(name), type(Type::STRING), value(&value) {}
+	Option(const char* name, u32& value) : name(name), type(Type::U32), value(&value) {}
+	Option(const char* name, float& value) : name(name), type(Type::FLOAT), value(&value) {}
+
+	const char* name;
+	Type type;
+	void* value;
+};
+
+// parses `-name <value>` pairs, logs an error and returns false on unknown option or missing value
+bool parseOptions(int argc, char* argv[], Span<const Option> options);
+
+// writes serialized results to `path`, logs an error on failure
+bool writeResults(const char* path, const OutputMemoryStream& data);
+
+using MainFunction = int (*)(int argc, char* argv[], IAllocator& allocator);
+
+// logs to console, initializes debug, profiler and job system, calls `main` from a job and shuts everything down
+// returns exit code of `main`, or 1 if the job system could not be initialized
+int run(int argc, char* argv[], MainFunction main);
+
+} // namespace bench
+} // namespace Lumix
@@ -0,0 +1,497 @@
+// micro-benchmarks of core containers, allocators, job system, hashes and streams
+// usage: core_benchmarks [-filter <substring>] [-output <path.json>] [-repetitions <count>] [-min_time_ms <ms>]
+// every benchmark is calibrated to run at least `min_time_ms`, then it is run `repetitions` times
+// and the median is reported, so the results are comparable between runs on the same machine
+
+#include "benchmarks/benchmark.h"
+#include "core/arena_allocator.h"
+#include "core/array.h"
+#include "core/associative_array.h"
+#include "core/atomic.h"
+#include "core/default_allocator.h"
+#include "core/hash.h"
+#include "core/hash_map.h"
+#include "core/job_system.h"
+#include "core/log.h"
+#include "core/math.h"
+#include "core/os.h"
+#include "core/page_allocator.h"
+#include "core/queue.h"
+#include "core/ring_buffer.h"
+#include "core/sort.h"
+#include "core/stream.h"
+#include "core/string.h"
+#include <stdio.h>
+
+using namespace Lumix;
+
+namespace {
+
+// counts allocations, so we can report allocations per operation
+struct CountingAllocator final : IAllocator {
+	CountingAllocator(IAllocator& parent) : parent(parent) {}
+
+	void* allocate(size_t size, size_t align) override {
+		allocations.inc();
+		return parent.allocate(size, align);
+	}
+
+	void deallocate(void* ptr) override { parent.deallocate(ptr); }
+
+	void* reallocate(void* ptr, size_t new_size, size_t old_size, size_t align) override {
+		if (new_size > 0) allocations.inc();
+		return parent.reallocate(ptr, new_size, old_size, align);
+	}
+
+	IAllocator* getParent() const override { return &parent; }
+
+	IAllocator& parent;
+	AtomicI64 allocations = 0;
+};
+
+// deterministic pseudo random numbers, so every run works with the same data
+struct Random {
+	u32 next() {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	u32 state = 0x1234'5678;
+};
+
+// keeps the compiler from removing computations, whose results are not used
+static volatile u64 g_sink;
+template <typename T> void consume(const T& value) { g_sink = g_sink + (u64)value; }
+
+struct State {
+	State(CountingAllocator& allocator, u32 iterations)
+		: allocator(allocator)
+		, iterations(iterations)
+	{}
+
+	// call around the measured part, setup before `begin` and cleanup after `end` are not measured
+	void begin() {
+		allocations = allocator.allocations;
+		start = os::Timer::getRawTimestamp();
+	}
+
+	void end() {
+		end_time = os::Timer::getRawTimestamp();
+		allocations = allocator.allocations - allocations;
+	}
+
+	CountingAllocator& allocator;
+	const u32 iterations;
+	u64 start = 0;
+	u64 end_time = 0;
+	i64 allocations = 0;
+};
+
+using BenchmarkFunction = void (*)(State&);
+
+struct Benchmark {
+	const char* name;
+	BenchmarkFunction function;
+};
+
+struct Result {
+	const char* name;
+	u32 iterations;
+	double ns_per_op;
+	double min_ns_per_op;
+	double max_ns_per_op;
+	double allocs_per_op;
+};
+
+// containers
+
+static void arrayPush(State& state) {
+	Array<u32> array(state.allocator);
+	state.begin();
+	for (u32 i = 0; i < state.iterations; ++i) array.push(i);
+	state.end();
+	consume(array.size());
+}
+
+static void arrayIterate(State& state) {
+	Array<u32> array(state.allocator);
+	array.resize(4096);
+	for (u32 i = 0; i < 4096; ++i) array[i] = i;
+	state.begin();
+	u64 sum = 0;
+	for (u32 i = 0; i < state.iterations; ++i) sum += array[i & 4095];
+	state.end();
+	consume(sum);
+}
+
+static void hashMapInsert(State& state) {
+	HashMap<u32, u32> map(state.allocator);
+	Random random;
+	state.begin();
+	for (u32 i = 0; i < state.iterations; ++i) {
+		const u32 key = random.next();
+		if (!map.find(key).isValid()) map.insert(key, i);
+	}
+	state.end();
+	consume(map.size());
+}
+
+static void hashMapFind(State& state) {
+	HashMap<u32, u32> map(state.allocator);
+	Random random;
+	u32 keys[4096];
+	for (u32 i = 0; i < lengthOf(keys); ++i) {
+		keys[i] = random.next();
+		map.insert(keys[i], i);
+	}
+	state.begin();
+	u64 sum = 0;
+	for (u32 i = 0; i < state.iterations; ++i) {
+		auto iter = map.find(keys[i & 4095]);
+		sum += iter.value();
+	}
+	state.end();
+	consume(sum);
+}
+
+static void associativeArrayInsert(State& state) {
+	AssociativeArray<u32, u32> array(state.allocator);
+	Random random;
+	state.begin();
+	for (u32 i = 0; i < state.iterations; ++i) {
+		// sorted insert is O(n), keep the array small
+		if ((i & 1023) == 0) array.clear();
+		const u32 key = random.next();
+		if (array.find(key) < 0) array.insert(key, i);
+	}
+	state.end();
+	consume(array.size());
+}
+
+static void associativeArrayFind(State& state) {
+	AssociativeArray<u32, u32> array(state.allocator);
+	Random random;
+	u32 keys[1024];
+	for (u32 i = 0; i < lengthOf(keys); ++i) {
+		keys[i] = random.next();
+		array.insert(keys[i], i);
+	}
+	state.begin();
+	u64 sum = 0;
+	for (u32 i = 0; i < state.iterations; ++i) sum += array.find(keys[i & 1023]);
+	state.end();
+	consume(sum);
+}
+
+static void ringBufferPushPop(State& state) {
+	RingBuffer<u32, 256> ring(state.allocator);
+	state.begin();
+	u64 sum = 0;
+	for (u32 i = 0; i < state.iterations; ++i) {
+		ring.push(i);
+		u32 v;
+		if (ring.pop(v)) sum += v;
+	}
+	state.end();
+	consume(sum);
+}
+
+static void queuePushPop(State& state) {
+	Queue<u32, 256> queue;
+	state.begin();
+	u64 sum = 0;
+	for (u32 i = 0; i < state.iterations; ++i) {
+		queue.push(i);
+		sum += queue.front();
+		queue.pop();
+	}
+	state.end();
+	consume(sum);
+}
+
+// one operation is one sorted element, arrays have fixed size, so the cost per element does not depend on iteration count
+static void sortU32(State& state) {
+	enum { SIZE = 4096 };
+	u32 source[SIZE];
+	Random random;
+	for (u32& v : source) v = random.next();
+	Array<u32> values(state.allocator);
+	values.resize(SIZE);
+	state.begin();
+	for (u32 i = 0; i < state.iterations; i += SIZE) {
+		const u32 count = minimum(state.iterations - i, (u32)SIZE);
+		memcpy(values.begin(), source, count * sizeof(u32));
+		sort(values.begin(), values.begin() + count, [](u32 a, u32 b){ return a < b; });
+		consume(values[0]);
+	}
+	state.end();
+}
+
+// allocators
+
+// allocations of the benchmarked allocator itself are not counted
+static void defaultAllocator(State& state) {
+	DefaultAllocator allocator;
+	state.begin();
+	for (u32 i = 0; i < state.iterations; ++i) {
+		void* ptr = allocator.allocate(16 + (i & 255), 8);
+		consume((uintptr)ptr);
+		allocator.deallocate(ptr);
+	}
+	state.end();
+}
+
+static void pageAllocator(State& state) {
+	PageAllocator allocator(state.allocator);
+	state.begin();
+	for (u32 i = 0; i < state.iterations; ++i) {
+		void* ptr = allocator.allocate();
+		consume((uintptr)ptr);
+		allocator.deallocate(ptr);
+	}
+	state.end();
+}
+
+static void arenaAllocator(State& state) {
+	ArenaAllocator allocator(64 * 1024 * 1024, state.allocator, "benchmark");
+	state.begin();
+	for (u32 i = 0; i < state.iterations; ++i) {
+		if ((i & 4095) == 0) allocator.reset();
+		void* ptr = allocator.allocate(64, 8);
+		consume((uintptr)ptr);
+	}
+	state.end();
+}
+
+// job system
+
+static void jobsRunWait(State& state) {
+	state.begin();
+	for (u32 i = 0; i < state.iterations; ++i) {
+		jobs::Counter counter;
+		jobs::run(nullptr, [](void*){ consume(1); }, &counter);
+		jobs::wait(&counter);
+	}
+	state.end();
+}
+
+// one operation is one item
+static void jobsForEach(State& state) {
+	AtomicI64 sum = 0;
+	state.begin();
+	jobs::forEach(state.iterations, 64, [&](u32 from, u32 to){
+		i64 s = 0;
+		for (u32 i = from; i < to; ++i) s += i;
+		sum.add(s);
+	});
+	state.end();
+	consume(sum.value);
+}
+
+// yield switches to the scheduler fiber and back
+static void fiberSwitch(State& state) {
+	state.begin();
+	for (u32 i = 0; i < state.iterations; ++i) jobs::yield();
+	state.end();
+}
+
+// hashes, one operation hashes 64 bytes
+
+static u8 g_hash_data[64] = {};
+
+static void rollingHasher(State& state) {
+	RollingHasher hasher;
+	u64 sum = 0;
+	state.begin();
+	for (u32 i = 0; i < state.iterations; ++i) {
+		hasher.begin();
+		hasher.update(g_hash_data, sizeof(g_hash_data));
+		sum += hasher.end().getHashValue();
+	}
+	state.end();
+	consume(sum);
+}
+
+static void stableHash(State& state) {
+	u64 sum = 0;
+	state.begin();
+	for (u32 i = 0; i < state.iterations; ++i) {
+		g_hash_data[0] = (u8)i;
+		sum += StableHash(g_hash_data, sizeof(g_hash_data)).getHashValue();
+	}
+	state.end();
+	consume(sum);
+}
+
+static void runtimeHash(State& state) {
+	u64 sum = 0;
+	state.begin();
+	for (u32 i = 0; i < state.iterations; ++i) {
+		g_hash_data[0] = (u8)i;
+		sum += RuntimeHash(g_hash_data, sizeof(g_hash_data)).getHashValue();
+	}
+	state.end();
+	consume(sum);
+}
+
+static void runtimeHash32(State& state) {
+	u64 sum = 0;
+	state.begin();
+	for (u32 i = 0; i < state.iterations; ++i) {
+		g_hash_data[0] = (u8)i;
+		sum += RuntimeHash32(g_hash_data, sizeof(g_hash_data)).getHashValue();
+	}
+	state.end();
+	consume(sum);
+}
+
+// streams, 64 KB buffers are reused, so memory does not grow with the iteration count
+
+static void outputMemoryStreamWrite(State& state) {
+	enum { SIZE = 64 * 1024 };
+	OutputMemoryStream stream(state.allocator);
+	stream.reserve(SIZE);
+	state.begin();
+	for (u32 i = 0; i < state.iterations; ++i) {
+		if (stream.size() == SIZE) stream.clear();
+		stream.write(i);
+	}
+	state.end();
+	consume(stream.size());
+}
+
+static void inputMemoryStreamRead(State& state) {
+	enum { SIZE = 64 * 1024 };
+	OutputMemoryStream data(state.allocator);
+	data.resize(SIZE);
+	for (u32 i = 0; i < SIZE / sizeof(u32); ++i) memcpy(data.getMutableData() + i * sizeof(u32), &i, sizeof(i));
+	InputMemoryStream stream(data);
+	u64 sum = 0;
+	state.begin();
+	for (u32 i = 0; i < state.iterations; ++i) {
+		if (stream.getPosition() == SIZE) stream.setPosition(0);
+		sum += stream.read<u32>();
+	}
+	state.end();
+	consume(sum);
+}
+
+static const Benchmark BENCHMARKS[] = {
+	{ "Array::push", arrayPush },
+	{ "Array::operator[]", arrayIterate },
+	{ "HashMap::insert", hashMapInsert },
+	{ "HashMap::find", hashMapFind },
+	{ "AssociativeArray::insert", associativeArrayInsert },
+	{ "AssociativeArray::find", associativeArrayFind },
+	{ "RingBuffer::push+pop", ringBufferPushPop },
+	{ "Queue::push+pop", queuePushPop },
+	{ "sort 4096 u32 (per element)", sortU32 },
+	{ "DefaultAllocator allocate+deallocate", defaultAllocator },
+	{ "PageAllocator allocate+deallocate", pageAllocator },
+	{ "ArenaAllocator allocate", arenaAllocator },
+	{ "jobs::run+wait", jobsRunWait },
+	{ "jobs::forEach (per item)", jobsForEach },
+	{ "fiber switch (jobs::yield)", fiberSwitch },
+	{ "RollingHasher 64B", rollingHasher },
+	{ "StableHash 64B", stableHash },
+	{ "RuntimeHash (xxh3) 64B", runtimeHash },
+	{ "RuntimeHash32 (xxh32) 64B", runtimeHash32 },
+	{ "OutputMemoryStream::write<u32>", outputMemoryStreamWrite },
+	{ "InputMemoryStream::read<u32>", inputMemoryStreamRead },
+};
+
+struct Options {
+	const char* filter = "";
+	const char* output = nullptr;
+	u32 repetitions = 7;
+	u32 min_time_ms = 50;
+};
+
+static double runOnce(const Benchmark& benchmark, CountingAllocator& allocator, u32 iterations, i64& allocations) {
+	State state(allocator, iterations);
+	benchmark.function(state);
+	allocations = state.allocations;
+	return double(state.end_time - state.start) * 1e9 / os::Timer::getFrequency();
+}
+
+static Result run(const Benchmark& benchmark, CountingAllocator& allocator, const Options& options) {
+	// calibrate the number of iterations, so one run takes at least `min_time_ms`
+	const double min_time_ns = options.min_time_ms * 1e6;
+	u32 iterations = 1;
+	i64 allocations;
+	for (;;) {
+		const double t = runOnce(benchmark, allocator, iterations, allocations);
+		if (t >= min_time_ns || iterations >= (1u << 30)) break;
+		const double factor = t > 0 ? min_time_ns * 1.2 / t : 100;
+		iterations = u32(minimum(double(iterations) * clamp(factor, 2.0, 100.0), double(1u << 30)));
+	}
+
+	double times[64];
+	const u32 repetitions = clamp(options.repetitions, 1u, (u32)lengthOf(times));
+	i64 total_allocations = 0;
+	for (u32 i = 0; i < repetitions; ++i) {
+		times[i] = runOnce(benchmark, allocator, iterations, allocations) / iterations;
+		total_allocations += allocations;
+	}
+	sort(times, times + repetitions, [](double a, double b){ return a < b; });
+
+	Result res;
+	res.name = benchmark.name;
+	res.iterations = iterations;
+	res.ns_per_op = times[repetitions / 2];
+	res.min_ns_per_op = times[0];
+	res.max_ns_per_op = times[repetitions - 1];
+	res.allocs_per_op = double(total_allocations) / (double(iterations) * repetitions);
+	return res;
+}
+
+static bool writeJSON(const char* path, Span<const Result> results, IAllocator& allocator) {
+	OutputMemoryStream out(allocator);
+	out << "{\n\t\"benchmarks\": [\n";
+	for (const Result& r : results) {
+		out << "\t\t{ \"name\": ";
+		writeJSONString(out, r.name);
+		out << ", \"iterations\": " << r.iterations
+			<< ", \"ns_per_op\": " << r.ns_per_op
+			<< ", \"min_ns_per_op\": " << r.min_ns_per_op
+			<< ", \"max_ns_per_op\": " << r.max_ns_per_op
+			<< ", \"allocs_per_op\": " << r.allocs_per_op
+			<< (&r == &results.back() ? " }\n" : " },\n");
+	}
+	out << "\t]\n}\n";
+	return bench::writeResults(path, out);
+}
+
+static bool parseOptions(int argc, char* argv[], Options& options) {
+	const bench::Option table[] = {
+		{ "-filter", options.filter },
+		{ "-output", options.output },
+		{ "-repetitions", options.repetitions },
+		{ "-min_time_ms", options.min_time_ms },
+	};
+	return bench::parseOptions(argc, argv, table);
+}
+
+} // anonymous namespace
+
+static int benchmarkMain(int argc, char* argv[], IAllocator& parent_allocator) {
+	Options options;
+	if (!parseOptions(argc, argv, options)) return 1;
+
+	CountingAllocator allocator(parent_allocator);
+	Array<Result> results(allocator);
+	printf("%-40s %14s %14s %14s %12s\n", "benchmark", "ns/op", "min ns/op", "max ns/op", "allocs/op");
+	for (const Benchmark& benchmark : BENCHMARKS) {
+		if (options.filter[0] && !findInsensitive(benchmark.name, options.filter)) continue;
+		const Result& r = results.emplace(run(benchmark, allocator, options));
+		printf("%-40s %14.3f %14.3f %14.3f %12.4f\n", r.name, r.ns_per_op, r.min_ns_per_op, r.max_ns_per_op, r.allocs_per_op);
+	}
+	const bool success = !options.output || writeJSON(options.output, results, allocator);
+	return success ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+	return bench::run(argc, argv, benchmarkMain);
+}
@@ -0,0 +1,531 @@
+// headless frame-time benchmark, simulates a world with fixed time delta and records per-frame
+// and per-profiler-block statistics, optionally compares them with a baseline to detect regressions
+// usage: frame_benchmark [-world <path>] [-stress <entity count>] [-stress_components <type,type,...>]
+//                        [-frames <count>] [-warmup <count>] [-dt <seconds>] [-output <path.json>]
+//                        [-baseline <path.json>] [-threshold <percent>] [-metric mean|p50|p95|p99|max] [-min_ms <ms>]
+// exit code is 1 if a metric regressed by more than `threshold` percent against the baseline
+
+#include "benchmarks/benchmark.h"
+#include "core/array.h"
+#include "core/crt.h"
+#include "core/hash_map.h"
+#include "core/log.h"
+#include "core/math.h"
+#include "core/os.h"
+#include "core/path.h"
+#include "core/profiler.h"
+#include "core/sort.h"
+#include "core/stream.h"
+#include "core/string.h"
+#include "core/tokenizer.h"
+#include "engine/engine.h"
+#include "engine/file_system.h"
+#include "engine/reflection.h"
+#include "engine/world.h"
+
+using namespace Lumix;
+
+namespace {
+
+struct Stats {
+	float mean = 0;
+	float p50 = 0;
+	float p95 = 0;
+	float p99 = 0;
+	float max = 0;
+
+	float get(StringView metric) const {
+		if (equalStrings(metric, "mean")) return mean;
+		if (equalStrings(metric, "p50")) return p50;
+		if (equalStrings(metric, "p99")) return p99;
+		if (equalStrings(metric, "max")) return max;
+		return p95;
+	}
+
+	// sorts `values`
+	static Stats compute(Array<float>& values) {
+		Stats res;
+		if (values.empty()) return res;
+		sort(values.begin(), values.end(), [](float a, float b){ return a < b; });
+		double sum = 0;
+		for (float v : values) sum += v;
+		res.mean = float(sum / values.size());
+		// nearest-rank percentiles
+		auto percentile = [&](float q){
+			const u32 rank = (u32)ceilf(q * values.size());
+			return values[clamp(rank, 1u, values.size()) - 1];
+		};
+		res.p50 = percentile(0.5f);
+		res.p95 = percentile(0.95f);
+		res.p99 = percentile(0.99f);
+		res.max = values.last();
+		return res;
+	}
+};
+
+struct BlockStats {
+	BlockStats(IAllocator& allocator) : name(allocator), per_frame(allocator) {}
+
+	String name;
+	u32 calls = 0;
+	Array<float> per_frame; // ms spent in the block, summed over all threads
+	Stats stats;
+};
+
+struct Options {
+	const char* world = nullptr;
+	const char* output = "frame_benchmark.json";
+	const char* baseline = nullptr;
+	const char* stress_components = "";
+	const char* metric = "p95";
+	u32 stress = 0;
+	u32 frames = 1000;
+	u32 warmup = 60;
+	float dt = 1 / 60.f;
+	float threshold = 10;
+	float min_ms = 0.05f;
+};
+
+static bool parseOptions(int argc, char* argv[], Options& options) {
+	const bench::Option table[] = {
+		{ "-world", options.world },
+		{ "-output", options.output },
+		{ "-baseline", options.baseline },
+		{ "-stress_components", options.stress_components },
+		{ "-metric", options.metric },
+		{ "-stress", options.stress },
+		{ "-frames", options.frames },
+		{ "-warmup", options.warmup },
+		{ "-dt", options.dt },
+		{ "-threshold", options.threshold },
+		{ "-min_ms", options.min_ms },
+	};
+	if (!bench::parseOptions(argc, argv, table)) return false;
+	if (options.frames == 0) {
+		logError("-frames must be greater than 0");
+		return false;
+	}
+	if (!options.world && options.stress == 0) options.stress = 10'000;
+	return true;
+}
+
+static bool readFile(const char* path, OutputMemoryStream& data) {
+	os::InputFile file;
+	if (!file.open(path)) return false;
+	data.resize(file.size());
+	const bool res = file.read(data.getMutableData(), data.size());
+	file.close();
+	return res;
+}
+
+struct Benchmark {
+	Benchmark(const Options& options, IAllocator& allocator)
+		: options(options)
+		, allocator(allocator)
+		, frame_begins(allocator)
+		, frame_times(allocator)
+		, blocks(allocator)
+		, block_map(allocator)
+	{}
+
+	bool loadWorld(World& world) {
+		OutputMemoryStream data(allocator);
+		if (!engine->getFileSystem().getContentSync(Path(options.world), data)) {
+			logError("Could not read ", options.world);
+			return false;
+		}
+
+		InputMemoryStream blob(data);
+		EntityMap entity_map(allocator);
+		WorldVersion version;
+		if (!world.deserialize(blob, entity_map, version)) {
+			logError("Failed to deserialize ", options.world);
+			return false;
+		}
+		return true;
+	}
+
+	// entities in a grid, each with all components from `-stress_components`
+	bool generateStressWorld(World& world) {
+		Array<ComponentType> types(allocator);
+		StringView list = options.stress_components;
+		while (!list.empty()) {
+			const char* comma = find(list, ',');
+			const StringView name(list.begin, comma ? comma : list.end);
+			list.begin = comma ? comma + 1 : list.end;
+			if (name.empty()) continue;
+
+			const ComponentType type = reflection::getComponentType(name);
+			if (!reflection::getComponent(type)) {
+				logError("Unknown component type ", name);
+				return false;
+			}
+			types.push(type);
+		}
+
+		const u32 side = (u32)ceilf(sqrtf((float)options.stress));
+		for (u32 i = 0; i < options.stress; ++i) {
+			const DVec3 pos(double(i % side) * 2, 0, double(i / side) * 2);
+			const EntityRef e = world.createEntity(pos, Quat::IDENTITY);
+			for (ComponentType type : types) world.createComponent(type, e);
+		}
+		logInfo("Generated stress world with ", options.stress, " entities");
+		return true;
+	}
+
+	void waitForFileSystem() {
+		FileSystem& fs = engine->getFileSystem();
+		while (fs.hasWork()) {
+			os::sleep(10);
+			fs.processCallbacks();
+		}
+		fs.processCallbacks();
+	}
+
+	bool simulate() {
+		Engine::InitArgs init_args;
+		init_args.log_path = "engine/frame_benchmark.log";
+		engine = Engine::create(static_cast<Engine::InitArgs&&>(init_args), allocator);
+
+		// some systems (renderer) can not be initialized without a window, the window is never shown
+		os::InitWindowArgs window_args;
+		window_args.name = "Frame benchmark";
+		window = os::createWindow(window_args);
+		engine->setMainWindow(window);
+		engine->init();
+		engine->setFixedTimeDelta(options.dt);
+
+		World& world = engine->createWorld();
+		const bool world_ready = options.world ? loadWorld(world) : generateStressWorld(world);
+		if (!world_ready) {
+			engine->destroyWorld(world);
+			return false;
+		}
+		waitForFileSystem();
+		engine->startGame(world);
+
+		for (u32 i = 0; i < options.warmup; ++i) engine->update(world);
+
+		if (!profiler::startStreaming(TEMP_PROFILE_PATH)) {
+			logError("Could not start profiler stream ", TEMP_PROFILE_PATH);
+			engine->stopGame(world);
+			engine->destroyWorld(world);
+			return false;
+		}
+
+		frame_begins.reserve(options.frames + 1);
+		frame_times.reserve(options.frames);
+		const float to_ms = 1000.f / profiler::frequency();
+		for (u32 i = 0; i < options.frames; ++i) {
+			const u64 begin = os::Timer::getRawTimestamp();
+			engine->update(world);
+			profiler::frame();
+			const u64 end = os::Timer::getRawTimestamp();
+			frame_begins.push(begin);
+			frame_times.push((end - begin) * to_ms);
+		}
+		frame_begins.push(os::Timer::getRawTimestamp());
+
+		profiler::stopStreaming();
+		engine->stopGame(world);
+		engine->destroyWorld(world);
+		return true;
+	}
+
+	void shutdown() {
+		engine.reset();
+		if (window != os::INVALID_WINDOW) os::destroyWindow(window);
+	}
+
+	u32 getFrameIndex(u64 time) const {
+		// `frame_begins` is sorted, last item is the end of the last frame
+		u32 lo = 0;
+		u32 hi = frame_begins.size() - 1;
+		if (time < frame_begins[0] || time >= frame_begins[hi]) return 0xffFFffFF;
+		while (hi - lo > 1) {
+			const u32 mid = (lo + hi) / 2;
+			if (frame_begins[mid] <= time) lo = mid;
+			else hi = mid;
+		}
+		return lo;
+	}
+
+	BlockStats& getBlock(const char* name) {
+		auto iter = block_map.find(name);
+		if (iter.isValid()) return blocks[iter.value()];
+
+		// same name can be stored in different places
+		for (u32 i = 0; i < (u32)blocks.size(); ++i) {
+			if (blocks[i].name == name) {
+				block_map.insert(name, i);
+				return blocks[i];
+			}
+		}
+		block_map.insert(name, blocks.size());
+		BlockStats& block = blocks.emplace(allocator);
+		block.name = name;
+		block.per_frame.resize(options.frames);
+		for (float& f : block.per_frame) f = 0;
+		return block;
+	}
+
+	void addBlock(const char* name, u64 from, u64 to, float to_ms) {
+		const u32 frame = getFrameIndex(from);
+		if (frame == 0xffFFffFF || to < from) return;
+		BlockStats& block = getBlock(name);
+		++block.calls;
+		block.per_frame[frame] += (to - from) * to_ms;
+	}
+
+	// `strings` maps block name addresses in events to names, `block_names` maps block ids to names
+	void gatherBlocks(Span<const u8> events, const HashMap<u64, const char*>& strings, HashMap<i32, const char*>& block_names, float to_ms) {
+		struct OpenBlock {
+			const char* name;
+			u64 time;
+		};
+		OpenBlock stack[64];
+		u32 depth = 0;
+		u32 p = 0;
+		while (p + sizeof(profiler::EventHeader) <= events.length()) {
+			profiler::EventHeader header;
+			memcpy(&header, events.begin() + p, sizeof(header));
+			if (header.size < sizeof(header) || p + header.size > events.length()) return;
+			const u8* data = events.begin() + p + sizeof(header);
+
+			switch (header.type) {
+				case profiler::EventType::BEGIN_BLOCK: {
+					profiler::BlockRecord r;
+					memcpy(&r, data, sizeof(r));
+					auto name_iter = strings.find((u64)(uintptr)r.name);
+					const char* name = name_iter.isValid() ? name_iter.value() : "N/A";
+					block_names.insert(r.id, name);
+					if (depth < lengthOf(stack)) stack[depth] = { name, header.time };
+					++depth;
+					break;
+				}
+				case profiler::EventType::CONTINUE_BLOCK: {
+					i32 id;
+					memcpy(&id, data, sizeof(id));
+					auto iter = block_names.find(id);
+					if (depth < lengthOf(stack)) stack[depth] = { iter.isValid() ? iter.value() : "N/A", header.time };
+					++depth;
+					break;
+				}
+				case profiler::EventType::BEGIN_JOB:
+					if (depth < lengthOf(stack)) stack[depth] = { "job", header.time };
+					++depth;
+					break;
+				case profiler::EventType::END_BLOCK:
+					// first events could have been written before the benchmark started
+					if (depth == 0) break;
+					--depth;
+					if (depth < lengthOf(stack)) addBlock(stack[depth].name, stack[depth].time, header.time, to_ms);
+					break;
+				default: break;
+			}
+			p += header.size;
+		}
+	}
+
+	bool computeBlockStats() {
+		OutputMemoryStream stream(allocator);
+		if (!readFile(TEMP_PROFILE_PATH, stream)) {
+			logError("Could not read ", TEMP_PROFILE_PATH);
+			return false;
+		}
+		os::deleteFile(TEMP_PROFILE_PATH);
+
+		OutputMemoryStream data(allocator);
+		InputMemoryStream stream_blob(stream);
+		if (!profiler::streamToBlob(stream_blob, data, allocator)) {
+			logError("Invalid profiler stream");
+			return false;
+		}
+
+		InputMemoryStream blob(data);
+		if (blob.read<u32>() > profiler::SERIALIZE_VERSION) return false;
+		const float to_ms = 1000.f / blob.read<u64>();
+		const u32 counters_count = blob.read<u32>();
+		blob.skip(counters_count * sizeof(profiler::Counter));
+		const u32 threads_count = blob.read<u32>() + 1;
+
+		Array<Span<const u8>> threads(allocator);
+		for (u32 i = 0; i < threads_count; ++i) {
+			blob.readString();
+			blob.read<u32>(); // thread id
+			blob.read<u8>(); // show
+			const u32 size = blob.read<u32>();
+			if (blob.hasOverflow() || blob.remaining() < size) return false;
+			const u8* events = (const u8*)blob.skip(size);
+			threads.push(Span(events, size));
+		}
+
+		// events reference names by addresses in the profiled process, which can be freed since (e.g. Lua strings),
+		// so we use copies made when the strings were streamed
+		HashMap<u64, const char*> strings(allocator);
+		const u32 strings_count = blob.read<u32>();
+		for (u32 i = 0; i < strings_count; ++i) {
+			const u64 key = blob.read<u64>();
+			const char* str = blob.readString();
+			if (!str || blob.hasOverflow()) return false;
+			strings.insert(key, str);
+		}
+
+		HashMap<i32, const char*> block_names(allocator);
+		for (Span<const u8> events : threads) gatherBlocks(events, strings, block_names, to_ms);
+
+		for (BlockStats& block : blocks) block.stats = Stats::compute(block.per_frame);
+		sort(blocks.begin(), blocks.end(), [](const BlockStats& a, const BlockStats& b){ return a.stats.mean > b.stats.mean; });
+		block_map.clear();
+		return true;
+	}
+
+	static void writeStats(IOutputStream& out, const Stats& stats) {
+		out << "\"mean\": " << stats.mean
+			<< ", \"p50\": " << stats.p50
+			<< ", \"p95\": " << stats.p95
+			<< ", \"p99\": " << stats.p99
+			<< ", \"max\": " << stats.max;
+	}
+
+	bool writeResults() {
+		OutputMemoryStream out(allocator);
+		out << "{\n";
+		out << "\t\"world\": "; writeJSONString(out, options.world ? options.world : "<stress>"); out << ",\n";
+		out << "\t\"stress_entities\": " << options.stress << ",\n";
+		out << "\t\"frames\": " << options.frames << ",\n";
+		out << "\t\"dt\": " << options.dt << ",\n";
+		out << "\t\"frame\": { "; writeStats(out, frame_stats); out << " },\n";
+		out << "\t\"blocks\": [\n";
+		for (const BlockStats& block : blocks) {
+			out << "\t\t{ \"name\": "; writeJSONString(out, block.name.c_str());
+			out << ", \"calls\": " << block.calls << ", ";
+			writeStats(out, block.stats);
+			out << (&block == &blocks.last() ? " }\n" : " },\n");
+		}
+		out << "\t]\n}\n";
+		return bench::writeResults(options.output, out);
+	}
+
+	// parses stats object, i.e. `{ "mean": 1.0, "p50": ... }` or its content
+	static void parseStats(Tokenizer& tokenizer, Stats& stats, StringView& name) {
+		for (;;) {
+			const Tokenizer::Token key = tokenizer.tryNextToken();
+			if (!key || key == "}") return;
+			if (key.type != Tokenizer::Token::STRING) continue;
+			if (!tokenizer.consume(":")) return;
+			const Tokenizer::Token value = tokenizer.tryNextToken();
+			if (!value) return;
+			if (value.type == Tokenizer::Token::STRING) {
+				if (key == "name") name = value.value;
+				continue;
+			}
+			if (value.type != Tokenizer::Token::NUMBER) continue;
+			const float v = Tokenizer::toFloat(value);
+			if (key == "mean") stats.mean = v;
+			else if (key == "p50") stats.p50 = v;
+			else if (key == "p95") stats.p95 = v;
+			else if (key == "p99") stats.p99 = v;
+			else if (key == "max") stats.max = v;
+		}
+	}
+
+	// returns number of regressed metrics, or -1 on error
+	i32 compareWithBaseline() {
+		OutputMemoryStream data(allocator);
+		if (!readFile(options.baseline, data)) {
+			logError("Could not read baseline ", options.baseline);
+			return -1;
+		}
+
+		const StringView metric = options.metric;
+		const float factor = 1 + options.threshold / 100.f;
+		i32 regressions = 0;
+		auto check = [&](const char* name, float baseline, float current){
+			if (baseline < options.min_ms) return;
+			const float change = (current / baseline - 1) * 100.f;
+			if (current > baseline * factor) {
+				logError("Regression in ", name, ": ", options.metric, " ", baseline, " ms -> ", current, " ms (+", change, "%)");
+				++regressions;
+			}
+		};
+
+		Tokenizer tokenizer(StringView((const char*)data.data(), (u32)data.size()), options.baseline);
+		bool found_frame = false;
+		for (;;) {
+			const Tokenizer::Token token = tokenizer.tryNextToken();
+			if (!token) break;
+			if (token.type != Tokenizer::Token::STRING) continue;
+
+			if (token == "frame") {
+				Stats baseline;
+				StringView name;
+				if (!tokenizer.consume(":") || !tokenizer.consume("{")) return -1;
+				parseStats(tokenizer, baseline, name);
+				check("frame", baseline.get(metric), frame_stats.get(metric));
+				found_frame = true;
+			}
+			else if (token == "blocks") {
+				if (!tokenizer.consume(":") || !tokenizer.consume("[")) return -1;
+				for (;;) {
+					const Tokenizer::Token t = tokenizer.tryNextToken();
+					if (!t || t == "]") break;
+					if (!(t == "{")) continue;
+
+					Stats baseline;
+					StringView name;
+					parseStats(tokenizer, baseline, name);
+					for (const BlockStats& block : blocks) {
+						if (equalStrings(name, block.name)) {
+							check(block.name.c_str(), baseline.get(metric), block.stats.get(metric));
+							break;
+						}
+					}
+				}
+			}
+		}
+		if (!found_frame) {
+			logError(options.baseline, " is not a valid baseline");
+			return -1;
+		}
+		return regressions;
+	}
+
+	static constexpr const char* TEMP_PROFILE_PATH = "frame_benchmark.lps";
+
+	const Options& options;
+	IAllocator& allocator;
+	UniquePtr<Engine> engine;
+	os::WindowHandle window = os::INVALID_WINDOW;
+	Array<u64> frame_begins;
+	Array<float> frame_times;
+	Stats frame_stats;
+	Array<BlockStats> blocks;
+	HashMap<const char*, u32> block_map; // keys point to the profiler data, only valid in computeBlockStats
+};
+
+} // anonymous namespace
+
+static int benchmarkMain(int argc, char* argv[], IAllocator& allocator) {
+	Options options;
+	if (!parseOptions(argc, argv, options)) return 1;
+
+	Benchmark benchmark(options, allocator);
+	const bool simulated = benchmark.simulate();
+	benchmark.shutdown();
+	if (!simulated || !benchmark.computeBlockStats()) return 1;
+
+	benchmark.frame_stats = Stats::compute(benchmark.frame_times);
+	logInfo("Frame time (ms): mean ", benchmark.frame_stats.mean, ", p95 ", benchmark.frame_stats.p95, ", max ", benchmark.frame_stats.max);
+	if (!benchmark.writeResults()) return 1;
+	if (!options.baseline) return 0;
+
+	const i32 regressions = benchmark.compareWithBaseline();
+	if (regressions > 0) logError(regressions, " metric(s) regressed by more than ", options.threshold, "%");
+	if (regressions == 0) logInfo("No regressions against ", options.baseline);
+	return regressions == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+	return bench::run(argc, argv, benchmarkMain);
+}
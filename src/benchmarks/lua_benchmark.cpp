@@ -0,0 +1,220 @@
+// Lua entity API benchmark, measures time and garbage of script patterns typical for update() functions
+// usage: lua_benchmark [-iterations <count>] [-repetitions <count>] [-output <path.json>]
+
+#include "benchmarks/benchmark.h"
+#include "core/array.h"
+#include "core/log.h"
+#include "core/math.h"
+#include "core/os.h"
+#include "core/stream.h"
+#include "core/string.h"
+#include "engine/component_types.h"
+#include "engine/engine.h"
+#include "engine/plugin.h"
+#include "engine/world.h"
+#include "lua/lua_script_system.h"
+#include "lua/lua_wrapper.h"
+#include <lua.h>
+
+using namespace Lumix;
+
+namespace {
+
+struct Options {
+	const char* output = "lua_benchmark.json";
+	u32 iterations = 100'000;
+	u32 repetitions = 10;
+};
+
+struct Result {
+	const char* name;
+	float ns = 0; // per iteration
+	float garbage = 0; // bytes per iteration
+};
+
+// each pattern is called with the number of iterations
+static const char* PATTERNS_SRC = R"#(
+	local e = bench_entity
+	local patterns = {}
+	patterns.position_table = function(n)
+		for i = 1, n do
+			local p = e.position
+			e.position = {p[1] + 0.001, p[2], p[3]}
+		end
+	end
+	patterns.position_vector = function(n)
+		local d = vector.create(0.001, 0, 0)
+		for i = 1, n do
+			e.vposition = e.vposition + d
+		end
+	end
+	patterns.rotation = function(n)
+		for i = 1, n do
+			local r = e.rotation
+			e.rotation = r
+		end
+	end
+	patterns.name = function(n)
+		for i = 1, n do
+			local name = e.name
+		end
+	end
+	patterns.component = function(n)
+		for i = 1, n do
+			local cmp = e.lua_script
+		end
+	end
+	patterns.method = function(n)
+		for i = 1, n do
+			local has = e:hasComponent("lua_script")
+		end
+	end
+	return patterns
+)#";
+
+static const char* PATTERN_NAMES[] = { "position_table", "position_vector", "rotation", "name", "component", "method" };
+
+static bool parseOptions(int argc, char* argv[], Options& options) {
+	const bench::Option table[] = {
+		{ "-output", options.output },
+		{ "-iterations", options.iterations },
+		{ "-repetitions", options.repetitions },
+	};
+	if (!bench::parseOptions(argc, argv, table)) return false;
+	if (options.iterations == 0 || options.repetitions == 0) {
+		logError("-iterations and -repetitions must be greater than 0");
+		return false;
+	}
+	return true;
+}
+
+static u64 getLuaMemory(lua_State* L) {
+	return u64(lua_gc(L, LUA_GCCOUNT, 0)) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+}
+
+struct Benchmark {
+	Benchmark(const Options& options, IAllocator& allocator)
+		: options(options)
+		, allocator(allocator)
+		, results(allocator)
+	{}
+
+	bool init() {
+		Engine::InitArgs init_args;
+		init_args.log_path = "engine/lua_benchmark.log";
+		engine = Engine::create(static_cast<Engine::InitArgs&&>(init_args), allocator);
+
+		// some systems (renderer) can not be initialized without a window, the window is never shown
+		os::InitWindowArgs window_args;
+		window_args.name = "Lua benchmark";
+		window = os::createWindow(window_args);
+		engine->setMainWindow(window);
+		engine->init();
+
+		auto* system = (LuaScriptSystem*)engine->getSystemManager().getSystem("lua_script");
+		if (!system) {
+			logError("Lua plugin is not available");
+			return false;
+		}
+		L = system->getState();
+
+		world = &engine->createWorld();
+		const EntityRef e = world->createEntity(DVec3(0), Quat::IDENTITY);
+		world->createComponent(types::lua_script, e);
+		engine->startGame(*world);
+
+		LuaWrapper::pushEntity(L, e, world);
+		lua_setglobal(L, "bench_entity");
+		if (!LuaWrapper::execute(L, PATTERNS_SRC, "lua_benchmark", 1)) return false;
+		patterns = LuaWrapper::createRef(L);
+		lua_pop(L, 1);
+		return true;
+	}
+
+	// fastest repetition, garbage is measured with the collector stopped
+	void measure(Result& result) {
+		double best = 1e30;
+		u64 garbage = 0;
+		const double to_ns = 1e9 / os::Timer::getFrequency();
+		lua_rawgeti(L, LUA_REGISTRYINDEX, patterns);
+		for (u32 r = 0; r < options.repetitions; ++r) {
+			lua_getfield(L, -1, result.name);
+			lua_pushinteger(L, options.iterations);
+			lua_gc(L, LUA_GCCOLLECT, 0);
+			lua_gc(L, LUA_GCSTOP, 0);
+			const u64 mem_before = getLuaMemory(L);
+			const u64 start = os::Timer::getRawTimestamp();
+			const bool success = LuaWrapper::pcall(L, 1, 0);
+			best = minimum(best, (os::Timer::getRawTimestamp() - start) * to_ns);
+			garbage = getLuaMemory(L) - mem_before;
+			lua_gc(L, LUA_GCRESTART, 0);
+			if (!success) break;
+		}
+		lua_pop(L, 1);
+		result.ns = float(best / options.iterations);
+		result.garbage = float(double(garbage) / options.iterations);
+		logInfo(result.name, ": ", result.ns, " ns, ", result.garbage, " bytes of garbage per iteration");
+	}
+
+	void run() {
+		for (const char* name : PATTERN_NAMES) {
+			Result& result = results.emplace();
+			result.name = name;
+			measure(result);
+		}
+	}
+
+	bool writeResults() {
+		OutputMemoryStream out(allocator);
+		out << "{\n";
+		out << "\t\"iterations\": " << options.iterations << ",\n";
+		out << "\t\"results\": [\n";
+		for (const Result& result : results) {
+			out << "\t\t{ \"pattern\": "; writeJSONString(out, result.name);
+			out << ", \"ns\": " << result.ns;
+			out << ", \"garbage_bytes\": " << result.garbage;
+			out << (&result == &results.last() ? " }\n" : " },\n");
+		}
+		out << "\t]\n}\n";
+		return bench::writeResults(options.output, out);
+	}
+
+	void shutdown() {
+		if (L && patterns != -1) LuaWrapper::releaseRef(L, patterns);
+		if (world) {
+			engine->stopGame(*world);
+			engine->destroyWorld(*world);
+		}
+		engine.reset();
+		if (window != os::INVALID_WINDOW) os::destroyWindow(window);
+	}
+
+	const Options& options;
+	IAllocator& allocator;
+	UniquePtr<Engine> engine;
+	os::WindowHandle window = os::INVALID_WINDOW;
+	World* world = nullptr;
+	lua_State* L = nullptr;
+	int patterns = -1;
+	Array<Result> results;
+};
+
+} // anonymous namespace
+
+static int benchmarkMain(int argc, char* argv[], IAllocator& allocator) {
+	Options options;
+	if (!parseOptions(argc, argv, options)) return 1;
+
+	int exit_code = 1;
+	Benchmark benchmark(options, allocator);
+	if (benchmark.init()) {
+		benchmark.run();
+		if (benchmark.writeResults()) exit_code = 0;
+	}
+	benchmark.shutdown();
+	return exit_code;
+}
+
+int main(int argc, char* argv[]) {
+	return bench::run(argc, argv, benchmarkMain);
+}
@@ -0,0 +1,250 @@
+// physics scene query throughput benchmark, compares PhysicsModule batched queries (executed on job workers)
+// with the same queries issued one by one from a single thread, on a generated grid of static boxes
+// usage: physics_benchmark [-actors <count>] [-queries <count>] [-repetitions <count>] [-output <path.json>]
+// exit code is 1 if batched and single queries do not hit the same entities
+
+#include "benchmarks/benchmark.h"
+#include "core/array.h"
+#include "core/job_system.h"
+#include "core/log.h"
+#include "core/math.h"
+#include "core/os.h"
+#include "core/stream.h"
+#include "core/string.h"
+#include "engine/component_types.h"
+#include "engine/engine.h"
+#include "engine/file_system.h"
+#include "engine/world.h"
+#include "physics/physics_module.h"
+
+using namespace Lumix;
+
+namespace {
+
+struct Options {
+	const char* output = "physics_benchmark.json";
+	u32 actors = 10'000;
+	u32 queries = 10'000;
+	u32 repetitions = 20;
+};
+
+struct Result {
+	const char* name;
+	float single_ns = 0; // per query
+	float batched_ns = 0; // per query
+	u32 hits = 0;
+	bool matches = true;
+};
+
+static bool parseOptions(int argc, char* argv[], Options& options) {
+	const bench::Option table[] = {
+		{ "-output", options.output },
+		{ "-actors", options.actors },
+		{ "-queries", options.queries },
+		{ "-repetitions", options.repetitions },
+	};
+	if (!bench::parseOptions(argc, argv, table)) return false;
+	if (options.actors == 0 || options.queries == 0 || options.repetitions == 0) {
+		logError("-actors, -queries and -repetitions must be greater than 0");
+		return false;
+	}
+	return true;
+}
+
+struct Benchmark {
+	Benchmark(const Options& options, IAllocator& allocator)
+		: options(options)
+		, allocator(allocator)
+		, results(allocator)
+	{}
+
+	bool init() {
+		Engine::InitArgs init_args;
+		init_args.log_path = "engine/physics_benchmark.log";
+		engine = Engine::create(static_cast<Engine::InitArgs&&>(init_args), allocator);
+
+		// some systems (renderer) can not be initialized without a window, the window is never shown
+		os::InitWindowArgs window_args;
+		window_args.name = "Physics benchmark";
+		window = os::createWindow(window_args);
+		engine->setMainWindow(window);
+		engine->init();
+
+		world = &engine->createWorld();
+		module = (PhysicsModule*)world->getModule(types::rigid_actor);
+		if (!module) {
+			logError("Physics plugin is not available");
+			return false;
+		}
+
+		// static unit boxes in a grid with random heights, 1m gaps between them
+		const u32 side = (u32)ceilf(sqrtf((float)options.actors));
+		grid_size = side * 2.f;
+		for (u32 i = 0; i < options.actors; ++i) {
+			const DVec3 pos(double(i % side) * 2, randFloat(0, 4), double(i / side) * 2);
+			const EntityRef e = world->createEntity(pos, Quat::IDENTITY);
+			world->createComponent(types::rigid_actor, e);
+			module->addBox(e, 0);
+			module->setBoxHalfExtents(e, 0, Vec3(0.5f));
+		}
+
+		engine->startGame(*world);
+		engine->update(*world);
+		return true;
+	}
+
+	DVec3 randomPoint(float y) const { return DVec3(randFloat(0, grid_size), y, randFloat(0, grid_size)); }
+	Vec3 randomDir() const { return normalize(Vec3(randFloat(-1, 1), randFloat(-1, -0.1f), randFloat(-1, 1))); }
+
+	// fastest repetition of all queries issued one by one and as one batch
+	template <typename Single, typename Batched>
+	void measure(Result& result, Single&& single, Batched&& batched) {
+		double single_best = 1e30;
+		double batched_best = 1e30;
+		const double to_ns = 1e9 / os::Timer::getFrequency();
+		for (u32 r = 0; r < options.repetitions; ++r) {
+			u64 start = os::Timer::getRawTimestamp();
+			single();
+			single_best = minimum(single_best, (os::Timer::getRawTimestamp() - start) * to_ns);
+
+			start = os::Timer::getRawTimestamp();
+			result.hits = batched();
+			batched_best = minimum(batched_best, (os::Timer::getRawTimestamp() - start) * to_ns);
+		}
+		result.single_ns = float(single_best / options.queries);
+		result.batched_ns = float(batched_best / options.queries);
+		logInfo(result.name, ": single ", result.single_ns, " ns, batched ", result.batched_ns, " ns per query, "
+			, result.hits, " hits of ", options.queries, result.matches ? "" : ", RESULTS DO NOT MATCH");
+	}
+
+	void run() {
+		Array<PhysicsModule::RaycastQuery> rays(allocator);
+		Array<PhysicsModule::SweepSphereQuery> sweeps(allocator);
+		Array<PhysicsModule::OverlapSphereQuery> overlaps(allocator);
+		for (u32 i = 0; i < options.queries; ++i) {
+			const DVec3 from = randomPoint(10);
+			rays.push({Vec3(from), randomDir(), 50});
+			sweeps.push({from, 0.25f, randomDir(), 50});
+			overlaps.push({randomPoint(randFloat(0, 5)), 0.5f});
+		}
+
+		{
+			Result& result = results.emplace();
+			result.name = "raycast";
+			Array<RaycastHit> single_hits(allocator);
+			Array<RaycastHit> batched_hits(allocator);
+			single_hits.resize(rays.size());
+			batched_hits.resize(rays.size());
+			measure(result, [&](){
+				for (i32 i = 0; i < rays.size(); ++i) {
+					const PhysicsModule::RaycastQuery& q = rays[i];
+					if (!module->raycastEx(q.origin, q.dir, q.distance, single_hits[i], q.ignored, q.layer)) single_hits[i].entity = INVALID_ENTITY;
+				}
+			}, [&](){ return module->raycastBatch(rays, batched_hits); });
+			for (i32 i = 0; i < rays.size(); ++i) {
+				if (single_hits[i].entity != batched_hits[i].entity) result.matches = false;
+			}
+		}
+
+		{
+			Result& result = results.emplace();
+			result.name = "sweep_sphere";
+			Array<SweepHit> single_hits(allocator);
+			Array<SweepHit> batched_hits(allocator);
+			single_hits.resize(sweeps.size());
+			batched_hits.resize(sweeps.size());
+			measure(result, [&](){
+				for (i32 i = 0; i < sweeps.size(); ++i) {
+					const PhysicsModule::SweepSphereQuery& q = sweeps[i];
+					if (!module->sweepSphere(q.pos, q.radius, q.dir, q.distance, single_hits[i], q.ignored, q.layer)) single_hits[i].entity = INVALID_ENTITY;
+				}
+			}, [&](){ return module->sweepSphereBatch(sweeps, batched_hits); });
+			for (i32 i = 0; i < sweeps.size(); ++i) {
+				if (single_hits[i].entity != batched_hits[i].entity) result.matches = false;
+			}
+		}
+
+		{
+			// there's no single overlap query, compare with batches of one query
+			Result& result = results.emplace();
+			result.name = "overlap_sphere";
+			Array<EntityPtr> single_hits(allocator);
+			Array<EntityPtr> batched_hits(allocator);
+			single_hits.resize(overlaps.size());
+			batched_hits.resize(overlaps.size());
+			measure(result, [&](){
+				for (i32 i = 0; i < overlaps.size(); ++i) {
+					module->overlapSphereBatch(Span(&overlaps[i], 1), Span(&single_hits[i], 1));
+				}
+			}, [&](){ return module->overlapSphereBatch(overlaps, batched_hits); });
+			for (i32 i = 0; i < overlaps.size(); ++i) {
+				// any hit is reported, so only compare whether there was one
+				if (single_hits[i].isValid() != batched_hits[i].isValid()) result.matches = false;
+			}
+		}
+	}
+
+	bool writeResults() {
+		OutputMemoryStream out(allocator);
+		out << "{\n";
+		out << "\t\"actors\": " << options.actors << ",\n";
+		out << "\t\"queries\": " << options.queries << ",\n";
+		out << "\t\"workers\": " << jobs::getWorkersCount() << ",\n";
+		out << "\t\"results\": [\n";
+		for (const Result& result : results) {
+			out << "\t\t{ \"query\": "; writeJSONString(out, result.name);
+			out << ", \"single_ns\": " << result.single_ns;
+			out << ", \"batched_ns\": " << result.batched_ns;
+			out << ", \"hits\": " << result.hits;
+			out << ", \"matches\": " << (result.matches ? "true" : "false");
+			out << (&result == &results.last() ? " }\n" : " },\n");
+		}
+		out << "\t]\n}\n";
+		return bench::writeResults(options.output, out);
+	}
+
+	bool allMatch() const {
+		for (const Result& result : results) {
+			if (!result.matches) return false;
+		}
+		return true;
+	}
+
+	void shutdown() {
+		if (world) {
+			engine->stopGame(*world);
+			engine->destroyWorld(*world);
+		}
+		engine.reset();
+		if (window != os::INVALID_WINDOW) os::destroyWindow(window);
+	}
+
+	const Options& options;
+	IAllocator& allocator;
+	UniquePtr<Engine> engine;
+	os::WindowHandle window = os::INVALID_WINDOW;
+	World* world = nullptr;
+	PhysicsModule* module = nullptr;
+	float grid_size = 0;
+	Array<Result> results;
+};
+
+} // anonymous namespace
+
+static int benchmarkMain(int argc, char* argv[], IAllocator& allocator) {
+	Options options;
+	if (!parseOptions(argc, argv, options)) return 1;
+
+	int exit_code = 1;
+	Benchmark benchmark(options, allocator);
+	if (benchmark.init()) {
+		benchmark.run();
+		if (benchmark.writeResults() && benchmark.allMatch()) exit_code = 0;
+	}
+	benchmark.shutdown();
+	return exit_code;
+}
+
+int main(int argc, char* argv[]) {
+	return bench::run(argc, argv, benchmarkMain);
+}
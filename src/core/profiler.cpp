@@ -9,13 +9,25 @@
 #include "core/crt.h"
 #include "core/debug.h"
 #include "core/hash_map.h"
+#include "core/log.h"
 #include "core/math.h"
 #include "core/string.h"
 #include "core/sync.h"
 #include "core/tag_allocator.h"
 #include "core/thread.h"
 #include "core/os.h"
+#include "core/stream.h"
 #include "profiler.h"
+#include <lz4/lz4.h>
+#ifdef __linux__
+	#include <cxxabi.h>
+	#include <dlfcn.h>
+	#include <errno.h>
+	#include <execinfo.h>
+	#include <signal.h>
+	#include <stdlib.h>
+	#include <sys/time.h>
+#endif
 
 namespace Lumix {
 
@@ -55,11 +67,8 @@ struct ThreadContext {
 	}
 
 	~ThreadContext() {
-		Page* page = first_page;
-		while (page) {
-			Page* next = page->header.next;
-			LUMIX_DELETE(allocator, page);
-			page = next;
+		for (Page* page : pages) {
+			if (page) LUMIX_DELETE(allocator, page);
 		}
 	}
 
@@ -70,32 +79,67 @@ struct ThreadContext {
 
 	struct Page {
 		struct Header {
-			Page* next = nullptr;
 			u32 size = 0;
 		};
 		Header header;
 		u8 buffer[4096 - sizeof(Header)];
 	};
 
+	// number of pages in the ring buffer, once all of them are used, the oldest page is overwritten
+	static constexpr u32 MAX_PAGES = 500;
+
+	u64 getOldestPage() const { return pages_written > MAX_PAGES ? pages_written - MAX_PAGES : 0; }
+
+	// call only while holding the mutex
+	Page& pushPage() {
+		Page*& page = pages[pages_written % MAX_PAGES];
+		if (!page) page = LUMIX_NEW(allocator, Page)();
+		page->header.size = 0;
+		++pages_written;
+		return *page;
+	}
+
+	// call only while holding the mutex
+	template <typename F>
+	void forEachPage(const F& f) const {
+		for (u64 i = getOldestPage(); i < pages_written; ++i) {
+			f(*pages[i % MAX_PAGES]);
+		}
+	}
+
 	IAllocator& allocator;
 	OpenBlock open_block_stack[16] = {};
 	u32 open_block_stack_size = 0;
 	
-	// we write to `tmp` until it's full, then we flush it to the `buffer`
+	// we write to `tmp` until it's full, then we flush it to the `pages`
 	// tmp is only accessed by the thread that owns the context
 	u8 tmp[sizeof(Page::buffer)];
 	u32 tmp_pos = 0;
 	
 	// ring buffer, access only while holding the mutex
-	// the ring buffer can be read by profiler UI
+	// the ring buffer can be read by profiler UI and by the stream writer
+	// pages are allocated lazily, so memory is bounded by MAX_PAGES per thread
 	Mutex mutex;
-	Page* first_page = nullptr;
-	Page* last_page = nullptr;
-	u32 num_pages = 0;
+	Page* pages[MAX_PAGES] = {};
+	u64 pages_written = 0;
+	u64 pages_streamed = 0;
 
 	StaticString<64> thread_name;
 	bool show_in_profiler = false;
-	u32 thread_id;
+	u32 thread_id = 0;
+
+	struct Sample {
+		u64 time;
+		u32 depth;
+		u64 frames[MAX_SAMPLE_DEPTH];
+	};
+
+	// samples are written by the signal handler interrupting the owning thread, it can not lock the mutex,
+	// so they go to this single producer ring buffer, which is moved to `pages` while holding the mutex
+	static constexpr u32 MAX_SAMPLES = 64;
+	Sample samples[MAX_SAMPLES];
+	volatile u32 samples_head = 0;
+	volatile u32 samples_tail = 0;
 };
 
 #ifdef _WIN32
@@ -145,6 +189,15 @@ struct ThreadContext {
 	void CloseTrace(int) {}
 #endif
 
+// context of the current thread, valid only if `t_context_generation` matches `g_generation`,
+// otherwise the profiler was reinitialized and the context does not exist anymore
+// these do not need dynamic initialization, so they are safe to use in the sampling signal handler
+static thread_local ThreadContext* t_context = nullptr;
+static thread_local u32 t_context_generation = 0;
+static volatile u32 g_generation = 0;
+
+struct StreamTask;
+
 struct Instance {
 	Instance(IAllocator& allocator)
 		: tag_allocator(allocator, "profiler")
@@ -155,12 +208,16 @@ struct Instance {
 		, gpu_scopes(tag_allocator)
 		, gpu_scope_stack(tag_allocator)
 	{
+		global_context.thread_id = 0;
+		g_generation = g_generation + 1;
 		startTrace();
 	}
 
 
 	~Instance()
 	{
+		stopSampling();
+		stopStreaming();
 		CloseTrace(trace_task.open_handle);
 		trace_task.destroy();
 		for (ThreadContext* ctx : contexts) {
@@ -208,15 +265,15 @@ struct Instance {
 
 	LUMIX_FORCE_INLINE ThreadContext* getThreadContext()
 	{
-		thread_local ThreadContext* ctx = [&](){
-			ThreadContext* new_ctx = LUMIX_NEW(tag_allocator, ThreadContext)(tag_allocator);
-			new_ctx->thread_id = os::getCurrentThreadID();
-			MutexGuard lock(mutex);
-			contexts.push(new_ctx);
-			return new_ctx;
-		}();
-
-		return ctx;
+		if (t_context_generation == g_generation) return t_context;
+
+		ThreadContext* new_ctx = LUMIX_NEW(tag_allocator, ThreadContext)(tag_allocator);
+		new_ctx->thread_id = os::getCurrentThreadID();
+		MutexGuard lock(mutex);
+		contexts.push(new_ctx);
+		t_context = new_ctx;
+		t_context_generation = g_generation;
+		return new_ctx;
 	}
 
 	TagAllocator tag_allocator;
@@ -232,36 +289,53 @@ struct Instance {
 	AtomicI32 fiber_wait_id = 0;
 	TraceTask trace_task;
 	ThreadContext global_context;
+	StreamTask* stream_task = nullptr;
+	bool is_sampling = false;
 };
 
 Local<Instance> g_instance;
 
-// move data from temporary buffer to the main buffer
+// move samples from the signal handler's ring buffer to the page ring buffer, call only while holding the mutex
+static void flushSamples(ThreadContext& ctx) {
+	const u32 head = ctx.samples_head;
+	readBarrier();
+	u32 tail = ctx.samples_tail;
+	if (tail == head) return;
+
+	ThreadContext::Page* page = nullptr;
+	for (; tail != head; ++tail) {
+		const ThreadContext::Sample& sample = ctx.samples[tail % ThreadContext::MAX_SAMPLES];
+		const u32 frames_size = sample.depth * sizeof(sample.frames[0]);
+		const u32 size = sizeof(EventHeader) + sizeof(SampleRecord) + frames_size;
+		if (!page || page->header.size + size > sizeof(page->buffer)) page = &ctx.pushPage();
+
+		EventHeader header;
+		header.type = EventType::SAMPLE;
+		header.size = size;
+		header.time = sample.time;
+		const SampleRecord rec = { sample.depth };
+		u8* ptr = page->buffer + page->header.size;
+		memcpy(ptr, &header, sizeof(header));
+		memcpy(ptr + sizeof(header), &rec, sizeof(rec));
+		memcpy(ptr + sizeof(header) + sizeof(rec), sample.frames, frames_size);
+		page->header.size += size;
+	}
+	memoryBarrier();
+	ctx.samples_tail = tail;
+}
+
+// move data from temporary buffer to the ring buffer
 template <bool lock>
 static void flush(ThreadContext& ctx) {
 	if constexpr (lock) ctx.mutex.enter();
 
-	if (ctx.num_pages < 500) {
-		auto* new_page = LUMIX_NEW(ctx.allocator, ThreadContext::Page)();
-		memcpy(new_page->buffer, ctx.tmp, ctx.tmp_pos);
-		new_page->header.size = ctx.tmp_pos;
-		if (!ctx.first_page) ctx.first_page = new_page;
-		if (ctx.last_page) ctx.last_page->header.next = new_page;
-		ctx.last_page = new_page;
-		++ctx.num_pages;
-	}
-	else {
-		ThreadContext::Page* new_page = ctx.first_page;
-		ctx.first_page = new_page->header.next;
-		new_page->header.next = nullptr;
-
-		memcpy(new_page->buffer, ctx.tmp, ctx.tmp_pos);
-		new_page->header.size = ctx.tmp_pos;
-
-		ctx.last_page->header.next = new_page;
-		ctx.last_page = new_page;
+	if (ctx.tmp_pos > 0) {
+		ThreadContext::Page& page = ctx.pushPage();
+		memcpy(page.buffer, ctx.tmp, ctx.tmp_pos);
+		page.header.size = ctx.tmp_pos;
+		ctx.tmp_pos = 0;
 	}
-	ctx.tmp_pos = 0;
+	flushSamples(ctx);
 
 	if constexpr (lock) ctx.mutex.exit();
 }
@@ -304,6 +378,211 @@ LUMIX_FORCE_INLINE static void write(ThreadContext& ctx, u64 timestamp, EventTyp
 	if constexpr (lock) ctx.mutex.exit();
 };
 
+// calls `f` for every string pointer (block names, int keys) and every sampled code address stored in `page`
+// both are keys in the string table, addresses are replaced by their symbol names
+template <typename F>
+static void forEachString(const ThreadContext::Page& page, const F& f) {
+	u32 iter = 0;
+	while (iter < page.header.size) {
+		profiler::EventHeader header;
+		memcpy(&header, &page.buffer[iter], sizeof(header));
+		
+		switch (header.type) {
+			case profiler::EventType::BEGIN_BLOCK: {
+				BlockRecord b;
+				memcpy(&b, &page.buffer[iter + sizeof(profiler::EventHeader)], sizeof(b));
+				f(b.name, false);
+				break;
+			}
+			case profiler::EventType::INT: {
+				IntRecord r;
+				memcpy(&r, &page.buffer[iter + sizeof(profiler::EventHeader)], sizeof(r));
+				f(r.key, false);
+				break;
+			}
+			case profiler::EventType::SAMPLE: {
+				SampleRecord r;
+				const u32 offset = iter + sizeof(profiler::EventHeader);
+				memcpy(&r, &page.buffer[offset], sizeof(r));
+				for (u32 i = 0; i < r.depth; ++i) {
+					u64 address;
+					memcpy(&address, &page.buffer[offset + sizeof(r) + i * sizeof(address)], sizeof(address));
+					f((const char*)(uintptr)address, true);
+				}
+				break;
+			}
+			default: break;
+		}
+		iter += header.size;
+	}
+}
+
+// name of the function containing `address`, falls back to module+offset or the raw address
+static void getSymbolName(const void* address, Span<char> out) {
+	#ifdef __linux__
+		Dl_info info;
+		if (dladdr(address, &info)) {
+			if (info.dli_sname) {
+				int status;
+				char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+				copyString(out, status == 0 && demangled ? demangled : info.dli_sname);
+				free(demangled);
+				return;
+			}
+			if (info.dli_fname) {
+				const char* module = info.dli_fname;
+				for (const char* c = module; *c; ++c) {
+					if (*c == '/') module = c + 1;
+				}
+				char offset[24];
+				toCString(u64((const u8*)address - (const u8*)info.dli_fbase), Span(offset));
+				copyString(out, module);
+				catString(out, "+");
+				catString(out, offset);
+				return;
+			}
+		}
+	#endif
+	toCString(u64((uintptr)address), out);
+}
+
+// background thread, which periodically moves finished pages from thread contexts to a file
+// pages are lz4-compressed, strings and counters are written the first time they are seen
+// if the writer falls behind by more than ThreadContext::MAX_PAGES, the oldest pages are dropped
+struct StreamTask final : Thread {
+	static constexpr u32 PERIOD_MS = 100;
+
+	StreamTask(IAllocator& allocator)
+		: Thread(allocator)
+		, allocator(allocator)
+		, strings(allocator)
+		, contexts(allocator)
+		, chunk(allocator)
+		, compressed(allocator)
+	{}
+
+	int task() override {
+		while (!finished) {
+			os::sleep(PERIOD_MS);
+			streamPages();
+		}
+		return 0;
+	}
+
+	void writeChunk() {
+		if (!file.write(chunk.data(), chunk.size())) is_error = true;
+		chunk.clear();
+	}
+
+	void streamCounters() {
+		MutexGuard lock(g_instance->mutex);
+		// counter's last value changes all the time, so we write the table only when a counter is added
+		if ((u32)g_instance->counters.size() == counters_count) return;
+		
+		counters_count = g_instance->counters.size();
+		chunk.write(StreamChunk::COUNTERS);
+		chunk.write(counters_count);
+		chunk.write(g_instance->counters.begin(), g_instance->counters.byte_size());
+		writeChunk();
+	}
+
+	void streamPage(const ThreadContext::Page& page, u32 thread_id, StreamThreadFlags flags, const char* thread_name) {
+		u32 new_strings = 0;
+		forEachString(page, [&](const char* str, bool is_address){
+			if (strings.find(str).isValid()) return;
+			if (new_strings == 0) {
+				chunk.write(StreamChunk::STRINGS);
+				chunk.write(u32(0)); // patched below
+			}
+			strings.insert(str, true);
+			chunk.write((u64)(uintptr)str);
+			if (is_address) {
+				char name[256];
+				getSymbolName(str, Span(name));
+				chunk.write(name, strlen(name) + 1);
+			}
+			else {
+				chunk.write(str, strlen(str) + 1);
+			}
+			++new_strings;
+		});
+		if (new_strings > 0) {
+			memcpy(chunk.getMutableData() + sizeof(StreamChunk), &new_strings, sizeof(new_strings));
+			writeChunk();
+		}
+
+		const i32 cap = LZ4_compressBound(page.header.size);
+		compressed.resize(cap);
+		const i32 compressed_size = LZ4_compress_default((const char*)page.buffer, (char*)compressed.getMutableData(), page.header.size, cap);
+		if (compressed_size <= 0) {
+			is_error = true;
+			return;
+		}
+
+		chunk.write(StreamChunk::EVENTS);
+		chunk.write(thread_id);
+		chunk.write(flags);
+		chunk.writeString(thread_name);
+		chunk.write(page.header.size);
+		chunk.write((u32)compressed_size);
+		chunk.write(compressed.data(), compressed_size);
+		writeChunk();
+	}
+
+	void streamContext(ThreadContext& ctx, bool is_global) {
+		ThreadContext::Page page;
+		for (;;) {
+			StaticString<64> thread_name;
+			u32 thread_id;
+			StreamThreadFlags flags = is_global ? StreamThreadFlags::GLOBAL : StreamThreadFlags::NONE;
+			{
+				MutexGuard lock(ctx.mutex);
+				flushSamples(ctx);
+				if (ctx.pages_streamed == ctx.pages_written) return;
+
+				const u64 oldest = ctx.getOldestPage();
+				if (ctx.pages_streamed < oldest) {
+					dropped_pages += oldest - ctx.pages_streamed;
+					ctx.pages_streamed = oldest;
+				}
+				memcpy(&page, ctx.pages[ctx.pages_streamed % ThreadContext::MAX_PAGES], sizeof(page));
+				++ctx.pages_streamed;
+				thread_name = ctx.thread_name;
+				thread_id = ctx.thread_id;
+				if (ctx.show_in_profiler) flags |= StreamThreadFlags::SHOW;
+			}
+			streamPage(page, thread_id, flags, thread_name);
+		}
+	}
+
+	void streamPages() {
+		streamCounters();
+
+		{
+			MutexGuard lock(g_instance->mutex);
+			contexts.clear();
+			for (ThreadContext* ctx : g_instance->contexts) contexts.push(ctx);
+		}
+
+		streamContext(g_instance->global_context, true);
+		for (ThreadContext* ctx : contexts) {
+			streamContext(*ctx, false);
+		}
+		file.flush();
+	}
+
+	IAllocator& allocator;
+	os::OutputFile file;
+	HashMap<const char*, bool> strings;
+	Array<ThreadContext*> contexts;
+	OutputMemoryStream chunk;
+	OutputMemoryStream compressed;
+	u32 counters_count = 0;
+	u64 dropped_pages = 0;
+	bool is_error = false;
+	volatile bool finished = false;
+};
+
 #ifdef _WIN32
 	TraceTask::TraceTask(IAllocator& allocator)
 		: Thread(allocator)
@@ -596,6 +875,15 @@ void frame()
 	}
 	g_instance->last_frame_time = n;
 	write<true>(g_instance->global_context, os::Timer::getRawTimestamp(), EventType::FRAME, 0);
+
+	// threads busy in code without profiler blocks do not flush, so their sample buffers would overflow
+	if (g_instance->is_sampling) {
+		MutexGuard lock(g_instance->mutex);
+		for (ThreadContext* ctx : g_instance->contexts) {
+			MutexGuard ctx_lock(ctx->mutex);
+			flushSamples(*ctx);
+		}
+	}
 }
 
 
@@ -630,39 +918,16 @@ void setThreadName(const char* name)
 }
 
 static void saveStrings(OutputMemoryStream& blob) {
-	HashMap<const char*, const char*> map(getGlobalAllocator());
+	HashMap<const char*, bool> map(getGlobalAllocator());
 	map.reserve(512);
 	auto gather = [&](const ThreadContext& ctx){
-		const ThreadContext::Page* page = ctx.first_page;
-		while (page) {
-			u32 iter = 0;
-			while (iter < page->header.size) {
-				profiler::EventHeader header;
-				memcpy(&header, &page->buffer[iter], sizeof(header));
-				
-				switch (header.type) {
-					case profiler::EventType::BEGIN_BLOCK: {
-						BlockRecord b;
-						memcpy(&b, &page->buffer[iter + sizeof(profiler::EventHeader)], sizeof(b));
-						if (!map.find(b.name).isValid()) {
-							map.insert(b.name, b.name);
-						}
-						break;
-					}
-					case profiler::EventType::INT: {
-						IntRecord r;
-						memcpy(&r, &page->buffer[iter + sizeof(profiler::EventHeader)], sizeof(r));
-						if (!map.find(r.key).isValid()) {
-							map.insert(r.key, r.key);
-						}
-						break;
-					}
-					default: break;
+		ctx.forEachPage([&](const ThreadContext::Page& page){
+			forEachString(page, [&](const char* str, bool is_address){
+				if (!map.find(str).isValid()) {
+					map.insert(str, is_address);
 				}
-				iter += header.size;
-			}
-			page = page->header.next;
-		}
+			});
+		});
 	};
 
 	gather(g_instance->global_context);
@@ -671,9 +936,17 @@ static void saveStrings(OutputMemoryStream& blob) {
 	}
 
 	blob.write(map.size());
-	for (const char* iter : map) {
-		blob.write((u64)(uintptr)iter);
-		blob.write(iter, strlen(iter) + 1);
+	for (auto iter = map.begin(), end = map.end(); iter != end; ++iter) {
+		const char* str = iter.key();
+		blob.write((u64)(uintptr)str);
+		if (iter.value()) {
+			char name[256];
+			getSymbolName(str, Span(name));
+			blob.write(name, strlen(name) + 1);
+		}
+		else {
+			blob.write(str, strlen(str) + 1);
+		}
 	}
 }
 
@@ -684,26 +957,22 @@ void serialize(OutputMemoryStream& blob, ThreadContext& ctx) {
 	blob.write(ctx.thread_id);
 	blob.write((u8)ctx.show_in_profiler);
 	u32 size = 0;
-	const ThreadContext::Page* page = ctx.first_page;
-	while (page) {
-		size += page->header.size;
-		page = page->header.next;
-	}
+	ctx.forEachPage([&](const ThreadContext::Page& page){
+		size += page.header.size;
+	});
 
 	blob.write(size);
 
-	page = ctx.first_page;
-	while (page) {
-		blob.write(page->buffer, page->header.size);
-		page = page->header.next;
-	}
+	ctx.forEachPage([&](const ThreadContext::Page& page){
+		blob.write(page.buffer, page.header.size);
+	});
 }
 
 void serialize(OutputMemoryStream& blob) {
 	MutexGuard lock(g_instance->mutex);
 	
-	const u32 version = 0;
-	blob.write(version);
+	blob.write((u32)SERIALIZE_VERSION);
+	blob.write(frequency());
 	blob.write((u32)g_instance->counters.size());
 	blob.write(g_instance->counters.begin(), g_instance->counters.byte_size());
 
@@ -715,6 +984,524 @@ void serialize(OutputMemoryStream& blob) {
 	saveStrings(blob);
 }
 
+bool startStreaming(const char* path) {
+	if (g_instance->stream_task) return false;
+
+	StreamTask* task = LUMIX_NEW(g_instance->tag_allocator, StreamTask)(g_instance->tag_allocator);
+	if (!task->file.open(path)) {
+		logError("Could not open ", path);
+		LUMIX_DELETE(g_instance->tag_allocator, task);
+		return false;
+	}
+
+	StreamHeader header;
+	header.frequency = frequency();
+	if (!task->file.write(header)) {
+		logError("Could not write ", path);
+		task->file.close();
+		LUMIX_DELETE(g_instance->tag_allocator, task);
+		return false;
+	}
+	
+	if (!task->create("profiler stream", true)) {
+		logError("Could not create profiler stream thread");
+		task->file.close();
+		LUMIX_DELETE(g_instance->tag_allocator, task);
+		return false;
+	}
+	g_instance->stream_task = task;
+	return true;
+}
+
+void stopStreaming() {
+	StreamTask* task = g_instance->stream_task;
+	if (!task) return;
+
+	task->finished = true;
+	task->destroy();
+
+	// write what's left in temporary buffers
+	{
+		MutexGuard lock(g_instance->mutex);
+		for (ThreadContext* ctx : g_instance->contexts) {
+			MutexGuard ctx_lock(ctx->mutex);
+			flush<false>(*ctx);
+		}
+	}
+	flush<true>(g_instance->global_context);
+	task->streamPages();
+	
+	if (task->dropped_pages > 0) {
+		logWarning("Profiler stream could not keep up, ", task->dropped_pages, " pages were dropped");
+	}
+	if (task->is_error) logError("Failed to write profiler stream");
+	task->file.close();
+	LUMIX_DELETE(g_instance->tag_allocator, task);
+	g_instance->stream_task = nullptr;
+}
+
+bool isStreaming() {
+	return g_instance->stream_task;
+}
+
+#ifdef __linux__
+	static void sampleSignalHandler(int) {
+		if (t_context_generation != g_generation) return;
+		ThreadContext* ctx = t_context;
+
+		const u32 head = ctx->samples_head;
+		if (head - ctx->samples_tail >= ThreadContext::MAX_SAMPLES) return;
+
+		// skip this handler and the signal trampoline
+		constexpr u32 SKIPPED_FRAMES = 2;
+		const int saved_errno = errno;
+		void* frames[MAX_SAMPLE_DEPTH + SKIPPED_FRAMES];
+		const int count = backtrace(frames, lengthOf(frames));
+		errno = saved_errno;
+		if (count <= (int)SKIPPED_FRAMES) return;
+
+		ThreadContext::Sample& sample = ctx->samples[head % ThreadContext::MAX_SAMPLES];
+		sample.time = os::Timer::getRawTimestamp();
+		sample.depth = count - SKIPPED_FRAMES;
+		for (u32 i = 0; i < sample.depth; ++i) {
+			sample.frames[i] = (u64)(uintptr)frames[i + SKIPPED_FRAMES];
+		}
+		memoryBarrier();
+		ctx->samples_head = head + 1;
+	}
+
+	bool startSampling(u32 frequency_hz) {
+		if (g_instance->is_sampling || frequency_hz == 0) return false;
+
+		// first call of backtrace loads libgcc, which is not safe to do in the signal handler
+		void* dummy[1];
+		backtrace(dummy, 1);
+
+		struct sigaction action = {};
+		action.sa_handler = sampleSignalHandler;
+		action.sa_flags = SA_RESTART;
+		sigemptyset(&action.sa_mask);
+		if (sigaction(SIGPROF, &action, nullptr) != 0) {
+			logError("Failed to install SIGPROF handler");
+			return false;
+		}
+
+		const u32 period_us = maximum(1000000 / frequency_hz, 1u);
+		itimerval timer = {};
+		timer.it_interval.tv_sec = period_us / 1000000;
+		timer.it_interval.tv_usec = period_us % 1000000;
+		timer.it_value = timer.it_interval;
+		if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+			logError("Failed to start profiling timer");
+			signal(SIGPROF, SIG_IGN);
+			return false;
+		}
+		g_instance->is_sampling = true;
+		return true;
+	}
+
+	void stopSampling() {
+		if (!g_instance->is_sampling) return;
+
+		itimerval timer = {};
+		setitimer(ITIMER_PROF, &timer, nullptr);
+		// default action of SIGPROF terminates the process, so ignore the ones still pending
+		signal(SIGPROF, SIG_IGN);
+		g_instance->is_sampling = false;
+	}
+#else
+	bool startSampling(u32 frequency_hz) { return false; }
+	void stopSampling() {}
+#endif
+
+bool isSampling() {
+	return g_instance->is_sampling;
+}
+
+bool streamToBlob(InputMemoryStream& stream, OutputMemoryStream& blob, IAllocator& allocator) {
+	struct StreamedThread {
+		StreamedThread(IAllocator& allocator) : events(allocator) {}
+		StaticString<64> name;
+		u32 thread_id;
+		StreamThreadFlags flags;
+		OutputMemoryStream events;
+	};
+
+	StreamHeader header;
+	stream.read(header);
+	if (header.magic != StreamHeader::MAGIC || header.version != 0) return false;
+
+	Array<StreamedThread> threads(allocator);
+	HashMap<u32, u32> thread_map(allocator);
+	OutputMemoryStream counters(allocator);
+	OutputMemoryStream strings(allocator);
+	OutputMemoryStream decompressed(allocator);
+	u32 counters_count = 0;
+	u32 strings_count = 0;
+	i32 global_idx = -1;
+
+	// stream can be cut in the middle of a chunk (e.g. the app crashed), in such case we keep everything before the chunk
+	bool truncated = false;
+	while (!truncated && stream.remaining() > 0) {
+		const StreamChunk type = stream.read<StreamChunk>();
+		switch (type) {
+			case StreamChunk::COUNTERS: {
+				// keep the previous table if this one is truncated
+				const u32 count = stream.read<u32>();
+				if (stream.hasOverflow() || stream.remaining() < count * sizeof(Counter)) {
+					truncated = true;
+					break;
+				}
+				counters_count = count;
+				counters.clear();
+				counters.write(stream.skip(counters_count * sizeof(Counter)), counters_count * sizeof(Counter));
+				break;
+			}
+			case StreamChunk::STRINGS: {
+				const u32 count = stream.read<u32>();
+				for (u32 i = 0; i < count && !truncated; ++i) {
+					const u64 key = stream.read<u64>();
+					const char* str = stream.readString();
+					if (!str || stream.hasOverflow()) {
+						truncated = true;
+						break;
+					}
+					strings.write(key);
+					strings.write(str, strlen(str) + 1);
+					++strings_count;
+				}
+				break;
+			}
+			case StreamChunk::EVENTS: {
+				const u32 thread_id = stream.read<u32>();
+				const StreamThreadFlags flags = stream.read<StreamThreadFlags>();
+				const char* name = stream.readString();
+				const u32 raw_size = stream.read<u32>();
+				const u32 compressed_size = stream.read<u32>();
+				if (!name || stream.hasOverflow() || stream.remaining() < compressed_size) {
+					truncated = true;
+					break;
+				}
+				const void* data = stream.skip(compressed_size);
+
+				const bool is_global = isFlagSet(flags, StreamThreadFlags::GLOBAL);
+				auto iter = thread_map.find(thread_id);
+				u32 idx;
+				if (is_global && global_idx >= 0) {
+					idx = global_idx;
+				}
+				else if (!is_global && iter.isValid()) {
+					idx = iter.value();
+				}
+				else {
+					idx = threads.size();
+					threads.emplace(allocator);
+					if (is_global) global_idx = idx;
+					else thread_map.insert(thread_id, idx);
+				}
+				StreamedThread& thread = threads[idx];
+				thread.name = name;
+				thread.thread_id = thread_id;
+				thread.flags = flags;
+
+				decompressed.resize(raw_size);
+				const i32 res = LZ4_decompress_safe((const char*)data, (char*)decompressed.getMutableData(), compressed_size, raw_size);
+				if (res != (i32)raw_size) return false;
+				thread.events.write(decompressed.data(), raw_size);
+				break;
+			}
+			default: return false;
+		}
+	}
+
+	if (global_idx < 0) {
+		global_idx = threads.size();
+		StreamedThread& global = threads.emplace(allocator);
+		global.thread_id = 0;
+		global.flags = StreamThreadFlags::GLOBAL;
+	}
+
+	// same layout as `serialize`
+	blob.write((u32)SERIALIZE_VERSION);
+	blob.write(header.frequency);
+	blob.write(counters_count);
+	blob.write(counters.data(), counters.size());
+	blob.write(u32(threads.size() - 1));
+	auto write_thread = [&](const StreamedThread& thread){
+		blob.writeString(thread.name);
+		blob.write(thread.thread_id);
+		blob.write((u8)isFlagSet(thread.flags, StreamThreadFlags::SHOW));
+		blob.write((u32)thread.events.size());
+		blob.write(thread.events.data(), thread.events.size());
+	};
+	write_thread(threads[global_idx]);
+	for (i32 i = 0; i < threads.size(); ++i) {
+		if (i != global_idx) write_thread(threads[i]);
+	}
+	blob.write(strings_count);
+	blob.write(strings.data(), strings.size());
+	return true;
+}
+
+bool exportChromeTrace(InputMemoryStream& blob, IOutputStream& out, IAllocator& allocator) {
+	struct ThreadData {
+		const char* name;
+		u32 thread_id;
+		u32 size;
+		const u8* events;
+	};
+
+	const u32 version = blob.read<u32>();
+	if (version > SERIALIZE_VERSION) return false;
+	const u64 freq = version > 0 ? blob.read<u64>() : os::Timer::getFrequency();
+	const u32 counters_count = blob.read<u32>();
+	if (blob.remaining() < counters_count * sizeof(Counter)) return false;
+	const Counter* counters = (const Counter*)blob.skip(counters_count * sizeof(Counter));
+	const u32 threads_count = blob.read<u32>() + 1;
+	
+	Array<ThreadData> threads(allocator);
+	for (u32 i = 0; i < threads_count; ++i) {
+		ThreadData& t = threads.emplace();
+		t.name = blob.readString();
+		const u32 thread_id = blob.read<u32>();
+		// older versions do not initialize global context's thread_id
+		t.thread_id = i == 0 ? 0 : thread_id;
+		blob.read<u8>();
+		t.size = blob.read<u32>();
+		if (!t.name || blob.hasOverflow() || blob.remaining() < t.size) return false;
+		t.events = (const u8*)blob.skip(t.size);
+	}
+
+	// events reference strings by their original pointers, see `saveStrings`
+	HashMap<u64, const char*> strings(allocator);
+	const u32 strings_count = blob.read<u32>();
+	strings.reserve(strings_count);
+	for (u32 i = 0; i < strings_count; ++i) {
+		const u64 key = blob.read<u64>();
+		const char* str = blob.readString();
+		if (!str) return false;
+		strings.insert(key, str);
+	}
+	if (blob.hasOverflow()) return false;
+
+	auto get_string = [&](const char* key) -> const char* {
+		auto iter = strings.find((u64)(uintptr)key);
+		return iter.isValid() ? iter.value() : "N/A";
+	};
+
+	u64 base_time = 0xffFFffFFffFFffFF;
+	for (const ThreadData& t : threads) {
+		if (t.size >= sizeof(EventHeader)) {
+			EventHeader header;
+			memcpy(&header, t.events, sizeof(header));
+			base_time = minimum(base_time, header.time);
+		}
+	}
+
+	bool first_event = true;
+	auto begin_event = [&](const char* phase, u32 thread_id){
+		out << (first_event ? "\n" : ",\n") << "{\"pid\":0,\"tid\":" << thread_id << ",\"ph\":\"" << phase << "\"";
+		first_event = false;
+	};
+	auto write_time = [&](const char* key, u64 time){
+		char tmp[64];
+		toCString(double(i64(time - base_time)) * 1'000'000.0 / double(freq), Span(tmp), 3);
+		out << ",\"" << key << "\":" << tmp;
+	};
+	auto write_duration = [&](u64 from, u64 to){
+		char tmp[64];
+		toCString(double(to - from) * 1'000'000.0 / double(freq), Span(tmp), 3);
+		out << ",\"dur\":" << tmp;
+	};
+	
+	// gpu blocks are in the global context, we put them on their own track
+	const u32 gpu_thread_id = 0xffFFffFF;
+	HashMap<i32, const char*> block_names(allocator);
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	
+	begin_event("M", gpu_thread_id);
+	out << ",\"name\":\"thread_name\",\"args\":{\"name\":\"GPU\"}}";
+	for (const ThreadData& t : threads) {
+		begin_event("M", t.thread_id);
+		out << ",\"name\":\"thread_name\",\"args\":{\"name\":";
+		writeJSONString(out, t.thread_id == 0 ? "Global" : t.name);
+		out << "}}";
+	}
+
+	for (const ThreadData& t : threads) {
+		u32 depth = 0;
+		u32 gpu_depth = 0;
+		u64 last_time = base_time;
+		u32 p = 0;
+		while (p + sizeof(EventHeader) <= t.size) {
+			EventHeader header;
+			memcpy(&header, t.events + p, sizeof(header));
+			if (header.size < sizeof(EventHeader)) return false;
+			const u8* data = t.events + p + sizeof(EventHeader);
+			last_time = maximum(last_time, header.time);
+
+			switch (header.type) {
+				case EventType::BEGIN_BLOCK: {
+					BlockRecord r;
+					memcpy(&r, data, sizeof(r));
+					const char* name = get_string(r.name);
+					block_names.insert(r.id, name);
+					begin_event("B", t.thread_id);
+					write_time("ts", header.time);
+					out << ",\"name\":";
+					writeJSONString(out, name);
+					out << "}";
+					++depth;
+					break;
+				}
+				case EventType::BEGIN_JOB: {
+					JobRecord r;
+					memcpy(&r, data, sizeof(r));
+					block_names.insert(r.id, "job");
+					begin_event("B", t.thread_id);
+					write_time("ts", header.time);
+					out << ",\"name\":\"job\",\"args\":{\"signal_on_finish\":" << r.signal_on_finish << "}}";
+					++depth;
+					break;
+				}
+				case EventType::CONTINUE_BLOCK: {
+					i32 id;
+					memcpy(&id, data, sizeof(id));
+					auto iter = block_names.find(id);
+					begin_event("B", t.thread_id);
+					write_time("ts", header.time);
+					out << ",\"name\":";
+					writeJSONString(out, iter.isValid() ? iter.value() : "N/A");
+					out << "}";
+					++depth;
+					break;
+				}
+				case EventType::END_BLOCK:
+					// ring buffer could have overwritten the beginning of the block
+					if (depth == 0) break;
+					--depth;
+					begin_event("E", t.thread_id);
+					write_time("ts", header.time);
+					out << "}";
+					break;
+				case EventType::INT: {
+					IntRecord r;
+					memcpy(&r, data, sizeof(r));
+					begin_event("i", t.thread_id);
+					write_time("ts", header.time);
+					out << ",\"s\":\"t\",\"name\":";
+					writeJSONString(out, get_string(r.key));
+					out << ",\"args\":{\"value\":" << r.value << "}}";
+					break;
+				}
+				case EventType::STRING: {
+					begin_event("i", t.thread_id);
+					write_time("ts", header.time);
+					out << ",\"s\":\"t\",\"name\":";
+					writeJSONString(out, (const char*)data);
+					out << "}";
+					break;
+				}
+				case EventType::BEGIN_FIBER_WAIT:
+				case EventType::END_FIBER_WAIT: {
+					FiberWaitRecord r;
+					memcpy(&r, data, sizeof(r));
+					begin_event(header.type == EventType::BEGIN_FIBER_WAIT ? "b" : "e", t.thread_id);
+					write_time("ts", header.time);
+					out << ",\"cat\":\"fiber\",\"name\":\"fiber wait\",\"id\":" << r.id << ",\"args\":{\"signal\":" << r.job_system_signal << "}}";
+					break;
+				}
+				case EventType::MUTEX_EVENT: {
+					MutexEvent r;
+					memcpy(&r, data, sizeof(r));
+					begin_event("X", t.thread_id);
+					write_time("ts", r.begin_enter);
+					write_duration(r.begin_enter, r.end_enter);
+					out << ",\"cat\":\"mutex\",\"name\":\"mutex wait\",\"args\":{\"mutex\":" << r.mutex_id << "}}";
+					begin_event("X", t.thread_id);
+					write_time("ts", r.end_enter);
+					write_duration(r.end_enter, r.end_exit);
+					out << ",\"cat\":\"mutex\",\"name\":\"mutex locked\",\"args\":{\"mutex\":" << r.mutex_id << "}}";
+					break;
+				}
+				case EventType::COUNTER: {
+					CounterRecord r;
+					memcpy(&r, data, sizeof(r));
+					if (r.counter >= counters_count) break;
+					begin_event("C", t.thread_id);
+					write_time("ts", header.time);
+					out << ",\"name\":";
+					writeJSONString(out, counters[r.counter].name);
+					out << ",\"args\":{\"value\":" << r.value << "}}";
+					break;
+				}
+				case EventType::SAMPLE: {
+					SampleRecord r;
+					memcpy(&r, data, sizeof(r));
+					if (r.depth == 0 || sizeof(r) + r.depth * sizeof(u64) + sizeof(header) > header.size) break;
+					begin_event("i", t.thread_id);
+					write_time("ts", header.time);
+					out << ",\"s\":\"t\",\"cat\":\"sample\",\"name\":";
+					for (u32 i = 0; i < r.depth; ++i) {
+						u64 address;
+						memcpy(&address, data + sizeof(r) + i * sizeof(address), sizeof(address));
+						const char* name = get_string((const char*)(uintptr)address);
+						if (i == 0) {
+							writeJSONString(out, name);
+							out << ",\"args\":{\"stack\":[";
+						}
+						else {
+							out << ",";
+						}
+						writeJSONString(out, name);
+					}
+					out << "]}}";
+					break;
+				}
+				case EventType::FRAME:
+					begin_event("i", t.thread_id);
+					write_time("ts", header.time);
+					out << ",\"s\":\"g\",\"name\":\"frame\"}";
+					break;
+				case EventType::BEGIN_GPU_BLOCK: {
+					GPUBlock r;
+					memcpy(&r, data, sizeof(r));
+					begin_event("B", gpu_thread_id);
+					write_time("ts", r.timestamp);
+					out << ",\"name\":";
+					writeJSONString(out, r.name);
+					out << "}";
+					++gpu_depth;
+					break;
+				}
+				case EventType::END_GPU_BLOCK: {
+					if (gpu_depth == 0) break;
+					--gpu_depth;
+					u64 timestamp;
+					memcpy(&timestamp, data, sizeof(timestamp));
+					begin_event("E", gpu_thread_id);
+					write_time("ts", timestamp);
+					out << "}";
+					break;
+				}
+				default: break;
+			}
+			p += header.size;
+		}
+
+		// close blocks still open at the end of the capture
+		for (; depth > 0; --depth) {
+			begin_event("E", t.thread_id);
+			write_time("ts", last_time);
+			out << "}";
+		}
+	}
+
+	out << "\n]}\n";
+	return true;
+}
+
 void init(IAllocator& allocator) {
 	g_instance.create(allocator);
 }
@@ -5,6 +5,8 @@
 namespace Lumix {
 
 struct IAllocator;
+struct InputMemoryStream;
+struct IOutputStream;
 struct OutputMemoryStream;
 template <typename T> struct Span;
 
@@ -27,6 +29,11 @@ LUMIX_CORE_API void pushString(const char* value);
 LUMIX_CORE_API void pushInt(const char* key_literal, int value);
 LUMIX_CORE_API void pushMutexEvent(u64 mutex_id, u64 begin_enter_time, u64 end_enter_time, u64 begin_exit_time, u64 end_exit_time);
 
+// version of data written by `serialize`
+// 0 - initial version
+// 1 - timestamp frequency after version
+enum { SERIALIZE_VERSION = 1 };
+
 enum { INVALID_COUNTER = 0xffFFffFF };
 LUMIX_CORE_API u32 createCounter(const char* key_literal, float min);
 LUMIX_CORE_API u32 getCounterHandle(const char* key, float* last_value = nullptr);
@@ -39,6 +46,22 @@ LUMIX_CORE_API void link(i64 link);
 LUMIX_CORE_API i64 createNewLinkID();
 LUMIX_CORE_API void serialize(OutputMemoryStream& blob);
 
+// continuously write recorded data to a file from a background thread, so that long sessions do not lose history
+LUMIX_CORE_API bool startStreaming(const char* path);
+LUMIX_CORE_API void stopStreaming();
+LUMIX_CORE_API bool isStreaming();
+// convert data written by `startStreaming` to the same format `serialize` produces
+LUMIX_CORE_API bool streamToBlob(InputMemoryStream& stream, OutputMemoryStream& blob, IAllocator& allocator);
+// write data produced by `serialize` in Chrome trace event format (JSON), which can be opened in chrome://tracing or Perfetto
+LUMIX_CORE_API bool exportChromeTrace(InputMemoryStream& blob, IOutputStream& out, IAllocator& allocator);
+
+// sampling CPU profiler, periodically records callstacks of threads which are consuming CPU time
+// samples are recorded only for threads which already wrote some profiler events
+// only implemented on Linux, returns false on other platforms
+LUMIX_CORE_API bool startSampling(u32 frequency_hz);
+LUMIX_CORE_API void stopSampling();
+LUMIX_CORE_API bool isSampling();
+
 struct FiberSwitchData {
 	i32 id;
 	i32 blocks[16];
@@ -117,6 +140,14 @@ struct FiberWaitRecord
 	i32 job_system_signal;
 };
 
+enum { MAX_SAMPLE_DEPTH = 32 };
+
+// followed by `depth` u64 return addresses, innermost frame first
+// `serialize` puts symbol names of the addresses in its string table
+struct SampleRecord {
+	u32 depth;
+};
+
 struct MutexEvent {
 	u64 mutex_id;
 	u64 begin_enter;
@@ -152,7 +183,8 @@ enum class EventType : u8
 	CONTINUE_BLOCK,
 	SIGNAL_TRIGGERED,
 	COUNTER,
-	MUTEX_EVENT
+	MUTEX_EVENT,
+	SAMPLE
 };
 
 #pragma pack(1)
@@ -164,6 +196,26 @@ struct EventHeader
 };
 #pragma pack()
 
+// stream is a StreamHeader followed by chunks, each chunk starts with StreamChunk
+struct StreamHeader {
+	static constexpr u32 MAGIC = '_LPS';
+	u32 magic = MAGIC;
+	u32 version = 0;
+	u64 frequency;
+};
+
+enum class StreamChunk : u8 {
+	STRINGS,	// u32 count, count * (u64 key, zero-terminated string)
+	COUNTERS,	// u32 count, count * Counter
+	EVENTS		// u32 thread_id, StreamThreadFlags, thread name, u32 raw size, u32 compressed size, lz4 compressed events
+};
+
+enum class StreamThreadFlags : u8 {
+	NONE = 0,
+	GLOBAL = 1 << 0,
+	SHOW = 1 << 1
+};
+
 #define LUMIX_CONCAT2(a, b) a ## b
 #define LUMIX_CONCAT(a, b) LUMIX_CONCAT2(a, b)
 
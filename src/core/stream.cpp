@@ -436,4 +436,27 @@ const char* InputMemoryStream::readString()
 }
 
 
+void writeJSONString(IOutputStream& out, const char* str) {
+	static const char hex[] = "0123456789abcdef";
+	out << "\"";
+	for (const char* c = str; *c; ++c) {
+		switch (*c) {
+			case '"': out << "\\\""; break;
+			case '\\': out << "\\\\"; break;
+			case '\n': out << "\\n"; break;
+			case '\r': out << "\\r"; break;
+			case '\t': out << "\\t"; break;
+			default:
+				if ((u8)*c < 0x20) {
+					const char tmp[] = { '\\', 'u', '0', '0', hex[(u8)*c >> 4], hex[*c & 0xf] };
+					out.write(tmp, sizeof(tmp));
+				}
+				else out.write(*c);
+				break;
+		}
+	}
+	out << "\"";
+}
+
+
 } // namespace Lumix
@@ -137,6 +137,9 @@ private:
 	u64 m_pos = 0;
 };
 
+// quoted JSON string, quotes, backslashes and control characters are escaped
+LUMIX_CORE_API void writeJSONString(IOutputStream& out, const char* str);
+
 template <typename T> void IInputStream::readArray(Array<T>* array) {
 	const i32 size = read<i32>();
 	array->resize(size);
@@ -69,6 +69,15 @@ struct ThreadData {
 		u32 line;
 	};
 
+	// node of visible samples folded to a call tree, node 0 is the root with all samples
+	struct SampleNode {
+		const char* name;
+		u32 count;
+		u32 depth;
+		i32 first_child;
+		i32 next_sibling;
+	};
+
 	ThreadData(IAllocator& allocator, u32 thread_id, const char* name, bool show)
 		: rects(allocator)
 		, signals(allocator)
@@ -77,6 +86,8 @@ struct ThreadData {
 		, frames(allocator)
 		, context_switches(allocator)
 		, mutex_events(allocator)
+		, samples(allocator)
+		, sample_tree(allocator)
 		, gpu_blocks(allocator)
 		, show(show)
 		, name(name)
@@ -100,6 +111,9 @@ struct ThreadData {
 	Array<u64> frames;
 	Array<u32> context_switches;
 	Array<MutexEvent> mutex_events;
+	Array<u32> samples; // offsets of sample events
+	Array<SampleNode> sample_tree;
+	u32 sample_tree_depth = 0;
 	Array<GPUBlock> gpu_blocks;
 };
 
@@ -449,6 +463,7 @@ struct ProfilerUIImpl final : ProfilerUI {
 		settings.registerOption("profiler_show_frames", &m_show_frames, "Profiler", "Show frames");
 		settings.registerOption("profiler_show_context_switches", &m_show_context_switches, "Profiler", "Show context switches");
 		settings.registerOption("profiler_show_mutex_events", &m_show_mutex_events, "Profiler", "Show mutex events");
+		settings.registerOption("profiler_show_sample_tree", &m_show_sample_tree, "Profiler", "Show sampled callstacks flamegraph");
 	}
 
 	void snapshot() override {
@@ -459,9 +474,16 @@ struct ProfilerUIImpl final : ProfilerUI {
 		cacheVisibleBlocks();
 	}
 
+	// skip version and frequency
+	static void skipHeader(InputMemoryStream& blob) {
+		const u32 version = blob.read<u32>();
+		ASSERT(version <= profiler::SERIALIZE_VERSION);
+		if (version > 0) blob.skip(sizeof(u64));
+	}
+
 	ThreadContextProxy getGlobalThreadContextProxy() {
 		InputMemoryStream blob(m_data);
-		blob.skip(sizeof(u32));
+		skipHeader(blob);
 		const u32 count = blob.read<u32>();
 		blob.skip(count * sizeof(profiler::Counter));
 		blob.skip(sizeof(u32));
@@ -594,7 +616,7 @@ struct ProfilerUIImpl final : ProfilerUI {
 		InputMemoryStream tmp(m_data);
 		
 		// patch conunters
-		tmp.read<u32>();
+		skipHeader(tmp);
 		const u32 counters_count = tmp.read<u32>();
 		m_counters.reserve(counters_count);
 		for (u32 i = 0; i < counters_count; ++i) {
@@ -650,6 +672,18 @@ struct ProfilerUIImpl final : ProfilerUI {
 						overwrite(ctx, u32(p + sizeof(profiler::EventHeader)), r);
 						break;
 					}
+					case profiler::EventType::SAMPLE: {
+						profiler::SampleRecord r;
+						const u32 frames = u32(p + sizeof(profiler::EventHeader) + sizeof(r));
+						read(ctx, p + sizeof(profiler::EventHeader), r);
+						for (u32 i = 0; i < r.depth; ++i) {
+							u64 address;
+							read(ctx, frames + i * sizeof(address), address);
+							const char* new_val = map[(const char*)(uintptr)address];
+							overwrite(ctx, frames + i * sizeof(address), u64((uintptr)new_val));
+						}
+						break;
+					}
 					default: break;
 				}
 				p += header.size;
@@ -659,7 +693,7 @@ struct ProfilerUIImpl final : ProfilerUI {
 
 	void load() {
 		char path[MAX_PATH];
-		if (os::getOpenFilename(Span(path), "Profile data\0*.lpd", nullptr)) {
+		if (os::getOpenFilename(Span(path), "Profile data\0*.lpd;*.lps\0", nullptr)) {
 			os::InputFile file;
 			if (file.open(path)) {
 				m_threads.clear();
@@ -670,6 +704,10 @@ struct ProfilerUIImpl final : ProfilerUI {
 					logError("Could not read ", path);
 					m_data.clear();
 				}
+				else if (!convertStream()) {
+					logError("Could not load ", path);
+					m_data.clear();
+				}
 				else {
 					patchStrings();
 					preprocess();
@@ -682,14 +720,56 @@ struct ProfilerUIImpl final : ProfilerUI {
 		}
 	}
 
+	// if `m_data` contains data written by profiler::startStreaming, convert them to profiler::serialize format
+	bool convertStream() {
+		if (m_data.size() < sizeof(profiler::StreamHeader)) return true;
+		
+		profiler::StreamHeader header;
+		memcpy(&header, m_data.data(), sizeof(header));
+		if (header.magic != profiler::StreamHeader::MAGIC) return true;
+
+		OutputMemoryStream blob(m_allocator);
+		InputMemoryStream stream(m_data);
+		if (!profiler::streamToBlob(stream, blob, m_allocator)) return false;
+		m_data = static_cast<OutputMemoryStream&&>(blob);
+		return true;
+	}
+
+	void exportChromeTrace() {
+		char path[MAX_PATH];
+		if (!os::getSaveFilename(Span(path), "Chrome trace\0*.json\0", "json")) return;
+
+		os::OutputFile file;
+		if (!file.open(path)) {
+			logError("Could not open ", path);
+			return;
+		}
+
+		InputMemoryStream blob(m_data);
+		if (!profiler::exportChromeTrace(blob, file, m_allocator)) logError("Could not export ", path);
+		file.close();
+		if (file.isError()) logError("Could not write ", path);
+	}
+
+	void toggleStreaming() {
+		if (profiler::isStreaming()) {
+			profiler::stopStreaming();
+			return;
+		}
+
+		char path[MAX_PATH];
+		if (os::getSaveFilename(Span(path), "Profile stream\0*.lps\0", "lps")) {
+			profiler::startStreaming(path);
+		}
+	}
+
 	// create object from raw data
 	void preprocess() {
 		m_threads.clear();
 		m_counters.clear();
 		m_end = 0;
 		InputMemoryStream blob(m_data);
-		const u32 version = blob.read<u32>();
-		ASSERT(version == 0);
+		skipHeader(blob);
 		const u32 counters_count = blob.read<u32>();
 		for (u32 i = 0; i < counters_count; ++i) {
 			const profiler::Counter pc = blob.read<profiler::Counter>();
@@ -788,8 +868,7 @@ struct ProfilerUIImpl final : ProfilerUI {
 		if (m_data.empty()) return;
 
 		InputMemoryStream blob(m_data);
-		const u32 version = blob.read<u32>();
-		ASSERT(version == 0);
+		skipHeader(blob);
 		const u32 counters_count = blob.read<u32>();
 		blob.skip(counters_count * sizeof(profiler::Counter));
 		const u32 count = blob.read<u32>();
@@ -974,6 +1053,9 @@ struct ProfilerUIImpl final : ProfilerUI {
 			thread.fiber_waits.clear();
 			thread.frames.clear();
 			thread.mutex_events.clear();
+			thread.samples.clear();
+			thread.sample_tree.clear();
+			thread.sample_tree_depth = 0;
 			thread.gpu_blocks.clear();
 		}
 		
@@ -1042,6 +1124,9 @@ struct ProfilerUIImpl final : ProfilerUI {
 						thread.mutex_events.push({r, line});
 						break;
 					}
+					case profiler::EventType::SAMPLE:
+						if (header.time >= from_time && header.time <= to_time) thread.samples.push(p);
+						break;
 					case profiler::EventType::CONTEXT_SWITCH: {
 						profiler::ContextSwitchRecord r;
 						read(ctx, p + sizeof(profiler::EventHeader), r);
@@ -1192,9 +1277,71 @@ struct ProfilerUIImpl final : ProfilerUI {
 			}
 
 			thread.lines = lines;
+			foldSamples(ctx, thread);
 		});
 	}
 
+	static i32 getSampleNode(ThreadData& thread, i32 parent, const char* name) {
+		Array<ThreadData::SampleNode>& tree = thread.sample_tree;
+		i32 prev = -1;
+		for (i32 i = tree[parent].first_child; i >= 0; i = tree[i].next_sibling) {
+			if (equalStrings(tree[i].name, name)) return i;
+			prev = i;
+		}
+		const i32 idx = tree.size();
+		tree.push({name, 0, tree[parent].depth + 1, -1, -1});
+		if (prev < 0) tree[parent].first_child = idx;
+		else tree[prev].next_sibling = idx;
+		return idx;
+	}
+
+	// merges callstacks of visible samples, frames with the same function name and the same callers share a node
+	void foldSamples(ThreadContextProxy& ctx, ThreadData& thread) {
+		if (thread.samples.empty()) return;
+
+		thread.sample_tree.push({"all samples", (u32)thread.samples.size(), 0, -1, -1});
+		for (u32 offset : thread.samples) {
+			profiler::SampleRecord r;
+			read(ctx, offset + sizeof(profiler::EventHeader), r);
+			// frames are stored innermost first
+			i32 node = 0;
+			for (u32 i = r.depth; i > 0; --i) {
+				const char* name;
+				read(ctx, offset + sizeof(profiler::EventHeader) + sizeof(r) + (i - 1) * sizeof(u64), name);
+				node = getSampleNode(thread, node, name);
+				++thread.sample_tree[node].count;
+			}
+			thread.sample_tree_depth = maximum(thread.sample_tree_depth, r.depth + 1);
+		}
+	}
+
+	// flamegraph of folded samples, width of a node is proportional to the number of samples it is in
+	void sampleTreeUI(const ThreadData& thread, i32 node_idx, float from_x, float to_x, float y, float line_height) {
+		const ThreadData::SampleNode& node = thread.sample_tree[node_idx];
+		ImDrawList* dl = ImGui::GetWindowDrawList();
+		const float node_y = y + node.depth * line_height;
+		const ImVec2 ra(from_x, node_y);
+		const ImVec2 rb(to_x, node_y + line_height - 1);
+		const bool is_hovered = ImGui::IsMouseHoveringRect(ra, rb);
+		dl->AddRectFilled(ra, rb, is_hovered ? 0xff0000ff : 0xff00c0ff);
+		if (to_x - from_x > 2) dl->AddRect(ra, rb, ImGui::GetColorU32(ImGuiCol_Border));
+		if (ImGui::CalcTextSize(node.name).x + 2 < to_x - from_x) dl->AddText(ImVec2(from_x + 2, node_y), 0xff000000, node.name);
+		if (is_hovered) {
+			ImGui::BeginTooltip();
+			ImGui::TextUnformatted(node.name);
+			ImGui::Text("%u samples (%.1f%%)", node.count, 100.f * node.count / thread.sample_tree[0].count);
+			ImGui::EndTooltip();
+		}
+
+		const float scale = (to_x - from_x) / node.count;
+		float x = from_x;
+		for (i32 i = node.first_child; i >= 0; i = thread.sample_tree[i].next_sibling) {
+			const float w = thread.sample_tree[i].count * scale;
+			if (w >= 1) sampleTreeUI(thread, i, x, x + w, y, line_height);
+			x += w;
+		}
+	}
+
 	void threadUI(ThreadContextProxy& ctx, float from_x, float to_x) {
 		if (ctx.thread_id == 0) return;
 
@@ -1417,7 +1564,33 @@ struct ProfilerUIImpl final : ProfilerUI {
 			}
 			
 		}
-		ImGui::Dummy(ImVec2(to_x - from_x, thread.lines * line_height));
+		// samples from the sampling profiler, drawn as ticks below blocks
+		if (!thread.samples.empty()) {
+			const float y = thread_base_y + thread.lines * line_height;
+			for (u32 offset : thread.samples) {
+				profiler::EventHeader header;
+				read(ctx, offset, header);
+				const float x = getViewX(header.time, from_x, to_x);
+				dl->AddLine(ImVec2(x, y + 2), ImVec2(x, y + line_height - 2), 0xff00ffff);
+				if (!ImGui::IsMouseHoveringRect(ImVec2(x - 2, y), ImVec2(x + 2, y + line_height))) continue;
+
+				profiler::SampleRecord r;
+				read(ctx, offset + sizeof(profiler::EventHeader), r);
+				ImGui::BeginTooltip();
+				for (u32 i = 0; i < r.depth; ++i) {
+					const char* name;
+					read(ctx, offset + sizeof(profiler::EventHeader) + sizeof(r) + i * sizeof(u64), name);
+					ImGui::TextUnformatted(name);
+				}
+				ImGui::EndTooltip();
+			}
+		}
+		u32 lines = thread.lines + (thread.samples.empty() ? 0 : 1);
+		if (m_show_sample_tree && !thread.sample_tree.empty()) {
+			sampleTreeUI(thread, 0, from_x, to_x, thread_base_y + lines * line_height, line_height);
+			lines += thread.sample_tree_depth;
+		}
+		ImGui::Dummy(ImVec2(to_x - from_x, lines * line_height));
 		ImGui::TreePop();
 	}
 
@@ -1588,8 +1761,11 @@ struct ProfilerUIImpl final : ProfilerUI {
 		if (ImGui::BeginPopup("profiler_advanced")) {
 			if (ImGui::MenuItem("Load")) load();
 			if (ImGui::MenuItem("Save")) save();
+			if (ImGui::MenuItem("Export Chrome trace", nullptr, false, !m_data.empty())) exportChromeTrace();
+			if (ImGui::MenuItem(profiler::isStreaming() ? "Stop streaming" : "Start streaming")) toggleStreaming();
 			ImGui::Checkbox("Show frames", &m_show_frames);
 			ImGui::Checkbox("Show mutex events", &m_show_mutex_events);
+			ImGui::Checkbox("Show sampled callstacks flamegraph", &m_show_sample_tree);
 			ImGui::Text("Zoom: %f", m_range / double(DEFAULT_RANGE));
 			if (ImGui::MenuItem("Reset zoom")) m_range = DEFAULT_RANGE;
 			bool do_autopause = m_autopause >= 0;
@@ -1599,6 +1775,17 @@ struct ProfilerUIImpl final : ProfilerUI {
 			if (m_autopause >= 0) {
 				ImGui::InputFloat("Autopause limit (ms)", &m_autopause, 1.f, 10.f, "%.2f");
 			}
+			bool is_sampling = profiler::isSampling();
+			if (ImGui::Checkbox("Sample callstacks", &is_sampling)) {
+				if (!is_sampling) profiler::stopSampling();
+				else if (!profiler::startSampling(m_sampling_frequency)) logError("Sampling profiler is not available on this platform");
+			}
+			if (!is_sampling) {
+				i32 frequency = m_sampling_frequency;
+				if (ImGui::InputInt("Sampling frequency (Hz)", &frequency)) {
+					m_sampling_frequency = (u32)clamp(frequency, 1, 10'000);
+				}
+			}
 			if (ImGui::BeginMenu("Threads")) {
 				forEachThread([&](const ThreadContextProxy& ctx){
 					auto thread = m_threads.find(ctx.thread_id);
@@ -1702,6 +1889,8 @@ struct ProfilerUIImpl final : ProfilerUI {
 	bool m_show_context_switches = false;
 	bool m_show_mutex_events = true;
 	bool m_show_frames = true;
+	bool m_show_sample_tree = true;
+	u32 m_sampling_frequency = 1000;
 	
 	u32 m_frame_idx = 0; // incremented every frame gui is drawn
 	u64 m_end; // last visible time in ticks
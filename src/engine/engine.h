@@ -59,6 +59,8 @@ struct LUMIX_ENGINE_API Engine {
 	virtual void serializeProject(struct OutputMemoryStream& serializer, const Path& startup_world) const = 0;
 	virtual float getLastTimeDelta() const = 0;
 	virtual void setTimeMultiplier(float multiplier) = 0;
+	// every update uses `dt` instead of measured time, e.g. for deterministic benchmarks; 0 to use measured time
+	virtual void setFixedTimeDelta(float dt) = 0;
 	virtual void pause(bool pause) = 0;
 	virtual bool isPaused() const = 0;
 	virtual void nextFrame() = 0;
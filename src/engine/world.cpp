@@ -1,6 +1,7 @@
 #include "world.h"
 #include "engine/engine.h"
 #include "core/hash.h"
+#include "core/hash_map.h"
 #include "core/log.h"
 #include "core/math.h"
 #include "core/sort.h"
@@ -361,6 +362,46 @@ void World::setTransform(EntityRef entity, const DVec3& pos, const Quat& rot, co
 }
 
 
+void World::setTransforms(Span<const EntityRef> entities, Span<const RigidTransform> transforms)
+{
+	ASSERT(entities.length() == transforms.length());
+	for (u32 i = 0, c = entities.length(); i < c; ++i) {
+		Transform& tmp = m_transforms[entities[i].index];
+		tmp.pos = transforms[i].pos;
+		tmp.rot = transforms[i].rot;
+	}
+
+	// local transforms are computed once all global transforms are set, so the order of parents and children in the batch does not matter
+	for (EntityRef entity : entities) {
+		const i32 hierarchy_idx = m_entities[entity.index].hierarchy;
+		if (hierarchy_idx < 0) continue;
+		Hierarchy& h = m_hierarchy[hierarchy_idx];
+		if (h.parent.isValid()) h.local_transform = Transform::computeLocal(getTransform((EntityRef)h.parent), getTransform(entity));
+	}
+
+	// entities with an ancestor in the batch are transformed recursively with the ancestor, so they get only one callback
+	HashMap<i32, bool> batch(m_allocator);
+	for (EntityRef entity : entities) {
+		if (m_entities[entity.index].hierarchy >= 0 && !batch.find(entity.index).isValid()) batch.insert(entity.index, true);
+	}
+	auto has_ancestor_in_batch = [&](EntityRef entity){
+		for (;;) {
+			const i32 hierarchy_idx = m_entities[entity.index].hierarchy;
+			if (hierarchy_idx < 0) return false;
+			const EntityPtr parent = m_hierarchy[hierarchy_idx].parent;
+			if (!parent.isValid()) return false;
+			if (batch.find(parent.index).isValid()) return true;
+			entity = (EntityRef)parent;
+		}
+	};
+
+	for (EntityRef entity : entities) {
+		if (batch.size() > 0 && has_ancestor_in_batch(entity)) continue;
+		transformEntity(entity, false);
+	}
+}
+
+
 const Transform& World::getTransform(EntityRef entity) const
 {
 	return m_transforms[entity.index];
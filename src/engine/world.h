@@ -107,6 +107,8 @@ struct LUMIX_ENGINE_API World {
 	void setTransform(EntityRef entity, const Transform& transform);
 	void setTransformKeepChildren(EntityRef entity, const Transform& transform);
 	void setTransform(EntityRef entity, const DVec3& pos, const Quat& rot, const Vec3& scale);
+	// all transforms are written before hierarchy is updated and transformed callbacks are called
+	void setTransforms(Span<const EntityRef> entities, Span<const RigidTransform> transforms);
 	const Transform& getTransform(EntityRef entity) const;
 	void setRotation(EntityRef entity, float x, float y, float z, float w);
 	void setRotation(EntityRef entity, const Quat& rot);
@@ -19,6 +19,7 @@
 #include "core/os.h"
 #include "core/path.h"
 #include "core/profiler.h"
+#include "core/sort.h"
 #include "core/stream.h"
 #include "editor/asset_browser.h"
 #include "editor/asset_compiler.h"
@@ -1317,6 +1318,66 @@ Editor.addAction {
 }
 */
 
+// heap of all Lua states, attributed to scripts, and the explicit GC steps
+struct LuaMemoryUI final : StudioApp::GUIPlugin {
+	explicit LuaMemoryUI(StudioApp& app)
+		: m_app(app)
+		, m_categories(app.getAllocator())
+	{
+		app.getSettings().registerOption("lua_memory_ui_open", &m_is_open);
+	}
+
+	struct Category {
+		u32 index;
+		u64 size;
+	};
+
+	void onGUI() override {
+		if (m_app.checkShortcut(m_toggle_ui, true)) m_is_open = !m_is_open;
+		if (!m_is_open) return;
+
+		if (ImGui::Begin("Lua memory", &m_is_open)) {
+			LuaScriptSystem* system = (LuaScriptSystem*)m_app.getEngine().getSystemManager().getSystem("lua_script");
+			ImGuiEx::Label("Heap size");
+			ImGui::Text("%.1f KB", system->getHeapSize() / 1024.f);
+			ImGuiEx::Label("GC time");
+			ImGui::Text("%.3f ms", system->getLastGCTime());
+			ImGuiEx::Label("GC budget (ms)");
+			float budget = system->getGCBudget();
+			if (ImGui::DragFloat("##gc_budget", &budget, 0.01f, 0, 10)) system->setGCBudget(budget);
+
+			m_categories.clear();
+			for (u32 i = 0, c = system->getMemoryCategoriesCount(); i < c; ++i) {
+				const u64 size = system->getMemoryCategorySize(i);
+				if (size > 0) m_categories.push({i, size});
+			}
+			sort(m_categories.begin(), m_categories.end(), [](const Category& a, const Category& b) { return a.size > b.size; });
+
+			if (ImGui::BeginTable("categories", 2, ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg)) {
+				ImGui::TableSetupColumn("Script");
+				ImGui::TableSetupColumn("Size (KB)");
+				ImGui::TableHeadersRow();
+				for (const Category& category : m_categories) {
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(system->getMemoryCategoryName(category.index));
+					ImGui::TableNextColumn();
+					ImGui::Text("%.1f", category.size / 1024.f);
+				}
+				ImGui::EndTable();
+			}
+		}
+		ImGui::End();
+	}
+
+	const char* getName() const override { return "lua_memory"; }
+
+	StudioApp& m_app;
+	Array<Category> m_categories;
+	bool m_is_open = false;
+	Action m_toggle_ui{"Lua memory", "Lua memory", "Toggle UI", "lua_memory_toggle_ui", "", Action::WINDOW};
+};
+
 struct LuaAction {
 	void run() {
 		LuaWrapper::DebugGuard guard(L);
@@ -1339,6 +1400,7 @@ struct StudioAppPlugin : StudioApp::IPlugin {
 		, m_lua_actions(app.getAllocator())
 		, m_plugins(app.getAllocator())
 		, m_property_grid_plugin(app)
+		, m_memory_ui(app)
 	{
 		LuaScriptSystem* system = (LuaScriptSystem*)app.getEngine().getSystemManager().getSystem("lua_script");
 		lua_State* L = system->getState();
@@ -1871,6 +1933,7 @@ struct StudioAppPlugin : StudioApp::IPlugin {
 		m_app.getAssetCompiler().addPlugin(m_asset_plugin, Span(exts));
 		m_app.getAssetBrowser().addPlugin(m_asset_plugin, Span(exts));
 		m_app.getPropertyGrid().addPlugin(m_property_grid_plugin);
+		m_app.addPlugin(m_memory_ui);
 
 		// lua API
 		// TODO cleanup
@@ -1933,6 +1996,7 @@ struct StudioAppPlugin : StudioApp::IPlugin {
 		m_app.getAssetCompiler().removePlugin(m_asset_plugin);
 		m_app.getAssetBrowser().removePlugin(m_asset_plugin);
 		m_app.getPropertyGrid().removePlugin(m_property_grid_plugin);
+		m_app.removePlugin(m_memory_ui);
 
 		for (StudioLuaPlugin* plugin : m_plugins) {
 			m_app.removePlugin(*plugin);
@@ -1966,6 +2030,7 @@ struct StudioAppPlugin : StudioApp::IPlugin {
 	LuauAnalysis m_luau_analysis;
 	AssetPlugin m_asset_plugin;
 	PropertyGridPlugin m_property_grid_plugin;
+	LuaMemoryUI m_memory_ui;
 	Array<LuaAction*> m_lua_actions;
 	Array<StudioLuaPlugin*> m_plugins;
 	bool m_lua_debug_enabled = true;
@@ -1,8 +1,10 @@
+#include "core/array.h"
 #include "core/delegate.h"
 #include "core/log.h"
 #include "core/math.h"
 #include "core/os.h"
 #include "core/profiler.h"
+#include "core/stream.h"
 #include "core/string.h"
 #include "engine/component_types.h"
 #include "engine/engine.h"
@@ -10,6 +12,7 @@
 #include "engine/input_system.h"
 #include "engine/plugin.h"
 #include "engine/prefab.h"
+#include "engine/reflection.h"
 #include "engine/world.h"
 #include "lua_script_system.h"
 #include "lua_wrapper.h"
@@ -624,6 +627,330 @@ static Vec3 LUA_getEntityScale(lua_State* L, World* world, i32 entity)
 }
 
 
+// vector variants return native Luau vectors, which do not allocate, positions are converted to float precision
+static int LUA_getEntityPositionVector(lua_State* L) {
+	World* world = LuaWrapper::checkArg<World*>(L, 1);
+	const i32 entity = LuaWrapper::checkArg<i32>(L, 2);
+	if (entity < 0) luaL_argerror(L, 2, "Invalid entity");
+	LuaWrapper::pushVector(L, Vec3(world->getPosition(EntityRef{entity})));
+	return 1;
+}
+
+static int LUA_getEntityLocalPositionVector(lua_State* L) {
+	World* world = LuaWrapper::checkArg<World*>(L, 1);
+	const i32 entity = LuaWrapper::checkArg<i32>(L, 2);
+	if (entity < 0) luaL_argerror(L, 2, "Invalid entity");
+	LuaWrapper::pushVector(L, Vec3(world->getLocalTransform(EntityRef{entity}).pos));
+	return 1;
+}
+
+static int LUA_getEntityScaleVector(lua_State* L) {
+	World* world = LuaWrapper::checkArg<World*>(L, 1);
+	const i32 entity = LuaWrapper::checkArg<i32>(L, 2);
+	if (entity < 0) luaL_argerror(L, 2, "Invalid entity");
+	LuaWrapper::pushVector(L, world->getScale(EntityRef{entity}));
+	return 1;
+}
+
+static int LUA_createVector(lua_State* L) {
+	const float x = LuaWrapper::checkArg<float>(L, 1);
+	const float y = LuaWrapper::checkArg<float>(L, 2);
+	const float z = LuaWrapper::checkArg<float>(L, 3);
+	lua_pushvector(L, x, y, z);
+	return 1;
+}
+
+// v[1], v[2], v[3] work on vectors like on {x, y, z} tables, v.x, v.y, v.z are handled by Luau itself
+static int LUA_vectorIndex(lua_State* L) {
+	const float* v = luaL_checkvector(L, 1);
+	if (lua_type(L, 2) == LUA_TNUMBER) {
+		const i32 idx = (i32)lua_tointeger(L, 2);
+		if (idx >= 1 && idx <= 3) {
+			lua_pushnumber(L, v[idx - 1]);
+			return 1;
+		}
+	}
+	else if (lua_type(L, 2) == LUA_TSTRING) {
+		const char* key = lua_tostring(L, 2);
+		if (key[0] >= 'x' && key[0] <= 'z' && key[1] == 0) {
+			lua_pushnumber(L, v[key[0] - 'x']);
+			return 1;
+		}
+	}
+	lua_pushnil(L);
+	return 1;
+}
+
+static int LUA_vectorLen(lua_State* L) {
+	lua_pushinteger(L, 3);
+	return 1;
+}
+
+static void registerVectorAPI(lua_State* L) {
+	LuaWrapper::DebugGuard guard(L);
+	// metatable shared by all vectors
+	lua_pushvector(L, 0, 0, 0); // [v]
+	lua_newtable(L); // [v, mt]
+	lua_pushcfunction(L, LUA_vectorIndex, "__index");
+	lua_setfield(L, -2, "__index");
+	lua_pushcfunction(L, LUA_vectorLen, "__len");
+	lua_setfield(L, -2, "__len");
+	lua_setmetatable(L, -2); // [v]
+	lua_pop(L, 1); // []
+
+	// same as vector.create in newer Luau
+	lua_newtable(L);
+	lua_pushcfunction(L, LUA_createVector, "create");
+	lua_setfield(L, -2, "create");
+	lua_setglobal(L, "vector");
+}
+
+// Bulk access for scripts driving many entities, one call for all entities instead of one per entity.
+// Entities are a buffer of i32 entity indices or an array of entities (or entity indices).
+// Values are packed in buffers: positions as 3 f64, rotations as 4 f32 (x, y, z, w), properties as f32, i32 or 3 f32.
+// Getters write to the optional output buffer if it's big enough, otherwise they return a new one.
+
+static bool readEntities(lua_State* L, int idx, const World& world, Array<EntityRef>& out) {
+	auto add = [&](i32 e){
+		if (e < 0 || !world.hasEntity(EntityRef{e})) return false;
+		out.push(EntityRef{e});
+		return true;
+	};
+	if (lua_isbuffer(L, idx)) {
+		size_t size;
+		const i32* entities = (const i32*)lua_tobuffer(L, idx, &size);
+		out.reserve(u32(size / sizeof(i32)));
+		for (u32 i = 0; i < size / sizeof(i32); ++i) {
+			if (!add(entities[i])) return false;
+		}
+		return true;
+	}
+
+	if (!lua_istable(L, idx)) return false;
+	const i32 count = lua_objlen(L, idx);
+	out.reserve(count);
+	for (i32 i = 1; i <= count; ++i) {
+		lua_rawgeti(L, idx, i);
+		if (lua_istable(L, -1)) lua_getfield(L, -1, "_entity");
+		else lua_pushvalue(L, -1);
+		const i32 e = lua_isnumber(L, -1) ? (i32)lua_tointeger(L, -1) : -1;
+		lua_pop(L, 2);
+		if (!add(e)) return false;
+	}
+	return true;
+}
+
+// pushes the output buffer
+static u8* pushOutputBuffer(lua_State* L, int idx, size_t size) {
+	if (lua_isbuffer(L, idx)) {
+		size_t len;
+		u8* data = (u8*)lua_tobuffer(L, idx, &len);
+		if (len >= size) {
+			lua_pushvalue(L, idx);
+			return data;
+		}
+	}
+	return (u8*)lua_newbuffer(L, size);
+}
+
+static const u8* getInputBuffer(lua_State* L, int idx, size_t size) {
+	if (!lua_isbuffer(L, idx)) return nullptr;
+	size_t len;
+	const u8* data = (const u8*)lua_tobuffer(L, idx, &len);
+	return len >= size ? data : nullptr;
+}
+
+// errors are raised once arrays are destroyed, since lua errors do not unwind the stack
+static int LUA_getEntityPositions(lua_State* L) {
+	World* world = LuaWrapper::checkArg<World*>(L, 1);
+	bool valid;
+	{
+		Array<EntityRef> entities(world->getAllocator());
+		valid = readEntities(L, 2, *world, entities);
+		if (valid) {
+			double* out = (double*)pushOutputBuffer(L, 3, entities.size() * sizeof(double) * 3);
+			for (EntityRef e : entities) {
+				const DVec3 pos = world->getPosition(e);
+				*out++ = pos.x;
+				*out++ = pos.y;
+				*out++ = pos.z;
+			}
+		}
+	}
+	if (!valid) luaL_argerror(L, 2, "Invalid entities");
+	return 1;
+}
+
+static int LUA_getEntityRotations(lua_State* L) {
+	World* world = LuaWrapper::checkArg<World*>(L, 1);
+	bool valid;
+	{
+		Array<EntityRef> entities(world->getAllocator());
+		valid = readEntities(L, 2, *world, entities);
+		if (valid) {
+			Quat* out = (Quat*)pushOutputBuffer(L, 3, entities.size() * sizeof(Quat));
+			for (EntityRef e : entities) *out++ = world->getRotation(e);
+		}
+	}
+	if (!valid) luaL_argerror(L, 2, "Invalid entities");
+	return 1;
+}
+
+// positions and/or rotations (nil to keep), applied as one batch
+static int LUA_setEntityTransforms(lua_State* L) {
+	World* world = LuaWrapper::checkArg<World*>(L, 1);
+	const char* error = nullptr;
+	{
+		Array<EntityRef> entities(world->getAllocator());
+		Array<RigidTransform> transforms(world->getAllocator());
+		const double* positions = nullptr;
+		const Quat* rotations = nullptr;
+		if (!readEntities(L, 2, *world, entities)) error = "Invalid entities";
+		else if (!lua_isnoneornil(L, 3) && !(positions = (const double*)getInputBuffer(L, 3, entities.size() * sizeof(double) * 3))) error = "Positions buffer is too small";
+		else if (!lua_isnoneornil(L, 4) && !(rotations = (const Quat*)getInputBuffer(L, 4, entities.size() * sizeof(Quat)))) error = "Rotations buffer is too small";
+		else {
+			transforms.reserve(entities.size());
+			for (i32 i = 0; i < entities.size(); ++i) {
+				const Transform& tr = world->getTransform(entities[i]);
+				RigidTransform& rt = transforms.emplace();
+				rt.pos = positions ? DVec3(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2]) : tr.pos;
+				rt.rot = rotations ? rotations[i] : tr.rot;
+			}
+			world->setTransforms(entities, transforms);
+		}
+	}
+	if (error) luaL_error(L, "%s", error);
+	return 0;
+}
+
+// top level property of a component, found by its lua name
+struct BulkProperty : reflection::IEmptyPropertyVisitor {
+	template <typename T>
+	void check(const reflection::Property<T>& prop, const reflection::Property<T>*& out) {
+		char tmp[128];
+		LuaWrapper::convertPropertyToLuaName(prop.name, Span(tmp));
+		if (equalStrings(tmp, lua_name)) out = &prop;
+	}
+
+	void visit(const reflection::Property<float>& prop) override { check(prop, float_prop); }
+	void visit(const reflection::Property<i32>& prop) override { check(prop, i32_prop); }
+	void visit(const reflection::Property<bool>& prop) override { check(prop, bool_prop); }
+	void visit(const reflection::Property<Vec3>& prop) override { check(prop, vec3_prop); }
+
+	bool found() const { return float_prop || i32_prop || bool_prop || vec3_prop; }
+	u32 stride() const { return vec3_prop ? sizeof(Vec3) : 4; }
+
+	const char* lua_name;
+	const reflection::Property<float>* float_prop = nullptr;
+	const reflection::Property<i32>* i32_prop = nullptr;
+	const reflection::Property<bool>* bool_prop = nullptr;
+	const reflection::Property<Vec3>* vec3_prop = nullptr;
+};
+
+static const char* findBulkProperty(lua_State* L, World& world, BulkProperty& prop, ComponentType& cmp_type) {
+	cmp_type = reflection::getComponentType(LuaWrapper::checkArg<const char*>(L, 3));
+	prop.lua_name = LuaWrapper::checkArg<const char*>(L, 4);
+	const reflection::ComponentBase* cmp = reflection::getComponent(cmp_type);
+	if (!cmp || !world.getModule(cmp_type)) return "Unknown component";
+	cmp->visit(prop);
+	if (!prop.found()) return "Unknown property, or its type is not float, int, bool or Vec3";
+	return nullptr;
+}
+
+static bool hasComponents(const World& world, Span<const EntityRef> entities, ComponentType cmp_type) {
+	for (EntityRef e : entities) {
+		if (!world.hasComponent(e, cmp_type)) return false;
+	}
+	return true;
+}
+
+// getComponentProperties(world, entities, component_type, property_name [, output_buffer])
+static int LUA_getComponentProperties(lua_State* L) {
+	World* world = LuaWrapper::checkArg<World*>(L, 1);
+	BulkProperty prop;
+	ComponentType cmp_type;
+	const char* error = findBulkProperty(L, *world, prop, cmp_type);
+	if (error) luaL_error(L, "%s", error);
+
+	{
+		Array<EntityRef> entities(world->getAllocator());
+		if (!readEntities(L, 2, *world, entities)) error = "Invalid entities";
+		else if (!hasComponents(*world, entities, cmp_type)) error = "Entity without the component";
+		else {
+			u8* out = pushOutputBuffer(L, 5, entities.size() * prop.stride());
+			ComponentUID cmp(INVALID_ENTITY, cmp_type, world->getModule(cmp_type));
+			for (EntityRef e : entities) {
+				cmp.entity = e;
+				if (prop.float_prop) {
+					const float v = prop.float_prop->get(cmp, -1);
+					memcpy(out, &v, 4);
+				}
+				else if (prop.i32_prop) {
+					const i32 v = prop.i32_prop->get(cmp, -1);
+					memcpy(out, &v, 4);
+				}
+				else if (prop.bool_prop) {
+					const i32 v = prop.bool_prop->get(cmp, -1) ? 1 : 0;
+					memcpy(out, &v, 4);
+				}
+				else {
+					const Vec3 v = prop.vec3_prop->get(cmp, -1);
+					memcpy(out, &v, sizeof(v));
+				}
+				out += prop.stride();
+			}
+		}
+	}
+	if (error) luaL_error(L, "%s", error);
+	return 1;
+}
+
+// setComponentProperties(world, entities, component_type, property_name, values_buffer)
+static int LUA_setComponentProperties(lua_State* L) {
+	World* world = LuaWrapper::checkArg<World*>(L, 1);
+	BulkProperty prop;
+	ComponentType cmp_type;
+	const char* error = findBulkProperty(L, *world, prop, cmp_type);
+	if (error) luaL_error(L, "%s", error);
+
+	{
+		Array<EntityRef> entities(world->getAllocator());
+		const u8* values = nullptr;
+		if (!readEntities(L, 2, *world, entities)) error = "Invalid entities";
+		else if (!hasComponents(*world, entities, cmp_type)) error = "Entity without the component";
+		else if (!(values = getInputBuffer(L, 5, entities.size() * prop.stride()))) error = "Values buffer is too small";
+		else {
+			ComponentUID cmp(INVALID_ENTITY, cmp_type, world->getModule(cmp_type));
+			for (EntityRef e : entities) {
+				cmp.entity = e;
+				if (prop.float_prop) {
+					float v;
+					memcpy(&v, values, 4);
+					prop.float_prop->set(cmp, -1, v);
+				}
+				else if (prop.i32_prop) {
+					i32 v;
+					memcpy(&v, values, 4);
+					prop.i32_prop->set(cmp, -1, v);
+				}
+				else if (prop.bool_prop) {
+					i32 v;
+					memcpy(&v, values, 4);
+					prop.bool_prop->set(cmp, -1, v != 0);
+				}
+				else {
+					Vec3 v;
+					memcpy(&v, values, sizeof(v));
+					prop.vec3_prop->set(cmp, -1, v);
+				}
+				values += prop.stride();
+			}
+		}
+	}
+	if (error) luaL_error(L, "%s", error);
+	return 0;
+}
+
 static i32 LUA_getFirstChild(lua_State* L, World* world, i32 entity)
 {
 	if (entity < 0) luaL_argerror(L, 2, "Invalid entity");
@@ -850,6 +1177,160 @@ static int LUA_raycastEx(lua_State* L)
 	return 1;
 }
 
+static PhysicsModule* checkPhysicsModule(lua_State* L) {
+	LuaWrapper::checkTableArg(L, 1);
+	PhysicsModule* module;
+	if (!LuaWrapper::checkField(L, 1, "_module", &module)) luaL_argerror(L, 1, "Module expected");
+	return module;
+}
+
+// queries are read from array of tables in argument 2, `read(query)` is called with the query table on top of the stack
+// returns error message or nullptr, callers raise the error once `queries` is destroyed, since Lua errors skip destructors
+template <typename Query, typename F>
+static const char* readQueries(lua_State* L, Array<Query>& queries, F&& read) {
+	if (!lua_istable(L, 2)) return "array of query tables expected";
+	const i32 n = (i32)lua_objlen(L, 2);
+	queries.reserve(n);
+	for (i32 i = 0; i < n; ++i) {
+		lua_rawgeti(L, 2, i + 1);
+		if (!lua_istable(L, -1)) {
+			lua_pop(L, 1);
+			return "array of query tables expected";
+		}
+		Query& query = queries.emplace();
+		LuaWrapper::checkField(L, -1, "ignored", &query.ignored);
+		LuaWrapper::checkField(L, -1, "layer", &query.layer);
+		if (!read(query)) {
+			lua_pop(L, 1);
+			return "invalid query";
+		}
+		lua_pop(L, 1);
+	}
+	return nullptr;
+}
+
+// physics:raycastBatch({ {origin = {x, y, z}, dir = {x, y, z}, distance = d, [layer = l], [ignored = e]}, ... })
+// returns array with `false` or {entity, position, normal} for each query
+static int LUA_raycastBatch(lua_State* L) {
+	PhysicsModule* module = checkPhysicsModule(L);
+	World& world = module->getWorld();
+	const char* error;
+	{
+		Array<PhysicsModule::RaycastQuery> queries(world.getAllocator());
+		error = readQueries(L, queries, [&](PhysicsModule::RaycastQuery& query){
+			query.distance = FLT_MAX;
+			LuaWrapper::checkField(L, -1, "distance", &query.distance);
+			if (!LuaWrapper::checkField(L, -1, "origin", &query.origin)) return false;
+			if (!LuaWrapper::checkField(L, -1, "dir", &query.dir)) return false;
+			query.dir = normalize(query.dir);
+			return true;
+		});
+
+		if (!error) {
+			Array<RaycastHit> hits(world.getAllocator());
+			hits.resize(queries.size());
+			module->raycastBatch(queries, hits);
+
+			lua_createtable(L, hits.size(), 0);
+			for (i32 i = 0; i < hits.size(); ++i) {
+				const RaycastHit& hit = hits[i];
+				if (hit.entity.isValid()) {
+					lua_createtable(L, 0, 3);
+					LuaWrapper::pushEntity(L, hit.entity, &world);
+					lua_setfield(L, -2, "entity");
+					LuaWrapper::push(L, hit.position);
+					lua_setfield(L, -2, "position");
+					LuaWrapper::push(L, hit.normal);
+					lua_setfield(L, -2, "normal");
+				}
+				else {
+					LuaWrapper::push(L, false);
+				}
+				lua_rawseti(L, -2, i + 1);
+			}
+		}
+	}
+	if (error) luaL_argerror(L, 2, error);
+	return 1;
+}
+
+// physics:sweepSphereBatch({ {position = {x, y, z}, radius = r, dir = {x, y, z}, distance = d, [layer = l], [ignored = e]}, ... })
+// returns array with `false` or {entity, position, normal, distance} for each query
+static int LUA_sweepSphereBatch(lua_State* L) {
+	PhysicsModule* module = checkPhysicsModule(L);
+	World& world = module->getWorld();
+	const char* error;
+	{
+		Array<PhysicsModule::SweepSphereQuery> queries(world.getAllocator());
+		error = readQueries(L, queries, [&](PhysicsModule::SweepSphereQuery& query){
+			if (!LuaWrapper::checkField(L, -1, "position", &query.pos)) return false;
+			if (!LuaWrapper::checkField(L, -1, "radius", &query.radius)) return false;
+			if (!LuaWrapper::checkField(L, -1, "dir", &query.dir)) return false;
+			if (!LuaWrapper::checkField(L, -1, "distance", &query.distance)) return false;
+			query.dir = normalize(query.dir);
+			return true;
+		});
+
+		if (!error) {
+			Array<SweepHit> hits(world.getAllocator());
+			hits.resize(queries.size());
+			module->sweepSphereBatch(queries, hits);
+
+			lua_createtable(L, hits.size(), 0);
+			for (i32 i = 0; i < hits.size(); ++i) {
+				const SweepHit& hit = hits[i];
+				if (hit.entity.isValid()) {
+					lua_createtable(L, 0, 4);
+					LuaWrapper::pushEntity(L, hit.entity, &world);
+					lua_setfield(L, -2, "entity");
+					LuaWrapper::push(L, hit.position);
+					lua_setfield(L, -2, "position");
+					LuaWrapper::push(L, hit.normal);
+					lua_setfield(L, -2, "normal");
+					LuaWrapper::push(L, hit.distance);
+					lua_setfield(L, -2, "distance");
+				}
+				else {
+					LuaWrapper::push(L, false);
+				}
+				lua_rawseti(L, -2, i + 1);
+			}
+		}
+	}
+	if (error) luaL_argerror(L, 2, error);
+	return 1;
+}
+
+// physics:overlapSphereBatch({ {position = {x, y, z}, radius = r, [layer = l], [ignored = e]}, ... })
+// returns array with `false` or overlapping entity for each query
+static int LUA_overlapSphereBatch(lua_State* L) {
+	PhysicsModule* module = checkPhysicsModule(L);
+	World& world = module->getWorld();
+	const char* error;
+	{
+		Array<PhysicsModule::OverlapSphereQuery> queries(world.getAllocator());
+		error = readQueries(L, queries, [&](PhysicsModule::OverlapSphereQuery& query){
+			if (!LuaWrapper::checkField(L, -1, "position", &query.pos)) return false;
+			return LuaWrapper::checkField(L, -1, "radius", &query.radius);
+		});
+
+		if (!error) {
+			Array<EntityPtr> hits(world.getAllocator());
+			hits.resize(queries.size());
+			module->overlapSphereBatch(queries, hits);
+
+			lua_createtable(L, hits.size(), 0);
+			for (i32 i = 0; i < hits.size(); ++i) {
+				if (hits[i].isValid()) LuaWrapper::pushEntity(L, hits[i], &world);
+				else LuaWrapper::push(L, false);
+				lua_rawseti(L, -2, i + 1);
+			}
+		}
+	}
+	if (error) luaL_argerror(L, 2, error);
+	return 1;
+}
+
 
 static int LUA_getInlineEnvironment(lua_State* L) {
 	if (!lua_istable(L, 1)) {
@@ -943,6 +1424,74 @@ static int LUA_getEnvironment(lua_State* L)
 
 void registerLuaAPI(lua_State* L);
 
+// entity properties shared by the main and isolated states, so they can not drift apart
+// it's executed in one chunk between `head` and `tail`; `head` defines `entityIndexFallback` and `entityNewIndexFallback`
+// for keys without accessors, `tail` can add accessors to `entity_getters` and `entity_setters`
+static const char* entity_accessors_src = R"#(
+		-- dispatch tables, so properties are not resolved by a chain of string comparisons
+		local entity_getters = {
+			position = function(e) return LumixAPI.getEntityPosition(e._world, e._entity) end,
+			local_position = function(e) return LumixAPI.getEntityLocalPosition(e._world, e._entity) end,
+			-- native vectors, no garbage, but float precision
+			vposition = function(e) return LumixAPI.getEntityPositionVector(e._world, e._entity) end,
+			vlocal_position = function(e) return LumixAPI.getEntityLocalPositionVector(e._world, e._entity) end,
+			vscale = function(e) return LumixAPI.getEntityScaleVector(e._world, e._entity) end,
+			parent = function(e)
+				local p = LumixAPI.getParent(e._world, e._entity)
+				if p < 0 then return nil end
+				return Lumix.Entity:new(e._world, p)
+			end,
+			first_child = function(e)
+				local p = LumixAPI.getFirstChild(e._world, e._entity)
+				if p < 0 then return nil end
+				return Lumix.Entity:new(e._world, p)
+			end,
+			next_sibling = function(e)
+				local p = LumixAPI.getNextSibling(e._world, e._entity)
+				if p < 0 then return nil end
+				return Lumix.Entity:new(e._world, p)
+			end,
+			rotation = function(e) return LumixAPI.getEntityRotation(e._world, e._entity) end,
+			name = function(e) return LumixAPI.getEntityName(e._world, e._entity) end,
+			scale = function(e) return LumixAPI.getEntityScale(e._world, e._entity) end,
+			_world = function(e) return rawget(e, "_world") end,
+			_entity = function(e) return rawget(e, "_entity") end,
+		}
+		local entity_setters = {
+			position = function(e, v) LumixAPI.setEntityPosition(e._world, e._entity, v) end,
+			vposition = function(e, v) LumixAPI.setEntityPosition(e._world, e._entity, v) end,
+			rotation = function(e, v) LumixAPI.setEntityRotation(e._world, e._entity, v) end,
+			scale = function(e, v) LumixAPI.setEntityScale(e._world, e._entity, v) end,
+			vscale = function(e, v) LumixAPI.setEntityScale(e._world, e._entity, v) end,
+		}
+		Lumix.Entity.__index = function(table, key)
+			local getter = entity_getters[key]
+			if getter ~= nil then return getter(table) end
+			local method = Lumix.Entity[key]
+			if method ~= nil then return method end
+			return entityIndexFallback(table, key)
+		end
+		Lumix.Entity.__newindex = function(table, key, value)
+			local setter = entity_setters[key]
+			if setter ~= nil then
+				setter(table, value)
+			else
+				entityNewIndexFallback(table, key, value)
+			end
+		end
+		Lumix.Entity.__eq = function(a, b)
+			return a._entity == b._entity and a._world == b._world
+		end
+		Lumix.Entity.INVALID = Lumix.Entity:new(nil, -1)
+		Lumix.Entity.NULL = Lumix.Entity.INVALID
+)#";
+
+static bool executeEntitySource(lua_State* L, Engine& engine, const char* head, const char* tail, const char* name) {
+	OutputMemoryStream src(engine.getAllocator());
+	src << head << entity_accessors_src << tail;
+	return LuaWrapper::execute(L, StringView((const char*)src.data(), (u32)src.size()), name, 0);
+}
+
 void registerEngineAPI(lua_State* L, Engine* engine) {
 	LuaWrapper::DebugGuard guard(L);
 	lua_pushcfunction(L, &LUA_loadstring, "loadstring");
@@ -993,6 +1542,15 @@ void registerEngineAPI(lua_State* L, Engine* engine) {
 	LuaWrapper::createSystemClosure(L, "LumixAPI", engine, "getResourcePath", &LuaWrapper::wrap<LUA_getResourcePath>);
 
 	LuaWrapper::createSystemFunction(L, "LumixAPI", "getAllEntities", &LUA_getAllEntities);
+	LuaWrapper::createSystemFunction(L, "LumixAPI", "getEntityPositionVector", &LUA_getEntityPositionVector);
+	LuaWrapper::createSystemFunction(L, "LumixAPI", "getEntityLocalPositionVector", &LUA_getEntityLocalPositionVector);
+	LuaWrapper::createSystemFunction(L, "LumixAPI", "getEntityScaleVector", &LUA_getEntityScaleVector);
+	LuaWrapper::createSystemFunction(L, "LumixAPI", "getEntityPositions", &LUA_getEntityPositions);
+	LuaWrapper::createSystemFunction(L, "LumixAPI", "getEntityRotations", &LUA_getEntityRotations);
+	LuaWrapper::createSystemFunction(L, "LumixAPI", "setEntityTransforms", &LUA_setEntityTransforms);
+	LuaWrapper::createSystemFunction(L, "LumixAPI", "getComponentProperties", &LUA_getComponentProperties);
+	LuaWrapper::createSystemFunction(L, "LumixAPI", "setComponentProperties", &LUA_setComponentProperties);
+	registerVectorAPI(L);
 	LuaWrapper::createSystemFunction(L, "LumixAPI", "resourceTypeFromString", &LUA_resourceTypeFromString);
 	LuaWrapper::createSystemFunction(L, "LumixAPI", "beginProfilerBlock", LuaWrapper::wrap<&profiler::endBlock>);
 	LuaWrapper::createSystemFunction(L, "LumixAPI", "endProfilerBlock", LuaWrapper::wrap<&profiler::beginBlock>);
@@ -1134,69 +1692,37 @@ void registerEngineAPI(lua_State* L, Engine* engine) {
 		function Lumix.Entity:hasComponent(cmp)
 			return LumixAPI.hasComponent(self._world, self._entity, cmp)
 		end
-		Lumix.Entity.__index = function(table, key)
-			if key == "position" then
-				return LumixAPI.getEntityPosition(table._world, table._entity)
-			elseif key == "local_position" then
-				return LumixAPI.getEntityLocalPosition(table._world, table._entity)
-			elseif key == "parent" then
-				local p = LumixAPI.getParent(table._world, table._entity)
-				if p < 0 then return nil end
-				return Lumix.Entity:new(table._world, p)
-			elseif key == "first_child" then
-				local p = LumixAPI.getFirstChild(table._world, table._entity)
-				if p < 0 then return nil end
-				return Lumix.Entity:new(table._world, p)
-			elseif key == "next_sibling" then
-				local p = LumixAPI.getNextSibling(table._world, table._entity)
-				if p < 0 then return nil end
-				return Lumix.Entity:new(table._world, p)
-			elseif key == "rotation" then
-				return LumixAPI.getEntityRotation(table._world, table._entity)
-			elseif key == "name" then
-				return LumixAPI.getEntityName(table._world, table._entity)
-			elseif key == "scale" then
-				return LumixAPI.getEntityScale(table._world, table._entity)
-			elseif key == "world" then
-				return Lumix.World:new(table._world)
-			elseif key == "_world" or key == "_entity" then
-				return rawget(table, key)
-			elseif Lumix.Entity[key] ~= nil then
-				return Lumix.Entity[key]
-			else 
-				if LumixAPI.hasComponent(table._world, table._entity, key) then
-					return Lumix[key]:new(table._world, table._entity)
-				else
-					return nil
-				end
+		local function entityIndexFallback(table, key)
+			if not LumixAPI.hasComponent(table._world, table._entity, key) then return nil end
+			-- component proxies are created once per entity object and reused
+			local components = rawget(table, "_components")
+			if components == nil then
+				components = {}
+				rawset(table, "_components", components)
 			end
+			local cmp = components[key]
+			if cmp == nil then
+				cmp = Lumix[key]:new(table._world, table._entity)
+				components[key] = cmp
+			end
+			return cmp
 		end
-		Lumix.Entity.INVALID = Lumix.Entity:new(nil, -1)
-		Lumix.Entity.NULL = Lumix.Entity.INVALID
-
-		Lumix.Entity.__eq = function(a, b)
-			return a._entity == b._entity and a._world == b._world
-		end
-
-		Lumix.Entity.__newindex = function(table, key, value)
-			if key == "position" then
-				LumixAPI.setEntityPosition(table._world, table._entity, value)
-			elseif key == "local_position" then
-				LumixAPI.setEntityLocalPosition(table._world, table._entity, value)
-			elseif key == "name" then
-				LumixAPI.setEntityName(table._world, table._entity, value)
-			elseif key == "rotation" then
-				LumixAPI.setEntityRotation(table._world, table._entity, value)
-			elseif key == "scale" then
-				LumixAPI.setEntityScale(table._world, table._entity, value)
-			elseif key == "parent" then
-				LumixAPI.setParent(table._world, value._entity, table._entity)
-			elseif Lumix.Entity[key] ~= nil then
+		local function entityNewIndexFallback(table, key, value)
+			if Lumix.Entity[key] ~= nil then
 				Lumix.Entity[key] = value
 			else
 				error("key " .. tostring(key) .. " not found")
 			end
 		end
+	)#";
+
+	const char* world_src = R"#(
+		entity_getters.world = function(e) return Lumix.World:new(e._world) end
+		entity_getters._components = function(e) return rawget(e, "_components") end
+		entity_setters.local_position = function(e, v) LumixAPI.setEntityLocalPosition(e._world, e._entity, v) end
+		entity_setters.vlocal_position = function(e, v) LumixAPI.setEntityLocalPosition(e._world, e._entity, v) end
+		entity_setters.name = function(e, v) LumixAPI.setEntityName(e._world, e._entity, v) end
+		entity_setters.parent = function(e, v) LumixAPI.setParent(e._world, v._entity, e._entity) end
 
 		Lumix.World = {}
 		function Lumix.World:create() 
@@ -1335,7 +1861,7 @@ void registerEngineAPI(lua_State* L, Engine* engine) {
 
 	#define TO_STR_HELPER(x) #x
 	#define TO_STR(x) TO_STR_HELPER(x)
-	if (!LuaWrapper::execute(L, entity_src, __FILE__ "(" TO_STR(__LINE__) ")", 0)) {
+	if (!executeEntitySource(L, *engine, entity_src, world_src, __FILE__ "(" TO_STR(__LINE__) ")")) {
 		logError("Failed to init entity api");
 	}
 
@@ -1345,9 +1871,75 @@ void registerEngineAPI(lua_State* L, Engine* engine) {
 	lua_getfield(L, -1, "physics");
 	lua_pushcfunction(L, LUA_raycastEx, "raycastEx");
 	lua_setfield(L, -2, "raycastEx");
+	lua_pushcfunction(L, LUA_raycastBatch, "raycastBatch");
+	lua_setfield(L, -2, "raycastBatch");
+	lua_pushcfunction(L, LUA_sweepSphereBatch, "sweepSphereBatch");
+	lua_setfield(L, -2, "sweepSphereBatch");
+	lua_pushcfunction(L, LUA_overlapSphereBatch, "overlapSphereBatch");
+	lua_setfield(L, -2, "overlapSphereBatch");
 	lua_pop(L, 2);
 }
 
+// API of states running isolated scripts in parallel, it can only read world transforms and hierarchy,
+// module getters are not thread-safe
+// world mutations (LumixAPI.setEntityPosition, ...) are registered by the script system, which defers them
+void registerIsolatedAPI(lua_State* L, Engine* engine) {
+	LuaWrapper::DebugGuard guard(L);
+
+	#define REGISTER_FUNCTION(name) \
+		LuaWrapper::createSystemFunction(L, "LumixAPI", #name, \
+			&LuaWrapper::wrap<LUA_##name>); \
+
+	REGISTER_FUNCTION(hasComponent);
+	REGISTER_FUNCTION(getEntityName);
+	REGISTER_FUNCTION(getEntityLocalPosition);
+	REGISTER_FUNCTION(getEntityPosition);
+	REGISTER_FUNCTION(getEntityRotation);
+	REGISTER_FUNCTION(getEntityScale);
+	REGISTER_FUNCTION(getFirstChild);
+	REGISTER_FUNCTION(getNextSibling);
+	REGISTER_FUNCTION(getParent);
+	REGISTER_FUNCTION(logError);
+	REGISTER_FUNCTION(logInfo);
+
+	#undef REGISTER_FUNCTION
+
+	LuaWrapper::createSystemFunction(L, "LumixAPI", "getEntityPositionVector", &LUA_getEntityPositionVector);
+	LuaWrapper::createSystemFunction(L, "LumixAPI", "getEntityLocalPositionVector", &LUA_getEntityLocalPositionVector);
+	LuaWrapper::createSystemFunction(L, "LumixAPI", "getEntityScaleVector", &LUA_getEntityScaleVector);
+	LuaWrapper::createSystemFunction(L, "LumixAPI", "getEntityPositions", &LUA_getEntityPositions);
+	LuaWrapper::createSystemFunction(L, "LumixAPI", "getEntityRotations", &LUA_getEntityRotations);
+	registerVectorAPI(L);
+
+	const char* entity_src = R"#(
+		Lumix = {}
+		Lumix.Resource = {}
+		Lumix.Entity = {}
+		function Lumix.Entity:new(world, entity)
+			local e = { _entity = entity, _world = world }
+			setmetatable(e, self)
+			return e
+		end
+		function Lumix.Entity:destroy()
+			LumixAPI.destroyEntity(self._world, self._entity)
+		end
+		function Lumix.Entity:hasComponent(cmp)
+			return LumixAPI.hasComponent(self._world, self._entity, cmp)
+		end
+		local function entityIndexFallback(table, key)
+			error("key " .. tostring(key) .. " not found, components are not accessible in isolated scripts")
+		end
+		-- setters of the shared accessors are deferred, they are applied when all isolated scripts are updated
+		local function entityNewIndexFallback(table, key, value)
+			error("key " .. tostring(key) .. " not found or not writable in isolated scripts")
+		end
+	)#";
+
+	if (!executeEntitySource(L, *engine, entity_src, "", __FILE__ "(" TO_STR(__LINE__) ")")) {
+		logError("Failed to init isolated entity api");
+	}
+}
+
 static struct {
 	IModule* module;
 	EntityRef entity;
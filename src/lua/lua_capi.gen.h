@@ -878,6 +878,7 @@ namespace Lumix {
 			case /*max_climb*/18440467892564879558: LuaWrapper::push(L, module->getZone(entity).max_climb); break;
 			case /*autoload*/12820653450790247776: LuaWrapper::push(L, module->getZoneAutoload(entity)); break;
 			case /*detailed*/3305050883106733620: LuaWrapper::push(L, module->getZoneDetailed(entity)); break;
+			case /*streamed*/16358247141141348589: LuaWrapper::push(L, module->getZoneStreamed(entity)); break;
 			case /*load*/15165270708108832870: lua_pushcfunction(L, Zone_load, "Zone_load"); break;
 			case /*drawNavmesh*/2652037676279031843: lua_pushcfunction(L, Zone_drawNavmesh, "Zone_drawNavmesh"); break;
 			case /*drawCompactHeightfield*/13172685102570950854: lua_pushcfunction(L, Zone_drawCompactHeightfield, "Zone_drawCompactHeightfield"); break;
@@ -906,6 +907,7 @@ namespace Lumix {
 			case /*max_climb*/18440467892564879558: module->getZone(entity).max_climb = LuaWrapper::checkArg<float>(L, 3); break;
 			case /*autoload*/12820653450790247776: module->setZoneAutoload(entity, LuaWrapper::checkArg<bool>(L, 3)); break;
 			case /*detailed*/3305050883106733620: module->setZoneDetailed(entity, LuaWrapper::checkArg<bool>(L, 3)); break;
+			case /*streamed*/16358247141141348589: module->setZoneStreamed(entity, LuaWrapper::checkArg<bool>(L, 3)); break;
 			case 0:
 			default: luaL_error(L, "Unknown property %s", prop_name); break;
 		}
@@ -2,6 +2,7 @@
 #include "core/array.h"
 #include "core/associative_array.h"
 #include "core/hash.h"
+#include "core/job_system.h"
 #include "core/log.h"
 #include "core/metaprogramming.h"
 #include "core/os.h"
@@ -122,6 +123,63 @@ struct LuaScriptManager final : ResourceManager
 };
 
 void registerEngineAPI(lua_State* L, Engine* engine);
+struct LuaScriptSystemImpl;
+void registerIsolatedAPI(lua_State* L, Engine* engine);
+
+// world mutation recorded by an isolated script, applied on the main thread
+struct LuaCommand {
+	enum Type : u8 {
+		SET_POSITION,
+		SET_ROTATION,
+		SET_SCALE,
+		DESTROY_ENTITY
+	};
+
+	Type type;
+	EntityRef entity;
+	DVec3 pos;
+	Quat rot;
+	Vec3 scale;
+};
+
+// passed to luaAlloc as userdata, each state has its own
+struct LuaHeap {
+	LuaScriptSystemImpl* system = nullptr;
+	// bytes allocated since the last GC step
+	u64 allocated = 0;
+	// GC work (in KB) which did not fit in the budget, it's done in the next frames
+	i64 gc_debt_kb = 0;
+};
+
+// independent state for scripts marked with `--!isolated`, isolated states are updated in parallel
+// scripts in them can only read the world, writes are recorded as commands in the target world's module
+// components (`this.<component>`) are not accessible and `require`/`dofile` can not be called from update
+struct IsolatedLuaState {
+	IsolatedLuaState(LuaScriptSystemImpl& system, u32 index)
+		: system(system)
+		, index(index)
+	{}
+
+	LuaScriptSystemImpl& system;
+	u32 index;
+	lua_State* L = nullptr;
+	LuaHeap heap;
+};
+
+// `--!isolated` in the leading comment lines, same as Luau's `--!strict`
+static bool isIsolatedScript(StringView src) {
+	const char* c = src.begin;
+	while (startsWith(StringView(c, src.end), "--!")) {
+		const char* line_end = c;
+		while (line_end != src.end && *line_end != '\n') ++line_end;
+		StringView directive(c + 3, line_end);
+		while (directive.size() > 0 && (directive.back() == '\r' || directive.back() == ' ')) directive.removeSuffix(1);
+		if (equalStrings(directive, "isolated")) return true;
+		if (line_end == src.end) break;
+		c = line_end + 1;
+	}
+	return false;
+}
 
 
 struct LuaScriptSystemImpl final : LuaScriptSystem
@@ -142,8 +200,110 @@ struct LuaScriptSystemImpl final : LuaScriptSystem
 	lua_State* getState() override { return m_state; }
 
 	void update(float dt) override {
+		collectGarbage();
+		pushGCCounters();
+	}
+
+	void pushGCCounters() {
 		static u32 lua_mem_counter = profiler::createCounter("Lua Memory (KB)", 0);
-		profiler::pushCounter(lua_mem_counter, float(double(m_lua_allocated) / 1024.0));
+		static u32 lua_gc_counter = profiler::createCounter("Lua GC (ms)", 0);
+		profiler::pushCounter(lua_mem_counter, float(double(getHeapSize()) / 1024.0));
+		profiler::pushCounter(lua_gc_counter, m_last_gc_time);
+	}
+
+	static u64 getHeapSize(lua_State* L) {
+		return u64(lua_gc(L, LUA_GCCOUNT, 0)) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+	}
+
+	u64 getHeapSize() override {
+		u64 size = getHeapSize(m_state);
+		for (IsolatedLuaState* state : m_isolated_states) size += getHeapSize(state->L);
+		return size;
+	}
+
+	// if a state owes more GC work than this, its steps ignore the budget, so the heap can not grow without limit
+	static constexpr i64 MAX_GC_DEBT_KB = 16 * 1024;
+
+	// automatic GC is stopped, so there are no GC assists (collection triggered by an allocation in the middle of a script),
+	// the collector is paced only by these steps, work is proportional to bytes allocated since the last step
+	static void stepGC(lua_State* L, LuaHeap& heap, u64 deadline) {
+		// collector must be faster than allocations to catch up, 2x is the default step multiplier
+		heap.gc_debt_kb += i64(heap.allocated >> 10) * 2;
+		heap.allocated = 0;
+		while (heap.gc_debt_kb > 0 && (heap.gc_debt_kb > MAX_GC_DEBT_KB || os::Timer::getRawTimestamp() < deadline)) {
+			const i32 step_kb = (i32)minimum(heap.gc_debt_kb, (i64)64);
+			heap.gc_debt_kb -= step_kb;
+			// returns 1 when the cycle is finished
+			if (lua_gc(L, LUA_GCSTEP, step_kb)) {
+				heap.gc_debt_kb = 0;
+				break;
+			}
+		}
+		// explicit step sets a new GC threshold, i.e. it restarts automatic GC
+		lua_gc(L, LUA_GCSTOP, 0);
+	}
+
+	// budget is split evenly between states, time not used by a state is given to the following ones
+	void collectGarbage() {
+		PROFILE_FUNCTION();
+		const u64 start = os::Timer::getRawTimestamp();
+		const u64 end = start + u64(m_gc_budget_ms * os::Timer::getFrequency() / 1000.0);
+		const u32 count = m_isolated_states.size() + 1;
+		u64 now = start;
+		for (u32 i = 0; i < count; ++i) {
+			const u64 deadline = now < end ? now + (end - now) / (count - i) : now;
+			if (i == 0) stepGC(m_state, m_heap, deadline);
+			else stepGC(m_isolated_states[i - 1]->L, m_isolated_states[i - 1]->heap, deadline);
+			now = os::Timer::getRawTimestamp();
+		}
+		m_last_gc_time = float((now - start) * 1000.0 / os::Timer::getFrequency());
+	}
+
+	void setGCBudget(float ms) override { m_gc_budget_ms = ms; }
+	float getGCBudget() const override { return m_gc_budget_ms; }
+	float getLastGCTime() const override { return m_last_gc_time; }
+
+	static constexpr u8 INLINE_SCRIPTS_MEMORY_CATEGORY = 1;
+
+	// see lua_setmemcat, scripts over the limit of categories fall back to 0
+	u8 getMemoryCategory(const Path& path) {
+		auto iter = m_memory_categories.find(path.getHash());
+		if (iter.isValid()) return iter.value();
+		if (m_memory_category_names.size() >= LUA_MEMORY_CATEGORIES) return 0;
+		const u8 category = (u8)m_memory_category_names.size();
+		m_memory_category_names.emplace(path.c_str(), m_allocator);
+		m_memory_categories.insert(path.getHash(), category);
+		return category;
+	}
+
+	u32 getMemoryCategoriesCount() const override { return m_memory_category_names.size(); }
+	const char* getMemoryCategoryName(u32 category) const override { return m_memory_category_names[category].c_str(); }
+
+	u64 getMemoryCategorySize(u32 category) override {
+		u64 size = lua_totalbytes(m_state, category);
+		for (IsolatedLuaState* state : m_isolated_states) size += lua_totalbytes(state->L, category);
+		return size;
+	}
+
+	void createIsolatedStates();
+
+	// fixed count, not one per worker, so scripts share the same state and their commands are applied in the same order
+	// on every machine; states are updated by as many workers as there are
+	static constexpr u32 ISOLATED_STATES_COUNT = 16;
+
+	// scripts are assigned by entity, so the order of their commands is deterministic
+	lua_State* getIsolatedState(EntityRef entity) {
+		if (m_isolated_states.empty()) createIsolatedStates();
+		return m_isolated_states[entity.index % m_isolated_states.size()]->L;
+	}
+
+	// -1 for the main state
+	i32 getIsolatedStateIndex(lua_State* L) const {
+		lua_State* main_thread = lua_mainthread(L);
+		for (i32 i = 0; i < m_isolated_states.size(); ++i) {
+			if (m_isolated_states[i]->L == main_thread) return i;
+		}
+		return -1;
 	}
 
 	void unloadLuaResource(LuaResourceHandle resource) override
@@ -177,9 +337,16 @@ struct LuaScriptSystemImpl final : LuaScriptSystem
 	lua_State* m_state;
 	Engine& m_engine;
 	LuaScriptManager m_script_manager;
-	size_t m_lua_allocated = 0;
 	HashMap<int, Resource*> m_lua_resources;
 	u32 m_last_lua_resource_idx = -1;
+	Array<IsolatedLuaState*> m_isolated_states;
+	// isolated states are being updated in parallel
+	bool m_isolated_updates_running = false;
+	float m_gc_budget_ms = 0.5f;
+	float m_last_gc_time = 0;
+	LuaHeap m_heap;
+	HashMap<FilePathHash, u8> m_memory_categories;
+	Array<String> m_memory_category_names;
 };
 
 
@@ -190,9 +357,12 @@ struct LuaScriptModuleImpl final : LuaScriptModule {
 		int func;
 	};
 
+	// function resolved once, when the script starts or is reloaded
 	struct CallbackData {
 		lua_State* state;
-		int environment;
+		int func;
+		// shown in profiler
+		const char* name;
 	};
 
 	struct ScriptComponent;
@@ -215,8 +385,13 @@ struct LuaScriptModuleImpl final : LuaScriptModule {
 			: m_properties(allocator)
 			, m_cmp(&cmp)
 		{
-			LuaScriptModuleImpl& module = cmp.m_module;
-			lua_State* L = module.m_system.m_state;
+			createEnvironment(cmp.m_module.m_system.m_state);
+			m_flags = Flags(m_flags | ENABLED);
+		}
+
+		// `L` is the main state or one of the isolated states
+		void createEnvironment(lua_State* L) {
+			LuaScriptModuleImpl& module = m_cmp->m_module;
 			LuaWrapper::DebugGuard guard(L);
 			m_state = lua_newthread(L);
 			m_thread_ref = LuaWrapper::createRef(L);
@@ -238,13 +413,16 @@ struct LuaScriptModuleImpl final : LuaScriptModule {
 			lua_pushvalue(m_state, -2); // [env, Lumix.Entity, Entity.new, Lumix.Entity]
 			lua_remove(m_state, -3); // [env, Entity.new, Lumix.Entity]
 			LuaWrapper::push(m_state, &module.m_world); // [env, Entity.new, Lumix.Entity, world]
-			LuaWrapper::push(m_state, cmp.m_entity.index); // [env, Entity.new, Lumix.Entity, world, entity_index]
+			LuaWrapper::push(m_state, m_cmp->m_entity.index); // [env, Entity.new, Lumix.Entity, world, entity_index]
 			const bool error = !LuaWrapper::pcall(m_state, 3, 1); // [env, entity]
 			ASSERT(!error);
 			lua_setfield(m_state, -2, "this"); // [env]
 			lua_pop(m_state, 1); // []
+		}
 
-			m_flags = Flags(m_flags | ENABLED);
+		void releaseEnvironment() {
+			LuaWrapper::releaseRef(lua_mainthread(m_state), m_thread_ref);
+			LuaWrapper::releaseRef(m_state, m_environment);
 		}
 
 		ScriptInstance(const ScriptInstance&) = delete;
@@ -296,10 +474,7 @@ struct LuaScriptModuleImpl final : LuaScriptModule {
 				}
 
 				m_cmp->m_module.disableScript(*this);
-
-				lua_State* L = m_cmp->m_module.m_system.m_state;
-				LuaWrapper::releaseRef(L, m_thread_ref);
-				LuaWrapper::releaseRef(m_state, m_environment);
+				releaseEnvironment();
 			}
 		}
 
@@ -320,6 +495,7 @@ struct LuaScriptModuleImpl final : LuaScriptModule {
 		{
 			lua_State* L = module.m_system.m_state;
 			m_state = lua_newthread(L);
+			lua_setmemcat(m_state, LuaScriptSystemImpl::INLINE_SCRIPTS_MEMORY_CATEGORY);
 			m_thread_ref = LuaWrapper::createRef(L);
 			lua_pop(L, 1); // []
 			lua_newtable(m_state);						   // [env]
@@ -630,6 +806,8 @@ struct LuaScriptModuleImpl final : LuaScriptModule {
 		, m_scripts(system.m_allocator)
 		, m_inline_scripts(system.m_allocator)
 		, m_updates(system.m_allocator)
+		, m_isolated_updates(system.m_allocator)
+		, m_isolated_commands(system.m_allocator)
 		, m_input_handlers(system.m_allocator)
 		, m_timers(system.m_allocator)
 		, m_property_names(system.m_allocator)
@@ -638,6 +816,8 @@ struct LuaScriptModuleImpl final : LuaScriptModule {
 		, m_to_start(system.m_allocator)
 	{
 		m_function_call.is_in_progress = false;
+		// one buffer per isolated state, so states running in parallel never write to the same array
+		for (u32 i = 0; i < LuaScriptSystemImpl::ISOLATED_STATES_COUNT; ++i) m_isolated_commands.emplace(system.m_allocator);
 		registerAPI();
 	}
 
@@ -867,29 +1047,7 @@ struct LuaScriptModuleImpl final : LuaScriptModule {
 		}
 
 		const ScriptInstance& instance = module->m_scripts[entity]->m_scripts[scr_index];
-		LuaWrapper::DebugGuard guard(instance.m_state);
-		lua_rawgeti(instance.m_state, LUA_REGISTRYINDEX, instance.m_environment);
-		if (lua_type(instance.m_state, -1) != LUA_TTABLE) {
-			ASSERT(false);
-			lua_pop(instance.m_state, 1);
-			return 0;
-		}
-		lua_getfield(instance.m_state, -1, "update");
-		if (lua_type(instance.m_state, -1) == LUA_TFUNCTION) {
-			auto& update_data = module->m_updates.emplace();
-			update_data.state = instance.m_state;
-			update_data.environment = instance.m_environment;
-		}
-		lua_pop(instance.m_state, 1);
-		lua_getfield(instance.m_state, -1, "onInputEvent");
-		if (lua_type(instance.m_state, -1) == LUA_TFUNCTION) {
-			auto& callback = module->m_input_handlers.emplace();
-			callback.state = instance.m_state;
-			callback.environment = instance.m_environment;
-		}
-		lua_pop(instance.m_state, 1);
-		lua_pop(instance.m_state, 1);
-
+		module->registerCallbacks(instance, instance.m_script ? instance.m_script->getPath().c_str() : "lua update");
 		return 0;
 	}
 		
@@ -1072,26 +1230,98 @@ struct LuaScriptModuleImpl final : LuaScriptModule {
 			}
 		}
 
-		for (int i = 0; i < m_updates.size(); ++i)
-		{
-			if (m_updates[i].state == inst.m_state)
-			{
-				m_updates.swapAndPop(i);
-				break;
+		unregisterCallbacks(inst.m_state);
+	}
+
+
+	static void unregisterCallback(Array<CallbackData>& callbacks, lua_State* state) {
+		for (i32 i = 0; i < callbacks.size(); ++i) {
+			if (callbacks[i].state == state) {
+				LuaWrapper::releaseRef(state, callbacks[i].func);
+				callbacks.swapAndPop(i);
+				return;
 			}
 		}
+	}
 
-		for (int i = 0; i < m_input_handlers.size(); ++i)
-		{
-			if (m_input_handlers[i].state == inst.m_state)
-			{
-				m_input_handlers.swapAndPop(i);
-				break;
-			}
+
+	void unregisterCallbacks(lua_State* state) {
+		unregisterCallback(getUpdates(state), state);
+		unregisterCallback(m_input_handlers, state);
+	}
+
+
+	// updates of isolated scripts are grouped by their state, each group is updated by one job
+	Array<CallbackData>& getUpdates(lua_State* state) {
+		const i32 idx = m_system.getIsolatedStateIndex(state);
+		if (idx < 0) return m_updates;
+		while (m_isolated_updates.size() <= idx) m_isolated_updates.emplace(m_system.m_allocator);
+		return m_isolated_updates[idx];
+	}
+
+
+	// keeps a reference to the function, so it does not need to be looked up in the environment every call
+	static void registerCallback(Array<CallbackData>& callbacks, lua_State* state, const char* func_name, const char* name) {
+		lua_getfield(state, -1, func_name); // [env, func]
+		if (lua_type(state, -1) != LUA_TFUNCTION) {
+			lua_pop(state, 1); // [env]
+			return;
+		}
+		CallbackData& cb = callbacks.emplace();
+		cb.state = state;
+		cb.func = LuaWrapper::createRef(state); // [env, func]
+		cb.name = name;
+		lua_pop(state, 1); // [env]
+	}
+
+
+	// must be called again if the script is reloaded, since cached functions would be stale
+	void registerCallbacks(const ScriptEnvironment& instance, const char* name) {
+		if (!instance.m_state) return;
+		LuaWrapper::DebugGuard guard(instance.m_state);
+		unregisterCallbacks(instance.m_state);
+		lua_rawgeti(instance.m_state, LUA_REGISTRYINDEX, instance.m_environment); // [env]
+		if (lua_type(instance.m_state, -1) != LUA_TTABLE) {
+			ASSERT(false);
+			lua_pop(instance.m_state, 1);
+			return;
 		}
+		registerCallback(getUpdates(instance.m_state), instance.m_state, "update", name);
+		registerCallback(m_input_handlers, instance.m_state, "onInputEvent", name);
+		lua_pop(instance.m_state, 1); // []
 	}
 
 
+	void releaseCallbacks() {
+		for (const CallbackData& cb : m_updates) LuaWrapper::releaseRef(cb.state, cb.func);
+		for (const CallbackData& cb : m_input_handlers) LuaWrapper::releaseRef(cb.state, cb.func);
+		for (const TimerData& timer : m_timers) LuaWrapper::releaseRef(timer.state, timer.func);
+		for (Array<CallbackData>& updates : m_isolated_updates) {
+			for (const CallbackData& cb : updates) LuaWrapper::releaseRef(cb.state, cb.func);
+			updates.clear();
+		}
+		m_updates.clear();
+		m_input_handlers.clear();
+		m_timers.clear();
+	}
+
+
+	// recreates the environment of the script in another state (main or isolated)
+	void changeScriptState(ScriptInstance& inst, lua_State* L) {
+		if (inst.m_flags & ScriptInstance::LOADED) {
+			// current values are applied to the new environment when the script is loaded
+			for (Property& prop : inst.m_properties) {
+				auto iter = m_property_names.find(prop.name_hash);
+				if (!iter.isValid() || prop.type == Property::ANY) continue;
+				prop.stored_value.clear();
+				serializePropertyValue(prop, iter.value().c_str(), inst, prop.stored_value);
+			}
+		}
+		disableScript(inst);
+		inst.releaseEnvironment();
+		inst.createEnvironment(L);
+	}
+
 	void setPath(ScriptComponent& cmp, ScriptInstance& inst, const Path& path)
 	{
 		registerAPI();
@@ -1109,20 +1339,21 @@ struct LuaScriptModuleImpl final : LuaScriptModule {
 
 	void startScript(EntityRef entity, InlineScriptComponent& instance, bool is_reload) {
 		instance.runSource();
-		startScriptInternal(entity, instance, is_reload);
+		startScriptInternal(entity, instance, is_reload, "inline script");
 	}
 
 	void startScript(EntityRef entity, ScriptInstance& instance, bool is_reload) {
 		if (!(instance.m_flags & ScriptInstance::ENABLED)) return;
 			
 		if (is_reload) disableScript(instance);
-		startScriptInternal(entity, instance, is_reload);
+		startScriptInternal(entity, instance, is_reload, instance.m_script ? instance.m_script->getPath().c_str() : "lua script");
 	}
 
-	void startScriptInternal(EntityRef entity, ScriptEnvironment& instance, bool is_reload)
+	void startScriptInternal(EntityRef entity, ScriptEnvironment& instance, bool is_reload, const char* name)
 	{
 		if (!instance.m_state) return;
 			
+		registerCallbacks(instance, name);
 		lua_rawgeti(instance.m_state, LUA_REGISTRYINDEX, instance.m_environment);
 		if (lua_type(instance.m_state, -1) != LUA_TTABLE)
 		{
@@ -1130,22 +1361,6 @@ struct LuaScriptModuleImpl final : LuaScriptModule {
 			lua_pop(instance.m_state, 1);
 			return;
 		}
-		lua_getfield(instance.m_state, -1, "update");
-		if (lua_type(instance.m_state, -1) == LUA_TFUNCTION)
-		{
-			auto& update_data = m_updates.emplace();
-			update_data.state = instance.m_state;
-			update_data.environment = instance.m_environment;
-		}
-		lua_pop(instance.m_state, 1);
-		lua_getfield(instance.m_state, -1, "onInputEvent");
-		if (lua_type(instance.m_state, -1) == LUA_TFUNCTION)
-		{
-			auto& callback = m_input_handlers.emplace();
-			callback.state = instance.m_state;
-			callback.environment = instance.m_environment;
-		}
-		lua_pop(instance.m_state, 1);
 
 		if (!is_reload) {
 			lua_getfield(instance.m_state, -1, "start");
@@ -1228,9 +1443,8 @@ struct LuaScriptModuleImpl final : LuaScriptModule {
 		}
 		m_gui_module = nullptr;
 		m_is_game_running = false;
-		m_updates.clear();
-		m_input_handlers.clear();
-		m_timers.clear();
+		for (Array<LuaCommand>& commands : m_isolated_commands) commands.clear();
+		releaseCallbacks();
 	}
 
 	void createInlineScript(EntityRef entity) override {
@@ -1568,9 +1782,8 @@ struct LuaScriptModuleImpl final : LuaScriptModule {
 		}
 	}
 
-	void processInputEvent(const CallbackData& callback, const InputSystem::Event& event)
+	static void pushInputEvent(lua_State* L, const InputSystem::Event& event)
 	{
-		lua_State* L = callback.state;
 		lua_newtable(L); // [lua_event]
 		LuaWrapper::push(L, toString(event.type)); // [lua_event, event.type]
 		lua_setfield(L, -2, "type"); // [lua_event]
@@ -1624,39 +1837,75 @@ struct LuaScriptModuleImpl final : LuaScriptModule {
 				lua_setfield(L, -2, "text"); // [lua_event]
 				break;
 		}
-
-
-		lua_rawgeti(L, LUA_REGISTRYINDEX, callback.environment);
-		if (lua_type(L, -1) != LUA_TTABLE) // [lua_event, environment]
-		{
-			ASSERT(false);
-		}
-		lua_getfield(L, -1, "onInputEvent");
-		if (lua_type(L, -1) != LUA_TFUNCTION)  // [lua_event, environment, func]
-		{
-			lua_pop(L, 3); // []
-			return;
-		}
-
-		lua_pushvalue(L, -3); // [lua_event, environment, func, lua_event]
-			
-		LuaWrapper::pcall(L, 1, 0); // [lua_event, environment]
-		lua_pop(L, 2); // []
 	}
 
 
 	void processInputEvents() {
 		if (m_input_handlers.empty()) return;
 
+		PROFILE_FUNCTION();
 		InputSystem& input_system = m_system.m_engine.getInputSystem();
 		Span<const InputSystem::Event> events = input_system.getEvents();
+		lua_State* L = m_system.m_state;
 		for (const InputSystem::Event& e : events) {
-			for (const CallbackData& cb : m_input_handlers) {
-				processInputEvent(cb, e);
+			// all handlers get the same event table
+			pushInputEvent(L, e); // [lua_event]
+			// handlers can be (un)registered by the callbacks
+			for (i32 i = 0; i < m_input_handlers.size(); ++i) {
+				const CallbackData cb = m_input_handlers[i];
+				lua_rawgeti(cb.state, LUA_REGISTRYINDEX, cb.func); // [func]
+				// isolated states can not share the event table
+				if (lua_mainthread(cb.state) == L) lua_xpush(L, cb.state, -1); // [func, lua_event]
+				else pushInputEvent(cb.state, e); // [func, lua_event]
+				LuaWrapper::pcall(cb.state, 1, 0); // []
+			}
+			lua_pop(L, 1); // []
+		}
+	}
+
+
+	// isolated scripts can only read the world while they run in parallel
+	void updateIsolatedScripts(float time_delta) {
+		if (m_isolated_updates.empty()) return;
+
+		PROFILE_FUNCTION();
+		m_system.m_isolated_updates_running = true;
+		jobs::forEach(m_isolated_updates.size(), 1, [&](i32 state_idx, i32){
+			PROFILE_BLOCK("isolated lua updates");
+			for (const CallbackData& update_item : m_isolated_updates[state_idx]) {
+				PROFILE_BLOCK("lua update");
+				profiler::pushString(update_item.name);
+				lua_rawgeti(update_item.state, LUA_REGISTRYINDEX, update_item.func); // [func]
+				lua_pushnumber(update_item.state, time_delta); // [func, time_delta]
+				LuaWrapper::pcall(update_item.state, 1, 0); // []
 			}
+		});
+		m_system.m_isolated_updates_running = false;
+	}
+
+	// sync point, commands are applied in the order of states and then in the order they were recorded
+	void applyIsolatedCommands() {
+		for (Array<LuaCommand>& commands : m_isolated_commands) {
+			for (const LuaCommand& cmd : commands) {
+				if (!m_world.hasEntity(cmd.entity)) continue;
+				switch (cmd.type) {
+					case LuaCommand::SET_POSITION: m_world.setPosition(cmd.entity, cmd.pos); break;
+					case LuaCommand::SET_ROTATION: m_world.setRotation(cmd.entity, cmd.rot); break;
+					case LuaCommand::SET_SCALE: m_world.setScale(cmd.entity, cmd.scale); break;
+					case LuaCommand::DESTROY_ENTITY: m_deferred_destructions.push(cmd.entity); break;
+				}
+			}
+			commands.clear();
 		}
 	}
 
+	// systems are not updated while the engine is paused, but the states still allocate (e.g. editor scripts),
+	// only modules of the updated world get endFrame, so garbage is collected once per frame
+	void endFrame() override {
+		if (!m_system.m_engine.isPaused()) return;
+		m_system.collectGarbage();
+		m_system.pushGCCounters();
+	}
 
 	void update(float time_delta) override {
 		PROFILE_FUNCTION();
@@ -1667,22 +1916,27 @@ struct LuaScriptModuleImpl final : LuaScriptModule {
 		processInputEvents();
 		updateTimers(time_delta);
 
-		for (int i = 0; i < m_updates.size(); ++i) {
-			CallbackData update_item = m_updates[i];
-			LuaWrapper::DebugGuard guard(update_item.state, 0);
-			lua_rawgeti(update_item.state, LUA_REGISTRYINDEX, update_item.environment);
-			if (lua_type(update_item.state, -1) != LUA_TTABLE) {
-				ASSERT(false);
-			}
-			lua_getfield(update_item.state, -1, "update");
-			if (lua_type(update_item.state, -1) != LUA_TFUNCTION) {
-				lua_pop(update_item.state, 2);
-				continue;
+		updateIsolatedScripts(time_delta);
+		applyIsolatedCommands();
+
+		{
+			PROFILE_BLOCK("lua updates");
+			const u64 start = os::Timer::getRawTimestamp();
+			const i32 count = m_updates.size();
+			// index based, since scripts can be (un)registered by the called functions
+			for (i32 i = 0; i < m_updates.size(); ++i) {
+				const CallbackData update_item = m_updates[i];
+				PROFILE_BLOCK("lua update");
+				profiler::pushString(update_item.name);
+				lua_rawgeti(update_item.state, LUA_REGISTRYINDEX, update_item.func); // [func]
+				lua_pushnumber(update_item.state, time_delta); // [func, time_delta]
+				LuaWrapper::pcall(update_item.state, 1, 0); // []
 			}
 
-			lua_pushnumber(update_item.state, time_delta);
-			LuaWrapper::pcall(update_item.state, 1, 0);
-			lua_pop(update_item.state, 1);
+			static u32 calls_counter = profiler::createCounter("Lua update calls", 0);
+			static u32 duration_counter = profiler::createCounter("Lua updates (ms)", 0);
+			profiler::pushCounter(calls_counter, float(count));
+			profiler::pushCounter(duration_counter, float((os::Timer::getRawTimestamp() - start) * 1000.0 / os::Timer::getFrequency()));
 		}
 
 		for (EntityRef e : m_deferred_destructions) {
@@ -1966,6 +2220,9 @@ struct LuaScriptModuleImpl final : LuaScriptModule {
 	World& m_world;
 	Array<DeferredStart> m_to_start;
 	Array<CallbackData> m_updates;
+	Array<Array<CallbackData>> m_isolated_updates;
+	// commands recorded by isolated states, indexed by IsolatedLuaState::index
+	Array<Array<LuaCommand>> m_isolated_commands;
 	Array<TimerData> m_timers;
 	FunctionCall m_function_call;
 	ScriptInstance* m_current_script_instance;
@@ -2004,6 +2261,12 @@ void LuaScriptModuleImpl::ScriptInstance::onScriptUnloaded(LuaScriptModuleImpl&
 }
 
 void LuaScriptModuleImpl::ScriptInstance::onScriptLoaded(LuaScriptModuleImpl& module, struct ScriptComponent& cmp, int scr_index) {
+	// scripts declare whether they are isolated, so the state is known only now
+	lua_State* L = isIsolatedScript(m_script->getSourceCode()) ? module.m_system.getIsolatedState(cmp.m_entity) : module.m_system.m_state;
+	if (lua_mainthread(m_state) != L) module.changeScriptState(*this, L);
+	// everything allocated by the script's thread from now on is attributed to the script
+	lua_setmemcat(m_state, module.m_system.getMemoryCategory(m_script->getPath()));
+
 	LuaWrapper::DebugGuard guard(m_state);
 		
 	bool is_reload = m_flags & LOADED;
@@ -2099,7 +2362,7 @@ static int LUA_inherit(lua_State* L) {
 	return 0;
 }
 
-static int LUA_require(lua_State* L) {
+static int requireModule(lua_State* L, Engine* engine) {
 	const char* name = luaL_checkstring(L, 1);
 
 	luaL_findtable(L, LUA_REGISTRYINDEX, "_MODULES", 1);
@@ -2114,7 +2377,6 @@ static int LUA_require(lua_State* L) {
 
 	lua_pop(L, 1);
 
-	Engine* engine = LuaWrapper::getClosureObject<Engine>(L);
 	Path path(name, ".lua");
 	LuaScript* dep = engine->getResourceManager().load<LuaScript>(path);
 	if (!dep->isReady()) {
@@ -2171,11 +2433,10 @@ static int LUA_require(lua_State* L) {
 	return finishrequire(L);
 }
 
-static int LUA_dofile(lua_State* L) {
+static int doFile(lua_State* L, Engine* engine) {
 	LuaWrapper::DebugGuard guard(L, 1);
 	const char* name = luaL_checkstring(L, 1);
 
-	Engine* engine = LuaWrapper::getClosureObject<Engine>(L);
 	Path path(name, ".lua");
 	LuaScript* dep = engine->getResourceManager().load<LuaScript>(path);
 	if (!dep->isReady()) {
@@ -2225,37 +2486,49 @@ static int LUA_dofile(lua_State* L) {
 	return finishrequire(L);
 }
 
+static int LUA_require(lua_State* L) {
+	return requireModule(L, LuaWrapper::getClosureObject<Engine>(L));
+}
+
+static int LUA_dofile(lua_State* L) {
+	return doFile(L, LuaWrapper::getClosureObject<Engine>(L));
+}
+
+// loading a module touches the resource manager, which is not thread safe, so it's not possible in parallel updates
+static int LUA_isolatedRequire(lua_State* L) {
+	IsolatedLuaState* state = LuaWrapper::getClosureObject<IsolatedLuaState>(L);
+	if (state->system.m_isolated_updates_running) luaL_error(L, "require can not be called from update of isolated scripts");
+	return requireModule(L, &state->system.m_engine);
+}
+
+static int LUA_isolatedDofile(lua_State* L) {
+	IsolatedLuaState* state = LuaWrapper::getClosureObject<IsolatedLuaState>(L);
+	if (state->system.m_isolated_updates_running) luaL_error(L, "dofile can not be called from update of isolated scripts");
+	return doFile(L, &state->system.m_engine);
+}
+
+// used by all states, heap sizes are tracked by Luau, allocated bytes are counted here to pace the GC, see stepGC
 static void* luaAlloc(void* ud, void* ptr, size_t osize, size_t nsize) {
-	LuaScriptSystemImpl* system = (LuaScriptSystemImpl*)ud;
-	system->m_lua_allocated = system->m_lua_allocated + nsize - osize;
+	LuaHeap* heap = (LuaHeap*)ud;
+	LuaScriptSystemImpl* system = heap->system;
 	if (nsize == 0) {
 		if (osize > 0) system->m_lua_allocator.deallocate(ptr);
 		return nullptr;
 	}
 	if (!ptr) {
 		ASSERT(osize == 0);
+		heap->allocated += nsize;
 		return system->m_lua_allocator.allocate(nsize, 8);
 	}
 
 	ASSERT(osize > 0);
+	if (nsize > osize) heap->allocated += nsize - osize;
 	return system->m_lua_allocator.reallocate(ptr, nsize, osize, 8);
 }
 
-LuaScriptSystemImpl::LuaScriptSystemImpl(Engine& engine)
-	: m_engine(engine)
-	, m_allocator(engine.getAllocator(), "lua system")
-	, m_script_manager(m_allocator)
-	, m_lua_allocator(engine.getAllocator(), "luau")
-	, m_lua_resources(m_allocator)
-{
-	#ifdef _WIN32
-		m_state = lua_newstate(luaAlloc, this);
-	#else 
-		m_state = luaL_newstate();
-	#endif
-	luaL_openlibs(m_state);
-	
-	lua_State* L = m_state;
+static void registerGlobals(lua_State* L, Engine& engine) {
+	luaL_openlibs(L);
+
 	lua_pushlightuserdata(L, &engine);
 	lua_pushcclosure(L, &LUA_require, "require", 1);
 	lua_setglobal(L, "require");
@@ -2267,6 +2540,87 @@ LuaScriptSystemImpl::LuaScriptSystemImpl(Engine& engine)
 	lua_pushlightuserdata(L, &engine);
 	lua_pushcclosure(L, &LUA_dofile, "dofile", 1);
 	lua_setglobal(L, "dofile");
+}
+
+// commands for worlds without a running lua module are dropped, nothing would apply them
+static LuaCommand* pushCommand(lua_State* L, LuaCommand::Type type) {
+	IsolatedLuaState* state = LuaWrapper::getClosureObject<IsolatedLuaState>(L);
+	World* world = LuaWrapper::checkArg<World*>(L, 1);
+	const i32 entity = LuaWrapper::checkArg<i32>(L, 2);
+	if (entity < 0) luaL_argerror(L, 2, "Invalid entity");
+	auto* module = (LuaScriptModuleImpl*)world->getModule(types::lua_script);
+	if (!module || !module->m_is_game_running) return nullptr;
+	LuaCommand& cmd = module->m_isolated_commands[state->index].emplace();
+	cmd.type = type;
+	cmd.entity = EntityRef{entity};
+	return &cmd;
+}
+
+static int LUA_deferSetEntityPosition(lua_State* L) {
+	const DVec3 pos = LuaWrapper::checkArg<DVec3>(L, 3);
+	if (LuaCommand* cmd = pushCommand(L, LuaCommand::SET_POSITION)) cmd->pos = pos;
+	return 0;
+}
+
+static int LUA_deferSetEntityRotation(lua_State* L) {
+	const Quat rot = LuaWrapper::checkArg<Quat>(L, 3);
+	if (LuaCommand* cmd = pushCommand(L, LuaCommand::SET_ROTATION)) cmd->rot = rot;
+	return 0;
+}
+
+static int LUA_deferSetEntityScale(lua_State* L) {
+	const Vec3 scale = LuaWrapper::checkArg<Vec3>(L, 3);
+	if (LuaCommand* cmd = pushCommand(L, LuaCommand::SET_SCALE)) cmd->scale = scale;
+	return 0;
+}
+
+static int LUA_deferDestroyEntity(lua_State* L) {
+	pushCommand(L, LuaCommand::DESTROY_ENTITY);
+	return 0;
+}
+
+void LuaScriptSystemImpl::createIsolatedStates() {
+	PROFILE_FUNCTION();
+	m_isolated_states.reserve(ISOLATED_STATES_COUNT);
+	for (u32 i = 0; i < ISOLATED_STATES_COUNT; ++i) {
+		IsolatedLuaState* state = LUMIX_NEW(m_allocator, IsolatedLuaState)(*this, i);
+		m_isolated_states.push(state);
+		state->heap.system = this;
+		state->L = lua_newstate(luaAlloc, &state->heap);
+		lua_State* L = state->L;
+		lua_gc(L, LUA_GCSTOP, 0);
+		registerGlobals(L, m_engine);
+		lua_pushlightuserdata(L, state);
+		lua_pushcclosure(L, &LUA_isolatedRequire, "require", 1);
+		lua_setglobal(L, "require");
+		lua_pushlightuserdata(L, state);
+		lua_pushcclosure(L, &LUA_isolatedDofile, "dofile", 1);
+		lua_setglobal(L, "dofile");
+		registerIsolatedAPI(L, &m_engine);
+		LuaWrapper::createSystemClosure(L, "LumixAPI", state, "setEntityPosition", &LUA_deferSetEntityPosition);
+		LuaWrapper::createSystemClosure(L, "LumixAPI", state, "setEntityRotation", &LUA_deferSetEntityRotation);
+		LuaWrapper::createSystemClosure(L, "LumixAPI", state, "setEntityScale", &LUA_deferSetEntityScale);
+		LuaWrapper::createSystemClosure(L, "LumixAPI", state, "destroyEntity", &LUA_deferDestroyEntity);
+	}
+}
+
+LuaScriptSystemImpl::LuaScriptSystemImpl(Engine& engine)
+	: m_engine(engine)
+	, m_allocator(engine.getAllocator(), "lua system")
+	, m_script_manager(m_allocator)
+	, m_lua_allocator(engine.getAllocator(), "luau")
+	, m_lua_resources(m_allocator)
+	, m_isolated_states(m_allocator)
+	, m_memory_categories(m_allocator)
+	, m_memory_category_names(m_allocator)
+{
+	m_memory_category_names.emplace("other", m_allocator);
+	m_memory_category_names.emplace("inline scripts", m_allocator);
+
+	m_heap.system = this;
+	m_state = lua_newstate(luaAlloc, &m_heap);
+	lua_gc(m_state, LUA_GCSTOP, 0);
+	registerGlobals(m_state, engine);
 
 	m_script_manager.create(LuaScript::TYPE, engine.getResourceManager());
 
@@ -2279,6 +2633,10 @@ LuaScriptSystemImpl::~LuaScriptSystemImpl()
 	for (Resource* res : m_lua_resources) {
 		res->decRefCount();
 	}
+	for (IsolatedLuaState* state : m_isolated_states) {
+		lua_close(state->L);
+		LUMIX_DELETE(m_allocator, state);
+	}
 	lua_close(m_state);
 	m_script_manager.destroy();
 }
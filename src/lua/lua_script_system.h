@@ -24,6 +24,18 @@ struct LuaScriptSystem : ISystem {
 	virtual struct Resource* getLuaResource(LuaResourceHandle idx) const = 0;
 	virtual LuaResourceHandle addLuaResource(const struct Path& path, struct ResourceType type) = 0;
 	virtual void unloadLuaResource(LuaResourceHandle resource_idx) = 0;
+
+	// garbage is collected in explicit steps at the end of the frame, limited by this budget
+	virtual void setGCBudget(float ms) = 0;
+	virtual float getGCBudget() const = 0;
+	// time spent in the explicit steps last frame
+	virtual float getLastGCTime() const = 0;
+	// all states, in bytes
+	virtual u64 getHeapSize() = 0;
+	// allocations are attributed to script resources, category 0 is everything else
+	virtual u32 getMemoryCategoriesCount() const = 0;
+	virtual const char* getMemoryCategoryName(u32 category) const = 0;
+	virtual u64 getMemoryCategorySize(u32 category) = 0;
 };
 
 //@ module LuaScriptModule lua_script "Lua"
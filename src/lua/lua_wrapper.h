@@ -122,7 +122,7 @@ template <> inline bool isType<ComponentType>(lua_State* L, int index)
 }
 template <> inline bool isType<Vec3>(lua_State* L, int index)
 {
-	return lua_istable(L, index) != 0 && lua_objlen(L, index) == 3;
+	return lua_isvector(L, index) || (lua_istable(L, index) != 0 && lua_objlen(L, index) == 3);
 }
 template <> inline bool isType<Color>(lua_State* L, int index) {
 	if (lua_istable(L, index) == 0) return false;
@@ -131,7 +131,7 @@ template <> inline bool isType<Color>(lua_State* L, int index) {
 }
 template <> inline bool isType<DVec3>(lua_State* L, int index)
 {
-	return lua_istable(L, index) != 0 && lua_objlen(L, index) == 3;
+	return lua_isvector(L, index) || (lua_istable(L, index) != 0 && lua_objlen(L, index) == 3);
 }
 template <> inline bool isType<Vec4>(lua_State* L, int index)
 {
@@ -223,6 +223,7 @@ template <> inline EntityPtr toType(lua_State* L, int index) {
 }
 
 template <> inline Vec3 toType(lua_State* L, int index) {
+	if (const float* f = lua_tovector(L, index)) return Vec3(f[0], f[1], f[2]);
 	Vec3 v;
 	lua_rawgeti(L, index, 1);
 	v.x = (float)lua_tonumber(L, -1);
@@ -251,6 +252,7 @@ template <> inline IVec3 toType(lua_State* L, int index) {
 }
 
 template <> inline DVec3 toType(lua_State* L, int index) {
+	if (const float* f = lua_tovector(L, index)) return DVec3(f[0], f[1], f[2]);
 	DVec3 v;
 	lua_rawgeti(L, index, 1);
 	v.x = (double)lua_tonumber(L, -1);
@@ -528,6 +530,11 @@ inline void push(lua_State* L, const Vec3& value)
 	lua_pushnumber(L, value.z);
 	lua_rawseti(L, -2, 3);
 }
+// native Luau vector, does not allocate, but it's immutable and has only float precision
+inline void pushVector(lua_State* L, const Vec3& value)
+{
+	lua_pushvector(L, value.x, value.y, value.z);
+}
 inline void push(lua_State* L, const DVec3& value)
 {
 	lua_createtable(L, 3, 0);
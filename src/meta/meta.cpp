@@ -2055,6 +2055,11 @@ void serializeLuaTypes(OutputStream& out_formatted) {
 	export type Color = {number}
 	export type Quat = {number}
 	export type DVec3 = {number}
+	-- native Luau vector, accepted everywhere Vec3 or DVec3 is
+	export type Vector = any
+	declare vector: {
+		create : (number, number, number) -> Vector,
+	}
 	declare ImGui: {
 		AlignTextToFramePadding : () -> (),
 		Begin : (string, boolean?) -> (boolean, boolean?),
@@ -2212,6 +2217,9 @@ void serializeLuaTypes(OutputStream& out_formatted) {
 		rotation : any,
 		position : Vec3,
 		local_position : Vec3,
+		vposition : Vector,
+		vlocal_position : Vector,
+		vscale : Vector,
 		first_child : Entity?,
 		next_sibling : Entity?,
 		scale : Vec3,
@@ -2263,6 +2271,11 @@ void serializeLuaTypes(OutputStream& out_formatted) {
 		writeFile : (string, string) -> boolean,
 		createPipeline : () -> Pipeline,
 		destroyPipeline : (Pipeline) -> (),
+		getEntityPositions : (World, entities: buffer | {Entity | number}, out: buffer?) -> buffer,
+		getEntityRotations : (World, entities: buffer | {Entity | number}, out: buffer?) -> buffer,
+		setEntityTransforms : (World, entities: buffer | {Entity | number}, positions: buffer?, rotations: buffer?) -> (),
+		getComponentProperties : (World, entities: buffer | {Entity | number}, component: string, property: string, out: buffer?) -> buffer,
+		setComponentProperties : (World, entities: buffer | {Entity | number}, component: string, property: string, values: buffer) -> (),
 	)#");
 
 	// Emit enum typings into LumixAPI so editors see LumixAPI.<EnumName>.<Member>
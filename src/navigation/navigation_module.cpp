@@ -5,20 +5,24 @@
 #include "core/log.h"
 #include "core/os.h"
 #include "core/profiler.h"
+#include "core/sort.h"
 #include "core/sync.h"
 #include "engine/component_types.h"
 #include "engine/engine.h"
+#include "engine/file_system.h"
 #include "engine/lumix.h"
 #include "engine/reflection.h"
 #include "engine/world.h"
 #include "imgui/IconsFontAwesome5.h"
 #include "lua/lua_script_system.h"
 #include "navigation_module.h"
+#include "physics/physics_module.h"
 #include "renderer/material.h"
 #include "renderer/model.h"
 #include "renderer/render_module.h"
 
 #include <DetourAlloc.h>
+#include <DetourCommon.h>
 #include <DetourCrowd.h>
 #include <DetourNavMesh.h>
 #include <DetourNavMeshBuilder.h>
@@ -36,6 +40,8 @@ enum class NavigationModuleVersion : i32 {
 
 struct NavmeshHeader {
 	enum Version : u32 {
+		FIRST,
+		STREAMED, // tiles can be stored in separate files
 		LATEST
 	};
 
@@ -53,8 +59,17 @@ struct RecastZone {
 	u32 m_num_tiles_x = 0;
 	u32 m_num_tiles_z = 0;
 	dtNavMeshQuery* navquery = nullptr;
+	// used only by queued path requests, a sliced query can be in progress across frames
+	dtNavMeshQuery* path_query = nullptr;
 	dtNavMesh* navmesh = nullptr;
 	dtCrowd* crowd = nullptr;
+	// range in NavigationModuleImpl::m_zone_agents
+	u32 agents_offset = 0;
+	u32 agents_count = 0;
+	// incremented when the navmesh is freed, tiles built for an older navmesh are discarded
+	u32 generation = 0;
+	// not null if tiles are streamed from separate files
+	struct StreamedZone* stream = nullptr;
 
 	i32 getWalkableRadius() const { return (i32)(zone.agent_radius / zone.cell_size + 0.99f); }
 	float getBorderSize() const { return getWalkableRadius() + 3.f; }
@@ -81,6 +96,182 @@ struct Agent
 	float speed = 0;
 	float yaw_diff = 0;
 	float stop_distance = 0;
+	// transform is being written from the crowd, so it must not be written back
+	bool moving = false;
+	bool path_finished = false;
+	// navigate() was called, but the path is not found yet
+	bool path_pending = false;
+	// id of the latest path request, older requests are dropped
+	u32 path_request = 0;
+	// world space destination of the latest navigate() call
+	DVec3 dest;
+};
+
+
+struct PathRequest {
+	EntityRef agent;
+	EntityRef zone;
+	u32 request;
+	Vec3 dest; // zone space
+	dtPolyRef start = 0;
+	dtPolyRef end = 0; // found by navigate, 0 if it must be found again because tiles changed
+	bool started = false;
+	u64 enqueue_time;
+};
+
+
+// recently found corridors, e.g. a group of units ordered to the same place reuses the corridor
+struct PathCache {
+	static constexpr u32 SIZE = 32;
+	static constexpr i32 MAX_PATH = 256;
+
+	struct Entry {
+		EntityPtr zone = INVALID_ENTITY;
+		dtPolyRef start = 0;
+		dtPolyRef end = 0;
+		u32 last_used = 0;
+		i32 count = 0;
+		dtPolyRef path[MAX_PATH];
+	};
+
+	Entry* find(EntityRef zone, dtPolyRef start, dtPolyRef end) {
+		for (Entry& e : entries) {
+			if (e.zone == zone && e.start == start && e.end == end) {
+				e.last_used = ++tick;
+				return &e;
+			}
+		}
+		return nullptr;
+	}
+
+	void insert(EntityRef zone, dtPolyRef start, dtPolyRef end, const dtPolyRef* path, i32 count) {
+		Entry* lru = &entries[0];
+		for (Entry& e : entries) {
+			if (e.last_used < lru->last_used) lru = &e;
+		}
+		lru->zone = zone;
+		lru->start = start;
+		lru->end = end;
+		lru->last_used = ++tick;
+		lru->count = minimum(count, MAX_PATH);
+		memcpy(lru->path, path, sizeof(path[0]) * lru->count);
+	}
+
+	void clear() {
+		for (Entry& e : entries) e = {};
+	}
+
+	// tile is going to be removed, corridors through it would contain invalid polygons
+	void invalidateTile(EntityRef zone, const dtNavMesh& navmesh, dtTileRef tile) {
+		const u32 tile_idx = navmesh.decodePolyIdTile(tile);
+		for (Entry& e : entries) {
+			if (e.zone != zone) continue;
+			for (i32 i = 0; i < e.count; ++i) {
+				if (navmesh.decodePolyIdTile(e.path[i]) == tile_idx) {
+					e = {};
+					break;
+				}
+			}
+		}
+	}
+
+	// tile was added, partial corridors (not reaching the end polygon) might now reach it
+	void invalidatePartial(EntityRef zone) {
+		for (Entry& e : entries) {
+			if (e.zone == zone && e.count > 0 && e.path[e.count - 1] != e.end) e = {};
+		}
+	}
+
+	Entry entries[SIZE];
+	u32 tick = 0;
+};
+
+
+// navigation-relevant mesh triangles of a zone, in zone space, binned by tiles
+struct NavGeometry {
+	NavGeometry(IAllocator& allocator)
+		: vertices(allocator)
+		, areas(allocator)
+		, tile_offsets(allocator)
+		, tile_triangles(allocator)
+	{}
+
+	// 3 vertices and 1 area per triangle
+	Array<Vec3> vertices;
+	Array<u8> areas;
+	// triangles of tile i are tile_triangles[tile_offsets[i]] .. tile_triangles[tile_offsets[i + 1] - 1]
+	Array<u32> tile_offsets;
+	Array<u32> tile_triangles;
+	u32 num_tiles_x = 0;
+	// first binned tile, geometry does not have to cover the whole zone
+	i32 from_x = 0;
+	i32 from_z = 0;
+	// terrain triangles are included, see gatherTileGeometry
+	bool has_terrains = false;
+};
+
+
+struct DirtyTile {
+	EntityRef zone;
+	i32 x;
+	i32 z;
+};
+
+
+struct ObstacleBounds {
+	DVec3 min;
+	DVec3 max;
+};
+
+
+// tile built on a worker, swapped into the zone's navmesh on the main thread
+struct TileRebuild {
+	TileRebuild(IAllocator& allocator) : geometry(allocator) {}
+
+	EntityRef zone;
+	NavmeshZone params;
+	u32 generation;
+	i32 x;
+	i32 z;
+	// snapshot of the tile's geometry taken on the main thread, so the worker does not touch the world
+	NavGeometry geometry;
+	u8* data = nullptr;
+	i32 data_size = 0;
+	bool success = false;
+	AtomicI32 done = 0;
+};
+
+
+struct StreamedTile {
+	void loaded(Span<const u8> mem, bool success);
+
+	struct StreamedZone* stream;
+	// uncompressed size, 0 if the tile is empty
+	i32 data_size = 0;
+	u16 x;
+	u16 z;
+	bool resident = false;
+	// squared distance to the nearest streaming point, valid if kept_frame is the current streaming frame
+	float priority;
+	// tile is within streaming radius, it should be loaded
+	u32 needed_frame = 0;
+	// tile is within streaming radius + unload margin, it stays loaded if it's already loaded
+	u32 kept_frame = 0;
+	FileSystem::AsyncHandle handle = FileSystem::AsyncHandle::invalid();
+};
+
+
+// tiles of a streamed zone are loaded around the camera and agents, in NavigationModuleImpl::updateStreaming
+struct StreamedZone {
+	StreamedZone(struct NavigationModuleImpl& module, EntityRef zone, IAllocator& allocator)
+		: module(module)
+		, zone(zone)
+		, tiles(allocator)
+	{}
+
+	NavigationModuleImpl& module;
+	EntityRef zone;
+	Array<StreamedTile> tiles;
 };
 
 
@@ -93,25 +284,267 @@ struct NavigationModuleImpl final : NavigationModule
 		, m_engine(engine)
 		, m_agents(m_allocator)
 		, m_zones(m_allocator)
+		, m_crowd_zones(m_allocator)
+		, m_zone_agents(m_allocator)
+		, m_agent_transforms(m_allocator)
+		, m_moved_entities(m_allocator)
+		, m_moved_transforms(m_allocator)
+		, m_finished_agents(m_allocator)
+		, m_path_requests(m_allocator)
+		, m_dirty_tiles(m_allocator)
+		, m_dirty_tiles_lookup(m_allocator)
+		, m_tile_rebuilds(m_allocator)
+		, m_obstacle_bounds(m_allocator)
+		, m_obstacle_overrides(m_allocator)
+		, m_moved_obstacles(m_allocator)
 		, m_script_module(nullptr)
 	{
 		m_world.componentTransformed(types::navmesh_agent).bind<&NavigationModuleImpl::onAgentMoved>(this);
+		m_world.componentTransformed(types::model_instance).bind<&NavigationModuleImpl::onObstacleMoved>(this);
+		m_world.componentAdded().bind<&NavigationModuleImpl::onComponentAdded>(this);
+		m_world.componentDestroyed().bind<&NavigationModuleImpl::onComponentDestroyed>(this);
 	}
 
 
 	~NavigationModuleImpl() {
+		jobs::wait(&m_tile_rebuild_signal);
+		for (TileRebuild* rebuild : m_tile_rebuilds) {
+			if (rebuild->data) dtFree(rebuild->data);
+			LUMIX_DELETE(m_allocator, rebuild);
+		}
 		for(RecastZone& zone : m_zones) {
 			clearNavmesh(zone);
 		}
 		m_world.componentTransformed(types::navmesh_agent).unbind<&NavigationModuleImpl::onAgentMoved>(this);
+		m_world.componentTransformed(types::model_instance).unbind<&NavigationModuleImpl::onObstacleMoved>(this);
+		m_world.componentAdded().unbind<&NavigationModuleImpl::onComponentAdded>(this);
+		m_world.componentDestroyed().unbind<&NavigationModuleImpl::onComponentDestroyed>(this);
+	}
+
+
+	bool getObstacleBounds(EntityRef entity, ObstacleBounds& bounds) {
+		RenderModule* render_module = static_cast<RenderModule*>(m_world.getModule(types::model_instance));
+		if (!render_module || !m_world.hasComponent(entity, types::model_instance)) return false;
+		Model* model = render_module->getModelInstanceModel(entity);
+		if (!model || !model->isReady()) return false;
+
+		DVec3 corners[8];
+		model->getAABB().getCorners(m_world.getTransform(entity), corners);
+		bounds.min = bounds.max = corners[0];
+		for (const DVec3& p : corners) {
+			bounds.min = DVec3(minimum(bounds.min.x, p.x), minimum(bounds.min.y, p.y), minimum(bounds.min.z, p.z));
+			bounds.max = DVec3(maximum(bounds.max.x, p.x), maximum(bounds.max.y, p.y), maximum(bounds.max.z, p.z));
+		}
+		return true;
+	}
+
+
+	// both the old and the new place of the obstacle must be rebuilt
+	void updateObstacle(EntityRef entity, bool destroyed) {
+		auto iter = m_obstacle_bounds.find(entity);
+		if (iter.isValid()) markDirty(iter.value().min, iter.value().max);
+
+		ObstacleBounds bounds;
+		if (!destroyed && getObstacleBounds(entity, bounds)) {
+			markDirty(bounds.min, bounds.max);
+			if (iter.isValid()) iter.value() = bounds;
+			else m_obstacle_bounds.insert(entity, bounds);
+		}
+		else if (iter.isValid()) {
+			m_obstacle_bounds.erase(iter);
+		}
+	}
+
+
+	bool isMovingEntity(EntityRef entity) const {
+		if (m_world.hasComponent(entity, types::navmesh_agent)) return true;
+		if (m_world.hasComponent(entity, types::animator)) return true;
+		if (m_world.hasComponent(entity, types::physical_controller)) return true;
+		if (!m_world.hasComponent(entity, types::rigid_actor)) return false;
+		PhysicsModule* physics = static_cast<PhysicsModule*>(m_world.getModule(types::rigid_actor));
+		return physics && physics->getActorDynamicType(entity) != PhysicsModule::DynamicType::STATIC;
+	}
+
+
+	// agents never affect the navmesh, animated, character and dynamic physics entities (and their children)
+	// move too often to be rebuilt around, unless they are explicitly flagged with setObstacleTracked
+	bool isTrackedObstacle(EntityRef entity) const {
+		if (m_world.hasComponent(entity, types::navmesh_agent)) return false;
+		auto iter = m_obstacle_overrides.find(entity);
+		if (iter.isValid()) return iter.value();
+		for (EntityPtr e = entity; e.isValid(); e = m_world.getParent((EntityRef)e)) {
+			if (isMovingEntity((EntityRef)e)) return false;
+		}
+		return true;
+	}
+
+
+	void setObstacleTracked(EntityRef entity, bool tracked) override {
+		auto iter = m_obstacle_overrides.find(entity);
+		if (iter.isValid()) iter.value() = tracked;
+		else m_obstacle_overrides.insert(entity, tracked);
+
+		if (!m_is_game_running) return;
+		if (isTrackedObstacle(entity)) updateObstacle(entity, false);
+		else m_obstacle_bounds.erase(entity);
+	}
+
+
+	// can be called from worker threads (e.g. root motion), so moved obstacles are processed later in update
+	void onObstacleMoved(EntityRef entity) {
+		if (!m_is_game_running) return;
+		MutexGuard guard(m_moved_obstacles_mutex);
+		m_moved_obstacles.push(entity);
+	}
+
+
+	void processMovedObstacles() {
+		MutexGuard guard(m_moved_obstacles_mutex);
+		for (EntityRef entity : m_moved_obstacles) {
+			if (!m_world.hasEntity(entity)) continue;
+			if (isTrackedObstacle(entity)) updateObstacle(entity, false);
+			else m_obstacle_bounds.erase(entity);
+		}
+		m_moved_obstacles.clear();
+	}
+
+
+	void onComponentAdded(const ComponentUID& cmp) {
+		if (!m_is_game_running || cmp.type != types::model_instance) return;
+		if (!isTrackedObstacle((EntityRef)cmp.entity)) return;
+		updateObstacle((EntityRef)cmp.entity, false);
+	}
+
+
+	void onComponentDestroyed(const ComponentUID& cmp) {
+		if (cmp.type != types::model_instance) return;
+		m_obstacle_overrides.erase((EntityRef)cmp.entity);
+		if (!m_is_game_running) return;
+		updateObstacle((EntityRef)cmp.entity, true);
+	}
+
+
+	void markDirty(const DVec3& min, const DVec3& max) override {
+		for (RecastZone& zone : m_zones) {
+			// streamed tiles come from their files, a rebuilt tile would be replaced by the saved one when it's streamed in again
+			if (!zone.navmesh || zone.stream) continue;
+
+			const Transform zone_tr = m_world.getTransform(zone.entity);
+			Vec3 local_min(FLT_MAX);
+			Vec3 local_max(-FLT_MAX);
+			for (u32 i = 0; i < 8; ++i) {
+				const DVec3 corner(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z);
+				const Vec3 p = Vec3(zone_tr.invTransform(corner));
+				local_min = AABB::minCoords(local_min, p);
+				local_max = AABB::maxCoords(local_max, p);
+			}
+
+			const Vec3 zone_min = -zone.zone.extents;
+			const Vec3 zone_max = zone.zone.extents;
+			if (local_max.x < zone_min.x || local_max.y < zone_min.y || local_max.z < zone_min.z) continue;
+			if (local_min.x > zone_max.x || local_min.y > zone_max.y || local_min.z > zone_max.z) continue;
+
+			// tiles are rasterized with a border, so the change can affect neighbouring tiles too
+			const float border = (1 + zone.getBorderSize()) * zone.zone.cell_size;
+			const float tile_size = CELLS_PER_TILE_SIDE * zone.zone.cell_size;
+			const i32 from_x = maximum(0, i32(floorf((local_min.x - zone_min.x - border) / tile_size)));
+			const i32 from_z = maximum(0, i32(floorf((local_min.z - zone_min.z - border) / tile_size)));
+			const i32 to_x = minimum(i32(zone.m_num_tiles_x) - 1, i32(floorf((local_max.x - zone_min.x + border) / tile_size)));
+			const i32 to_z = minimum(i32(zone.m_num_tiles_z) - 1, i32(floorf((local_max.z - zone_min.z + border) / tile_size)));
+			for (i32 z = from_z; z <= to_z; ++z) {
+				for (i32 x = from_x; x <= to_x; ++x) {
+					const u64 key = getDirtyTileKey(zone.entity, x, z);
+					if (m_dirty_tiles_lookup.find(key).isValid()) continue;
+					m_dirty_tiles_lookup.insert(key, true);
+					m_dirty_tiles.push({zone.entity, x, z});
+				}
+			}
+		}
+	}
+
+
+	static u64 getDirtyTileKey(EntityRef zone, i32 x, i32 z) {
+		return ((u64)(u32)zone.index << 32) | ((u64)(u16)x << 16) | (u16)z;
+	}
+
+
+	void setMaxTileRebuilds(u32 count) override { m_max_tile_rebuilds = maximum(count, 1u); }
+
+
+	bool isTileRebuilding(const DirtyTile& tile) const {
+		for (const TileRebuild* rebuild : m_tile_rebuilds) {
+			if (rebuild->zone == tile.zone && rebuild->x == tile.x && rebuild->z == tile.z) return true;
+		}
+		return false;
+	}
+
+
+	// runs on the main thread, when no crowd or path query uses the navmeshes
+	void processTileRebuilds() {
+		PROFILE_FUNCTION();
+		for (i32 i = m_tile_rebuilds.size() - 1; i >= 0; --i) {
+			TileRebuild* rebuild = m_tile_rebuilds[i];
+			if (rebuild->done == 0) continue;
+
+			auto iter = m_zones.find(rebuild->zone);
+			RecastZone* zone = iter.isValid() ? &iter.value() : nullptr;
+			if (zone && zone->navmesh && zone->generation == rebuild->generation && rebuild->success) {
+				// crowd agents on removed polygons are replanned by dtCrowd, since the tile's poly refs change
+				const dtTileRef old_tile = zone->navmesh->getTileRefAt(rebuild->x, rebuild->z, 0);
+				if (old_tile) removeTile(*zone, old_tile);
+				if (rebuild->data && dtStatusFailed(zone->navmesh->addTile(rebuild->data, rebuild->data_size, DT_TILE_FREE_DATA, 0, nullptr))) {
+					logError("Could not add Detour tile.");
+					dtFree(rebuild->data);
+				}
+				else if (rebuild->data) {
+					m_path_cache.invalidatePartial(zone->entity);
+				}
+			}
+			else if (rebuild->data) {
+				dtFree(rebuild->data);
+			}
+			LUMIX_DELETE(m_allocator, rebuild);
+			m_tile_rebuilds.swapAndPop(i);
+		}
+
+		for (i32 i = 0; i < m_dirty_tiles.size() && (u32)m_tile_rebuilds.size() < m_max_tile_rebuilds;) {
+			const DirtyTile tile = m_dirty_tiles[i];
+			// tile changed while it was being built, it's built again once the current build finishes
+			if (isTileRebuilding(tile)) {
+				++i;
+				continue;
+			}
+			m_dirty_tiles.erase(i);
+			m_dirty_tiles_lookup.erase(getDirtyTileKey(tile.zone, tile.x, tile.z));
+
+			auto iter = m_zones.find(tile.zone);
+			if (!iter.isValid() || !iter.value().navmesh) continue;
+
+			TileRebuild* rebuild = LUMIX_NEW(m_allocator, TileRebuild)(m_allocator);
+			rebuild->zone = tile.zone;
+			rebuild->params = iter.value().zone;
+			rebuild->generation = iter.value().generation;
+			rebuild->x = tile.x;
+			rebuild->z = tile.z;
+			gatherTileGeometry(iter.value(), tile.x, tile.z, rebuild->geometry);
+			m_tile_rebuilds.push(rebuild);
+			jobs::runLambda([this, rebuild](){
+				PROFILE_BLOCK("rebuild navmesh tile");
+				rebuild->success = buildTile(rebuild->params, rebuild->zone, rebuild->x, rebuild->z, nullptr, &rebuild->geometry, rebuild->data, rebuild->data_size);
+				rebuild->done = 1;
+			}, &m_tile_rebuild_signal);
+		}
+
+		static u32 dirty_tiles_counter = profiler::createCounter("Dirty navmesh tiles", 0);
+		profiler::pushCounter(dirty_tiles_counter, float(m_dirty_tiles.size() + m_tile_rebuilds.size()));
 	}
 
 
 	void onAgentMoved(EntityRef entity) {
 		auto iter = m_agents.find(entity);
 		ASSERT(iter.isValid());
-		if (m_moving_agent == entity) return;
 		Agent& agent = iter.value();
+		if (agent.moving) return;
 		
 		if (agent.agent < 0) {
 			assignZone(agent);
@@ -126,26 +559,39 @@ struct NavigationModuleImpl final : NavigationModule
 		const Transform zone_tr = m_world.getTransform((EntityRef)agent.zone);
 		const Vec3 pos = Vec3(zone_tr.invTransform(agent_pos));
 		if (squaredLength(pos.xz() - (*(Vec3*)dt_agent->npos).xz()) > 0.1f) {
-			const Transform old_zone_tr = m_world.getTransform(zone.entity);
-			const DVec3 target_pos = old_zone_tr.transform(*(Vec3*)dt_agent->targetPos);
 			float speed = dt_agent->params.maxSpeed;
 			zone.crowd->removeAgent(agent.agent);
 			addCrowdAgent(iter.value(), zone);
+			// crowd's target is not set yet if the path is still pending, so use the requested destination
 			if (!agent.is_finished) {
-				navigate(entity, target_pos, speed, agent.stop_distance);
+				navigate(entity, agent.dest, speed, agent.stop_distance);
 			}
 		}
 	}
 
 
 	void clearNavmesh(RecastZone& zone) {
+		m_zone_agents_dirty = true;
+		++zone.generation;
+		if (zone.stream) {
+			FileSystem& fs = m_engine.getFileSystem();
+			for (StreamedTile& tile : zone.stream->tiles) {
+				if (tile.handle.isValid()) fs.cancel(tile.handle);
+				if (tile.handle.isValid() || tile.resident) m_streamed_bytes -= tile.data_size;
+			}
+			LUMIX_DELETE(m_allocator, zone.stream);
+			zone.stream = nullptr;
+		}
+		m_navmesh_version.inc();
 		dtFreeNavMeshQuery(zone.navquery);
+		dtFreeNavMeshQuery(zone.path_query);
 		dtFreeNavMesh(zone.navmesh);
 		rcFreeCompactHeightfield(zone.debug_compact_heightfield);
 		rcFreeHeightField(zone.debug_heightfield);
 		rcFreeContourSet(zone.debug_contours);
 		dtFreeCrowd(zone.crowd);
 		zone.navquery = nullptr;
+		zone.path_query = nullptr;
 		zone.navmesh = nullptr;
 		zone.debug_compact_heightfield = nullptr;
 		zone.debug_heightfield = nullptr;
@@ -154,15 +600,30 @@ struct NavigationModuleImpl final : NavigationModule
 	}
 
 
-	void rasterizeGeometry(const Transform& zone_tr, const AABB& aabb, rcContext& ctx, rcConfig& cfg, rcHeightfield& solid)
+	// geometry is optional, if it's null meshes are gathered only for this tile
+	// the world is not accessed if geometry has terrains
+	void rasterizeGeometry(EntityRef zone_entity, const AABB& aabb, rcContext& ctx, rcConfig& cfg, rcHeightfield& solid, const NavGeometry* geometry, i32 x, i32 z)
 	{
-		rasterizeMeshes(zone_tr, aabb, ctx, cfg, solid);
+		if (geometry) rasterizeMeshes(*geometry, x, z, ctx, solid);
+		if (geometry && geometry->has_terrains) return;
+
+		const Transform zone_tr = m_world.getTransform(zone_entity);
+		if (!geometry) rasterizeMeshes(zone_tr, aabb, ctx, cfg, solid);
 		rasterizeTerrains(zone_tr, aabb, ctx, cfg, solid);
 	}
 
 
 	void rasterizeTerrains(const Transform& zone_tr, const AABB& tile_aabb, rcContext& ctx, rcConfig& cfg, rcHeightfield& solid) {
 		PROFILE_FUNCTION();
+		forEachTerrainTriangle(zone_tr, tile_aabb, [&](const Vec3& a, const Vec3& b, const Vec3& c, u8 area){
+			rcRasterizeTriangle(&ctx, &a.x, &b.x, &c.x, area, solid);
+		});
+	}
+
+
+	// calls f(a, b, c, area) for each terrain triangle overlapping tile_aabb, vertices are in zone space
+	template <typename F>
+	void forEachTerrainTriangle(const Transform& zone_tr, const AABB& tile_aabb, F&& f) {
 		const float walkable_threshold = cosf(degreesToRadians(60));
 
 		auto render_module = static_cast<RenderModule*>(m_world.getModule("renderer"));
@@ -206,25 +667,26 @@ struct NavigationModuleImpl final : NavigationModule
 
 					Vec3 n = normalize(cross(p1 - p0, p0 - p2));
 					u8 area = n.y > walkable_threshold ? RC_WALKABLE_AREA : 0;
-					rcRasterizeTriangle(&ctx, &p0.x, &p1.x, &p2.x, area, solid);
+					f(p0, p1, p2, area);
 
 					n = normalize(cross(p2 - p0, p0 - p3));
 					area = n.y > walkable_threshold ? RC_WALKABLE_AREA : 0;
-					rcRasterizeTriangle(&ctx, &p0.x, &p2.x, &p3.x, area, solid);
+					f(p0, p2, p3, area);
 				}
 			}
 			entity_ptr = render_module->getNextTerrain(entity);
 		}
 	}
 
-	LUMIX_FORCE_INLINE void rasterizeModel(Model* model
+	// calls f(a, b, c, area) for each navigation-relevant triangle of the model, vertices are in zone space
+	template <typename F>
+	LUMIX_FORCE_INLINE void forEachModelTriangle(Model* model
 		, const Transform& tr
 		, const AABB& zone_aabb
 		, const Transform& zone_tr
 		, u32 no_navigation_flag
 		, u32 nonwalkable_flag
-		, rcContext& ctx
-		, rcHeightfield& solid)
+		, F&& f)
 	{
 		ASSERT(model->isReady());
 
@@ -255,7 +717,7 @@ struct NavigationModuleImpl final : NavigationModule
 
 					Vec3 n = normalize(cross(a - b, a - c));
 					u8 area = n.y > walkable_threshold && is_walkable ? RC_WALKABLE_AREA : 0;
-					rcRasterizeTriangle(&ctx, &a.x, &b.x, &c.x, area, solid);
+					f(a, b, c, area);
 				}
 			}
 			else {
@@ -267,16 +729,16 @@ struct NavigationModuleImpl final : NavigationModule
 
 					Vec3 n = normalize(cross(a - b, a - c));
 					u8 area = n.y > walkable_threshold && is_walkable ? RC_WALKABLE_AREA : 0;
-					rcRasterizeTriangle(&ctx, &a.x, &b.x, &c.x, area, solid);
+					f(a, b, c, area);
 				}
 			}
 		}
 	}
 
-	void rasterizeMeshes(const Transform& zone_tr, const AABB& aabb, rcContext& ctx, rcConfig& cfg, rcHeightfield& solid)
+	// calls f(a, b, c, area) for each navigation-relevant triangle of model instances and instanced models overlapping aabb
+	template <typename F>
+	void forEachMeshTriangle(const Transform& zone_tr, const AABB& aabb, F&& f)
 	{
-		PROFILE_FUNCTION();
-
 		auto render_module = static_cast<RenderModule*>(m_world.getModule("renderer"));
 		if (!render_module) return;
 
@@ -291,7 +753,7 @@ struct NavigationModuleImpl final : NavigationModule
 			if (!model) return;
 		
 			const Transform tr = m_world.getTransform(entity);
-			rasterizeModel(model, tr, aabb, zone_tr, no_navigation_flag, nonwalkable_flag, ctx, solid);
+			forEachModelTriangle(model, tr, aabb, zone_tr, no_navigation_flag, nonwalkable_flag, f);
 		}
 
 		const HashMap<EntityRef, InstancedModel>& ims = render_module->getInstancedModels();
@@ -323,7 +785,107 @@ struct NavigationModuleImpl final : NavigationModule
 				tr.rot.w = sqrtf(1 - dot(i.rot_quat, i.rot_quat));
 				tr.scale = Vec3(i.scale);
 				tr = im_tr.compose(tr);
-				rasterizeModel(im.model, tr, aabb, zone_tr, no_navigation_flag, nonwalkable_flag, ctx, solid);
+				forEachModelTriangle(im.model, tr, aabb, zone_tr, no_navigation_flag, nonwalkable_flag, f);
+			}
+		}
+	}
+
+	void rasterizeMeshes(const Transform& zone_tr, const AABB& aabb, rcContext& ctx, rcConfig& cfg, rcHeightfield& solid)
+	{
+		PROFILE_FUNCTION();
+		forEachMeshTriangle(zone_tr, aabb, [&](const Vec3& a, const Vec3& b, const Vec3& c, u8 area){
+			rcRasterizeTriangle(&ctx, &a.x, &b.x, &c.x, area, solid);
+		});
+	}
+
+	void rasterizeMeshes(const NavGeometry& geometry, i32 x, i32 z, rcContext& ctx, rcHeightfield& solid) {
+		PROFILE_FUNCTION();
+		const u32 tile = (x - geometry.from_x) + (z - geometry.from_z) * geometry.num_tiles_x;
+		for (u32 i = geometry.tile_offsets[tile], end = geometry.tile_offsets[tile + 1]; i < end; ++i) {
+			const u32 tri = geometry.tile_triangles[i];
+			const Vec3* v = &geometry.vertices[tri * 3];
+			rcRasterizeTriangle(&ctx, &v[0].x, &v[1].x, &v[2].x, geometry.areas[tri], solid);
+		}
+	}
+
+	// copies mesh and terrain triangles of a single tile, border included, so the tile can be built without touching the world
+	void gatherTileGeometry(const RecastZone& zone, i32 x, i32 z, NavGeometry& geometry) {
+		PROFILE_FUNCTION();
+		const Transform zone_tr = m_world.getTransform(zone.entity);
+		const AABB aabb = getTileAABB(zone.zone, x, z);
+		auto push = [&](const Vec3& a, const Vec3& b, const Vec3& c, u8 area){
+			geometry.vertices.push(a);
+			geometry.vertices.push(b);
+			geometry.vertices.push(c);
+			geometry.areas.push(area);
+		};
+		forEachMeshTriangle(zone_tr, aabb, push);
+		forEachTerrainTriangle(zone_tr, aabb, push);
+
+		geometry.num_tiles_x = 1;
+		geometry.from_x = x;
+		geometry.from_z = z;
+		geometry.has_terrains = true;
+		const u32 num_triangles = geometry.areas.size();
+		geometry.tile_offsets.push(0);
+		geometry.tile_offsets.push(num_triangles);
+		geometry.tile_triangles.resize(num_triangles);
+		for (u32 i = 0; i < num_triangles; ++i) geometry.tile_triangles[i] = i;
+	}
+
+	// transforms mesh triangles of the whole zone once and bins them by tiles, tiles' borders included
+	void gatherGeometry(const RecastZone& zone, NavGeometry& geometry) {
+		PROFILE_FUNCTION();
+		const Transform zone_tr = m_world.getTransform(zone.entity);
+		const AABB zone_aabb(-zone.zone.extents, zone.zone.extents);
+		forEachMeshTriangle(zone_tr, zone_aabb, [&](const Vec3& a, const Vec3& b, const Vec3& c, u8 area){
+			geometry.vertices.push(a);
+			geometry.vertices.push(b);
+			geometry.vertices.push(c);
+			geometry.areas.push(area);
+		});
+
+		geometry.num_tiles_x = zone.m_num_tiles_x;
+		const u32 num_tiles = zone.m_num_tiles_x * zone.m_num_tiles_z;
+		const float border = (1 + zone.getBorderSize()) * zone.zone.cell_size;
+		const float tile_size = CELLS_PER_TILE_SIDE * zone.zone.cell_size;
+		const Vec3 zone_min = -zone.zone.extents;
+		auto getTileRange = [&](u32 tri, IVec2& from, IVec2& to){
+			const Vec3* v = &geometry.vertices[tri * 3];
+			const Vec3 tri_min = AABB::minCoords(v[0], AABB::minCoords(v[1], v[2]));
+			const Vec3 tri_max = AABB::maxCoords(v[0], AABB::maxCoords(v[1], v[2]));
+			from.x = maximum(0, i32(floorf((tri_min.x - zone_min.x - border) / tile_size)));
+			from.y = maximum(0, i32(floorf((tri_min.z - zone_min.z - border) / tile_size)));
+			to.x = minimum(i32(zone.m_num_tiles_x) - 1, i32(floorf((tri_max.x - zone_min.x + border) / tile_size)));
+			to.y = minimum(i32(zone.m_num_tiles_z) - 1, i32(floorf((tri_max.z - zone_min.z + border) / tile_size)));
+		};
+
+		// count triangles per tile, then fill the bins
+		geometry.tile_offsets.resize(num_tiles + 1);
+		memset(geometry.tile_offsets.begin(), 0, sizeof(u32) * (num_tiles + 1));
+		const u32 num_triangles = geometry.areas.size();
+		for (u32 tri = 0; tri < num_triangles; ++tri) {
+			IVec2 from, to;
+			getTileRange(tri, from, to);
+			for (i32 z = from.y; z <= to.y; ++z) {
+				for (i32 x = from.x; x <= to.x; ++x) {
+					++geometry.tile_offsets[x + z * zone.m_num_tiles_x + 1];
+				}
+			}
+		}
+		for (u32 i = 0; i < num_tiles; ++i) geometry.tile_offsets[i + 1] += geometry.tile_offsets[i];
+
+		geometry.tile_triangles.resize(geometry.tile_offsets[num_tiles]);
+		Array<u32> cursors(m_allocator);
+		cursors.resize(num_tiles);
+		memcpy(cursors.begin(), geometry.tile_offsets.begin(), sizeof(u32) * num_tiles);
+		for (u32 tri = 0; tri < num_triangles; ++tri) {
+			IVec2 from, to;
+			getTileRange(tri, from, to);
+			for (i32 z = from.y; z <= to.y; ++z) {
+				for (i32 x = from.x; x <= to.x; ++x) {
+					geometry.tile_triangles[cursors[x + z * zone.m_num_tiles_x]++] = tri;
+				}
 			}
 		}
 	}
@@ -363,11 +925,44 @@ struct NavigationModuleImpl final : NavigationModule
 	}
 
 
+	// groups agents by zone, so zone updates touch only their own agents and can run in parallel
+	void updateZoneAgents() {
+		if (!m_zone_agents_dirty) return;
+		PROFILE_FUNCTION();
+		m_zone_agents_dirty = false;
+
+		m_crowd_zones.clear();
+		for (RecastZone& zone : m_zones) {
+			zone.agents_offset = 0;
+			zone.agents_count = 0;
+			if (zone.crowd) m_crowd_zones.push(&zone);
+		}
+
+		for (Agent& agent : m_agents) {
+			RecastZone* zone = getZone(agent);
+			if (agent.agent >= 0 && zone && zone->crowd) ++zone->agents_count;
+		}
+
+		u32 offset = 0;
+		for (RecastZone* zone : m_crowd_zones) {
+			zone->agents_offset = offset;
+			offset += zone->agents_count;
+			zone->agents_count = 0;
+		}
+
+		m_zone_agents.resize(offset);
+		m_agent_transforms.resize(offset);
+		for (Agent& agent : m_agents) {
+			RecastZone* zone = getZone(agent);
+			if (agent.agent < 0 || !zone || !zone->crowd) continue;
+			m_zone_agents[zone->agents_offset + zone->agents_count] = &agent;
+			++zone->agents_count;
+		}
+	}
+
 	void update(RecastZone& zone, float time_delta) {
-		for (auto& agent : m_agents) {
-			if (agent.agent < 0) continue;
-			if (agent.zone != zone.entity) continue;
-			
+		for (u32 i = zone.agents_offset, end = zone.agents_offset + zone.agents_count; i < end; ++i) {
+			Agent& agent = *m_zone_agents[i];
 			const dtCrowdAgent* dt_agent = zone.crowd->getAgent(agent.agent);
 			//if (dt_agent->paused) continue;
 
@@ -386,26 +981,31 @@ struct NavigationModuleImpl final : NavigationModule
 
 	void update(float time_delta) override {
 		PROFILE_FUNCTION();
+		updateStreaming();
+		processMovedObstacles();
+		processTileRebuilds();
 		if (!m_is_game_running) return;
 		
-		for (RecastZone& zone : m_zones) {
-			update(zone, time_delta);
-		}
+		updateZoneAgents();
+		jobs::forEach(m_crowd_zones.size(), 1, [&](i32 idx, i32){
+			update(*m_crowd_zones[idx], time_delta);
+		});
 	}
 
 	void updateParallel(float time_delta) override {
 		if (!m_is_game_running) return;
 		
-		for (RecastZone& zone : m_zones) {
-			if (!zone.crowd) continue;
+		updateZoneAgents();
+		processPathRequests();
+		// every zone has its own crowd and navmesh query, so zones are independent
+		jobs::forEach(m_crowd_zones.size(), 1, [&](i32 idx, i32){
 			PROFILE_BLOCK("dtCrowd::update");
-			zone.crowd->update(time_delta, nullptr);
-		}
+			m_crowd_zones[idx]->crowd->update(time_delta, nullptr);
+		});
 	}
 
+	// computes new transforms of zone's agents, these are written to the world later in a single batch
 	void lateUpdate(RecastZone& zone, float time_delta) {
-		if (!zone.crowd) return;
-		
 		const Transform zone_tr = m_world.getTransform(zone.entity);
 
 		{
@@ -413,16 +1013,15 @@ struct NavigationModuleImpl final : NavigationModule
 			zone.crowd->doMove(time_delta);
 		}
 
-		for (auto& agent : m_agents) {
-			if (agent.agent < 0) continue;
-			if (agent.zone != zone.entity) continue;
-
+		for (u32 i = zone.agents_offset, end = zone.agents_offset + zone.agents_count; i < end; ++i) {
+			Agent& agent = *m_zone_agents[i];
 			const dtCrowdAgent* dt_agent = zone.crowd->getAgent(agent.agent);
 			//if (dt_agent->paused) continue;
 
 			if (agent.flags & Agent::MOVE_ENTITY) {
-				m_moving_agent = agent.entity;
-				m_world.setPosition(agent.entity, zone_tr.transform(*(Vec3*)dt_agent->npos));
+				RigidTransform& tr = m_agent_transforms[i];
+				tr.pos = zone_tr.transform(*(Vec3*)dt_agent->npos);
+				tr.rot = m_world.getRotation(agent.entity);
 
 				Vec3 vel = *(Vec3*)dt_agent->nvel;
 				vel.y = 0;
@@ -431,20 +1030,20 @@ struct NavigationModuleImpl final : NavigationModule
 					vel *= 1 / len;
 					float angle = atan2f(vel.x, vel.z);
 					Quat wanted_rot(Vec3(0, 1, 0), angle);
-					Quat old_rot = m_world.getRotation(agent.entity);
-					Quat new_rot = nlerp(wanted_rot, old_rot, 0.90f);
-					m_world.setRotation(agent.entity, new_rot);
+					tr.rot = nlerp(wanted_rot, tr.rot, 0.90f);
 				}
 			}
 			else {
 				*(Vec3*)dt_agent->npos = Vec3(zone_tr.invTransform(m_world.getPosition(agent.entity)));
 			}
 
+			agent.path_finished = false;
+			if (agent.path_pending) continue;
 			if (dt_agent->ncorners == 0 && dt_agent->targetState != DT_CROWDAGENT_TARGET_REQUESTING) {
 				if (!agent.is_finished) {
 					zone.crowd->resetMoveTarget(agent.agent);
 					agent.is_finished = true;
-					onPathFinished(agent);
+					agent.path_finished = true;
 				}
 			}
 			else if (dt_agent->ncorners == 1 && agent.stop_distance > 0) {
@@ -454,13 +1053,12 @@ struct NavigationModuleImpl final : NavigationModule
 				if (dist_squared < agent.stop_distance * agent.stop_distance) {
 					zone.crowd->resetMoveTarget(agent.agent);
 					agent.is_finished = true;
-					onPathFinished(agent);
+					agent.path_finished = true;
 				}
 			}
 			else {
 				agent.is_finished = false;
 			}
-			m_moving_agent = INVALID_ENTITY;
 		}
 	}
 
@@ -468,8 +1066,30 @@ struct NavigationModuleImpl final : NavigationModule
 		PROFILE_FUNCTION();
 		if (!m_is_game_running) return;
 
-		for (RecastZone& zone : m_zones) {
-			lateUpdate(zone, time_delta);
+		updateZoneAgents();
+		jobs::forEach(m_crowd_zones.size(), 1, [&](i32 idx, i32){
+			lateUpdate(*m_crowd_zones[idx], time_delta);
+		});
+
+		m_moved_entities.clear();
+		m_moved_transforms.clear();
+		m_finished_agents.clear();
+		for (i32 i = 0, c = m_zone_agents.size(); i < c; ++i) {
+			Agent& agent = *m_zone_agents[i];
+			if (agent.path_finished) m_finished_agents.push(agent.entity);
+			if ((agent.flags & Agent::MOVE_ENTITY) == 0) continue;
+			agent.moving = true;
+			m_moved_entities.push(agent.entity);
+			m_moved_transforms.push(m_agent_transforms[i]);
+		}
+
+		m_world.setTransforms(m_moved_entities, m_moved_transforms);
+		for (Agent* agent : m_zone_agents) agent->moving = false;
+
+		// scripts can create or destroy agents, so agents are looked up again
+		for (EntityRef e : m_finished_agents) {
+			auto iter = m_agents.find(e);
+			if (iter.isValid()) onPathFinished(iter.value());
 		}
 	}
 
@@ -679,6 +1299,26 @@ struct NavigationModuleImpl final : NavigationModule
 				LUMIX_DELETE(module.m_allocator, this);
 				return;
 			}
+
+			bool streamed = false;
+			if (has_header && header.version > NavmeshHeader::FIRST) file.read(streamed);
+			if (streamed) {
+				// only sizes of tiles are here, tiles are loaded later
+				zone.stream = LUMIX_NEW(module.m_allocator, StreamedZone)(module, entity, module.m_allocator);
+				zone.stream->tiles.resize(zone.m_num_tiles_x * zone.m_num_tiles_z);
+				for (u32 j = 0; j < zone.m_num_tiles_z; ++j) {
+					for (u32 i = 0; i < zone.m_num_tiles_x; ++i) {
+						StreamedTile& tile = zone.stream->tiles[i + j * zone.m_num_tiles_x];
+						tile.stream = zone.stream;
+						tile.x = (u16)i;
+						tile.z = (u16)j;
+						file.read(tile.data_size);
+					}
+				}
+				if (!zone.crowd) module.initCrowd(zone);
+				LUMIX_DELETE(module.m_allocator, this);
+				return;
+			}
 			for (u32 j = 0; j < zone.m_num_tiles_z; ++j) {
 				for (u32 i = 0; i < zone.m_num_tiles_x; ++i) {
 					i32 data_size;
@@ -748,8 +1388,11 @@ struct NavigationModuleImpl final : NavigationModule
 		blob.write(zone.m_num_tiles_z);
 		const dtNavMeshParams* params = zone.navmesh->getParams();
 		blob.write(params, sizeof(*params));
+		const bool streamed = zone.zone.flags & NavmeshZone::STREAMED;
+		blob.write(streamed);
 		OutputMemoryStream compressed(m_allocator);
-		for (u32 j = 0; j < zone.m_num_tiles_z; ++j) {
+		if (streamed && !saveStreamedTiles(zone, blob)) return false;
+		for (u32 j = 0; !streamed && j < zone.m_num_tiles_z; ++j) {
 			for (u32 i = 0; i < zone.m_num_tiles_x; ++i) {
 				const auto* tile = zone.navmesh->getTileAt(i, j, 0);
 				if (tile) {
@@ -782,6 +1425,196 @@ struct NavigationModuleImpl final : NavigationModule
 	}
 
 
+	static Path getTilePath(const RecastZone& zone, u32 x, u32 z) {
+		return Path("navzones/", zone.zone.guid, "_", x, "_", z, ".navtile");
+	}
+
+	// each tile is compressed to its own file, so it can be loaded on its own, blob gets only sizes of tiles
+	bool saveStreamedTiles(const RecastZone& zone, OutputMemoryStream& blob) {
+		FileSystem& fs = m_engine.getFileSystem();
+		OutputMemoryStream compressed(m_allocator);
+		for (u32 j = 0; j < zone.m_num_tiles_z; ++j) {
+			for (u32 i = 0; i < zone.m_num_tiles_x; ++i) {
+				const dtMeshTile* tile = zone.navmesh->getTileAt(i, j, 0);
+				if (!tile && zone.stream) {
+					// not resident, keep what's already on disk
+					blob.write(zone.stream->tiles[i + j * zone.m_num_tiles_x].data_size);
+					continue;
+				}
+
+				const i32 data_size = tile ? tile->dataSize : 0;
+				blob.write(data_size);
+				if (!tile) continue;
+
+				compressed.clear();
+				if (!m_engine.compress(Span<const u8>((const u8*)tile->data, tile->dataSize), compressed)) {
+					logError("Could not compress navmesh, entity", zone.entity.index);
+					return false;
+				}
+				if (!fs.saveContentSync(getTilePath(zone, i, j), compressed)) {
+					logError("Could not save ", getTilePath(zone, i, j));
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	bool getZoneStreamed(EntityRef entity) override {
+		return m_zones[entity].zone.flags & NavmeshZone::STREAMED;
+	}
+
+	void setZoneStreamed(EntityRef entity, bool value) override {
+		if (value) m_zones[entity].zone.flags |= NavmeshZone::STREAMED;
+		else m_zones[entity].zone.flags &= ~NavmeshZone::STREAMED;
+	}
+
+	void setStreamingParams(float radius, u32 memory_budget) override {
+		m_streaming_radius = radius;
+		m_streaming_budget = memory_budget;
+	}
+
+	// marks tiles of streamed zones within streaming radius of pos as needed, and tiles within one more tile as kept,
+	// so tiles on the edge of the radius are not loaded and unloaded again whenever pos moves a little
+	void markNeededTiles(const DVec3& pos) {
+		for (RecastZone& zone : m_zones) {
+			if (!zone.stream) continue;
+			const Vec3 p = Vec3(m_world.getTransform(zone.entity).invTransform(pos));
+			const Vec3 zone_min = -zone.zone.extents;
+			const float tile_size = CELLS_PER_TILE_SIDE * zone.zone.cell_size;
+			auto getRange = [&](float radius, IVec2& from, IVec2& to){
+				from.x = maximum(0, i32(floorf((p.x - zone_min.x - radius) / tile_size)));
+				from.y = maximum(0, i32(floorf((p.z - zone_min.z - radius) / tile_size)));
+				to.x = minimum(i32(zone.m_num_tiles_x) - 1, i32(floorf((p.x - zone_min.x + radius) / tile_size)));
+				to.y = minimum(i32(zone.m_num_tiles_z) - 1, i32(floorf((p.z - zone_min.z + radius) / tile_size)));
+			};
+			IVec2 needed_from, needed_to, kept_from, kept_to;
+			getRange(m_streaming_radius, needed_from, needed_to);
+			getRange(m_streaming_radius + tile_size, kept_from, kept_to);
+			for (i32 z = kept_from.y; z <= kept_to.y; ++z) {
+				for (i32 x = kept_from.x; x <= kept_to.x; ++x) {
+					StreamedTile& tile = zone.stream->tiles[x + z * zone.m_num_tiles_x];
+					if (tile.data_size == 0) continue;
+					const Vec2 center(zone_min.x + (x + 0.5f) * tile_size, zone_min.z + (z + 0.5f) * tile_size);
+					const float priority = squaredLength(center - p.xz());
+					if (tile.kept_frame != m_streaming_frame || priority < tile.priority) tile.priority = priority;
+					tile.kept_frame = m_streaming_frame;
+					if (x >= needed_from.x && x <= needed_to.x && z >= needed_from.y && z <= needed_to.y) {
+						tile.needed_frame = m_streaming_frame;
+					}
+				}
+			}
+		}
+	}
+
+	// only path requests and cached corridors in the tile's zone are affected,
+	// sliced query can't continue, because its open list can contain polygons of the removed tile
+	void removeTile(RecastZone& zone, dtTileRef tile) {
+		m_path_cache.invalidateTile(zone.entity, *zone.navmesh, tile);
+		for (PathRequest& request : m_path_requests) {
+			if (request.zone == zone.entity) {
+				request.started = false;
+				request.end = 0;
+			}
+		}
+		zone.navmesh->removeTile(tile, nullptr, nullptr);
+	}
+
+	void unloadTile(RecastZone& zone, StreamedTile& tile) {
+		if (tile.handle.isValid()) {
+			m_engine.getFileSystem().cancel(tile.handle);
+			tile.handle = FileSystem::AsyncHandle::invalid();
+		}
+		else {
+			ASSERT(tile.resident);
+			removeTile(zone, zone.navmesh->getTileRefAt(tile.x, tile.z, 0));
+			tile.resident = false;
+		}
+		m_streamed_bytes -= tile.data_size;
+	}
+
+	// loads tiles around the active camera and agents, nearest first, and unloads the rest, within m_streaming_budget
+	void updateStreaming() {
+		bool any_streamed = false;
+		for (const RecastZone& zone : m_zones) any_streamed = any_streamed || zone.stream;
+		if (!any_streamed) return;
+
+		PROFILE_FUNCTION();
+		++m_streaming_frame;
+		auto* render_module = static_cast<RenderModule*>(m_world.getModule(types::model_instance));
+		const EntityPtr camera = render_module ? render_module->getActiveCamera() : INVALID_ENTITY;
+		if (camera.isValid()) markNeededTiles(m_world.getPosition((EntityRef)camera));
+		for (const Agent& agent : m_agents) markNeededTiles(m_world.getPosition(agent.entity));
+
+		struct Candidate {
+			RecastZone* zone;
+			StreamedTile* tile;
+		};
+		Array<Candidate> to_load(m_allocator);
+		Array<Candidate> loaded(m_allocator);
+		for (RecastZone& zone : m_zones) {
+			if (!zone.stream) continue;
+			for (StreamedTile& tile : zone.stream->tiles) {
+				const bool in_memory = tile.resident || tile.handle.isValid();
+				const bool needed = tile.needed_frame == m_streaming_frame;
+				const bool kept = tile.kept_frame == m_streaming_frame;
+				if (in_memory && !kept) unloadTile(zone, tile);
+				else if (in_memory) loaded.push({&zone, &tile});
+				else if (needed) to_load.push({&zone, &tile});
+			}
+		}
+
+		sort(to_load.begin(), to_load.end(), [](const Candidate& a, const Candidate& b){ return a.tile->priority < b.tile->priority; });
+		sort(loaded.begin(), loaded.end(), [](const Candidate& a, const Candidate& b){ return a.tile->priority > b.tile->priority; });
+		i32 evict_idx = 0;
+		FileSystem& fs = m_engine.getFileSystem();
+		for (const Candidate& c : to_load) {
+			// make room by unloading tiles farther than this one
+			while (m_streamed_bytes + c.tile->data_size > m_streaming_budget
+				&& evict_idx < loaded.size()
+				&& loaded[evict_idx].tile->priority > c.tile->priority)
+			{
+				unloadTile(*loaded[evict_idx].zone, *loaded[evict_idx].tile);
+				++evict_idx;
+			}
+			if (m_streamed_bytes + c.tile->data_size > m_streaming_budget) break;
+
+			m_streamed_bytes += c.tile->data_size;
+			c.tile->handle = fs.getContent(getTilePath(*c.zone, c.tile->x, c.tile->z), makeDelegate<&StreamedTile::loaded>(c.tile));
+		}
+
+		static u32 streamed_counter = profiler::createCounter("Streamed navmesh (KB)", 0);
+		profiler::pushCounter(streamed_counter, float(m_streamed_bytes / 1024));
+	}
+
+	void onTileLoaded(StreamedZone& stream, StreamedTile& tile, Span<const u8> mem, bool success) {
+		tile.handle = FileSystem::AsyncHandle::invalid();
+		RecastZone& zone = m_zones[stream.zone];
+		ASSERT(zone.stream == &stream);
+
+		u8* data = nullptr;
+		if (success) {
+			data = (u8*)dtAlloc(tile.data_size, DT_ALLOC_PERM);
+			success = m_engine.decompress(mem, Span<u8>(data, tile.data_size));
+		}
+		if (success && dtStatusFailed(zone.navmesh->addTile(data, tile.data_size, DT_TILE_FREE_DATA, 0, nullptr))) {
+			success = false;
+		}
+		if (!success) {
+			logError("Could not load ", getTilePath(zone, tile.x, tile.z));
+			if (data) dtFree(data);
+			m_streamed_bytes -= tile.data_size;
+			// do not try to load it again
+			tile.data_size = 0;
+			return;
+		}
+
+		tile.resident = true;
+		// existing corridors and sliced query stay valid, they just don't use the new tile
+		m_path_cache.invalidatePartial(zone.entity);
+	}
+
+
 	void debugDrawHeightfield(EntityRef zone_entity) override {
 		auto render_module = static_cast<RenderModule*>(m_world.getModule("renderer"));
 		if (!render_module) return;
@@ -1011,6 +1844,8 @@ struct NavigationModuleImpl final : NavigationModule
 	void stopGame() override
 	{
 		m_is_game_running = false;
+		m_zone_agents_dirty = true;
+		m_moved_obstacles.clear();
 		for (RecastZone& zone : m_zones) {
 			if (zone.crowd) {
 				for (Agent& agent : m_agents) {
@@ -1035,11 +1870,22 @@ struct NavigationModuleImpl final : NavigationModule
 		for (RecastZone& zone : m_zones) {
 			if (zone.navmesh && !zone.crowd) initCrowd(zone);
 		}
+
+		// remember where model instances are, so we know which tiles to rebuild when they move or are destroyed
+		m_obstacle_bounds.clear();
+		RenderModule* render_module = static_cast<RenderModule*>(m_world.getModule(types::model_instance));
+		if (render_module) {
+			for (EntityPtr e = render_module->getFirstModelInstance(); e.isValid(); e = render_module->getNextModelInstance(e)) {
+				ObstacleBounds bounds;
+				if (isTrackedObstacle((EntityRef)e) && getObstacleBounds((EntityRef)e, bounds)) m_obstacle_bounds.insert((EntityRef)e, bounds);
+			}
+		}
 	}
 
 
 	bool initCrowd(RecastZone& zone) {
 		ASSERT(!zone.crowd);
+		m_zone_agents_dirty = true;
 
 		zone.crowd = dtAllocCrowd();
 		if (!zone.crowd->init(2000, 4.0f, zone.navmesh)) {
@@ -1077,6 +1923,7 @@ struct NavigationModuleImpl final : NavigationModule
 		if (iter == m_agents.end()) return;
 
 		Agent& agent = iter.value();
+		agent.path_pending = false;
 		if (agent.agent < 0) return;
 		
 		RecastZone* zone = getZone(agent);
@@ -1098,30 +1945,160 @@ struct NavigationModuleImpl final : NavigationModule
 		RecastZone& zone = m_zones[(EntityRef)agent.zone];
 
 		if (!zone.navquery) return false;
+		if (!zone.path_query) return false;
 		if (!zone.crowd) return false;
 
-		dtPolyRef end_poly_ref;
-		dtQueryFilter filter;
-		static const float ext[] = { 1.0f, 20.0f, 1.0f };
-
 		const Transform zone_tr = m_world.getTransform(zone.entity);
 		const Vec3 dest = Vec3(zone_tr.invTransform(world_dest));
+		// destination is not on the navmesh, there's nothing to queue
+		static const float ext[] = { 1.0f, 20.0f, 1.0f };
+		const dtQueryFilter filter;
+		dtPolyRef dest_poly = 0;
+		zone.navquery->findNearestPoly(&dest.x, ext, &filter, &dest_poly, nullptr);
+		if (!dest_poly) return false;
 
-		zone.navquery->findNearestPoly(&dest.x, ext, &filter, &end_poly_ref, 0);
 		dtCrowdAgentParams params = zone.crowd->getAgent(agent.agent)->params;
 		params.maxSpeed = speed;
 		zone.crowd->updateAgentParameters(agent.agent, &params);
-		if (zone.crowd->requestMoveTarget(agent.agent, end_poly_ref, &dest.x)) {
-			agent.stop_distance = stop_distance;
-			agent.is_finished = false;
+
+		// the path is found later by processPathRequests, so many requests in one frame do not cause a spike
+		agent.stop_distance = stop_distance;
+		agent.is_finished = false;
+		agent.path_pending = true;
+		agent.dest = world_dest;
+		++agent.path_request;
+		PathRequest& request = m_path_requests.emplace();
+		request.agent = entity;
+		request.zone = zone.entity;
+		request.request = agent.path_request;
+		request.dest = dest;
+		request.end = dest_poly;
+		request.enqueue_time = os::Timer::getRawTimestamp();
+		return true;
+	}
+
+	// gives the found corridor to the crowd agent, as if dtCrowd found it itself
+	void applyPath(RecastZone& zone, Agent& agent, const PathRequest& request, const dtPolyRef* path, i32 count) {
+		agent.path_pending = false;
+		dtCrowdAgent* dt_agent = zone.crowd->getEditableAgent(agent.agent);
+		if (count == 0 || dt_agent->corridor.getFirstPoly() != path[0]) {
+			// agent left the start polygon while the request was queued, let the crowd find the path
+			if (!zone.crowd->requestMoveTarget(agent.agent, request.end, &request.dest.x)) {
+				logError("requestMoveTarget failed, entity ", agent.entity.index);
+				agent.is_finished = true;
+			}
+			return;
+		}
+
+		float target[3];
+		dtVcopy(target, &request.dest.x);
+		const bool partial = path[count - 1] != request.end;
+		if (partial) zone.path_query->closestPointOnPoly(path[count - 1], &request.dest.x, target, nullptr);
+
+		dt_agent->corridor.setCorridor(target, path, count);
+		dt_agent->boundary.reset();
+		dt_agent->partial = partial;
+		dt_agent->targetRef = request.end;
+		dtVcopy(dt_agent->targetPos, target);
+		dt_agent->targetPathqRef = DT_PATHQ_INVALID;
+		dt_agent->targetReplan = false;
+		dt_agent->targetReplanTime = 0;
+		dt_agent->targetState = DT_CROWDAGENT_TARGET_VALID;
+	}
+
+	// returns false if the request should be dropped
+	bool processPathRequest(PathRequest& request, i32& budget) {
+		auto agent_iter = m_agents.find(request.agent);
+		if (!agent_iter.isValid()) return false;
+		Agent& agent = agent_iter.value();
+		if (!agent.path_pending || agent.path_request != request.request) return false;
+
+		// agent left the zone or the zone's navmesh was unloaded, the request can not be finished
+		auto zone_iter = m_zones.find(request.zone);
+		if (agent.agent < 0 || agent.zone != request.zone || !zone_iter.isValid() || !zone_iter.value().crowd || !zone_iter.value().path_query) {
+			agent.path_pending = false;
+			agent.is_finished = true;
+			return false;
+		}
+		RecastZone& zone = zone_iter.value();
+
+		static const float ext[] = { 1.0f, 20.0f, 1.0f };
+		const dtQueryFilter filter;
+		if (!request.started) {
+			const dtCrowdAgent* dt_agent = zone.crowd->getAgent(agent.agent);
+			request.start = dt_agent->corridor.getFirstPoly();
+			if (!request.end || !zone.navmesh->isValidPolyRef(request.end)) {
+				zone.path_query->findNearestPoly(&request.dest.x, ext, &filter, &request.end, nullptr);
+				--budget;
+			}
+
+			if (const PathCache::Entry* cached = m_path_cache.find(request.zone, request.start, request.end)) {
+				++m_path_cache_hits;
+				applyPath(zone, agent, request, cached->path, cached->count);
+				return false;
+			}
+
+			const dtStatus status = zone.path_query->initSlicedFindPath(request.start, request.end, dt_agent->npos, &request.dest.x, &filter);
+			if (dtStatusFailed(status)) {
+				applyPath(zone, agent, request, nullptr, 0);
+				return false;
+			}
+			request.started = true;
+		}
+
+		i32 iterations = 0;
+		const dtStatus status = zone.path_query->updateSlicedFindPath(budget, &iterations);
+		budget -= maximum(iterations, 1);
+		if (dtStatusInProgress(status)) return true;
+
+		dtPolyRef path[PathCache::MAX_PATH];
+		i32 count = 0;
+		if (dtStatusFailed(status) || dtStatusFailed(zone.path_query->finalizeSlicedFindPath(path, &count, lengthOf(path)))) {
+			count = 0;
 		}
 		else {
-			logError("requestMoveTarget failed, entity ", entity.index);
-			agent.is_finished = true;
+			m_path_cache.insert(request.zone, request.start, request.end, path, count);
 		}
-		return !agent.is_finished;
+		applyPath(zone, agent, request, path, count);
+		return false;
 	}
 
+	void processPathRequests() {
+		PROFILE_FUNCTION();
+		static u32 queued_counter = profiler::createCounter("Queued path requests", 0);
+		static u32 latency_counter = profiler::createCounter("Path request latency (ms)", 0);
+		static u32 cache_counter = profiler::createCounter("Path cache hits", 0);
+		profiler::pushCounter(queued_counter, float(m_path_requests.size()));
+
+		const i32 version = m_navmesh_version;
+		if (version != m_path_cache_version) {
+			// tiles changed, cached corridors and sliced query in progress are not valid anymore
+			m_path_cache_version = version;
+			m_path_cache.clear();
+			for (PathRequest& request : m_path_requests) {
+				request.started = false;
+				request.end = 0;
+			}
+		}
+
+		i32 budget = m_path_query_budget;
+		m_path_cache_hits = 0;
+		u32 processed = 0;
+		const double to_ms = 1000.0 / os::Timer::getFrequency();
+		const u64 now = os::Timer::getRawTimestamp();
+		// requests are processed in order, only the first one can be in progress
+		while (budget > 0 && processed < (u32)m_path_requests.size()) {
+			PathRequest& request = m_path_requests[processed];
+			if (processPathRequest(request, budget)) break;
+			profiler::pushCounter(latency_counter, float((now - request.enqueue_time) * to_ms));
+			++processed;
+		}
+		m_path_requests.eraseRange(0, processed);
+		profiler::pushCounter(cache_counter, float(m_path_cache_hits));
+	}
+
+	void setPathQueryBudget(u32 iterations_per_frame) override { m_path_query_budget = iterations_per_frame; }
+
 	bool generateTileAt(EntityRef zone_entity, const DVec3& world_pos, bool keep_data) override {
 		RecastZone& zone = m_zones[zone_entity];
 		if (!zone.navmesh) return false;
@@ -1137,27 +2114,62 @@ struct NavigationModuleImpl final : NavigationModule
 		return generateTile(zone, zone_entity, x, z, keep_data, mutex);
 	}
 
-	bool generateTile(RecastZone& zone, EntityRef zone_entity, int x, int z, bool keep_data, Mutex& mutex) {
+	bool generateTile(RecastZone& zone, EntityRef zone_entity, int x, int z, bool keep_data, Mutex& mutex, const NavGeometry* geometry = nullptr) {
+		ASSERT(zone.navmesh);
+		u8* nav_data = nullptr;
+		i32 nav_data_size = 0;
+		if (!buildTile(zone.zone, zone_entity, x, z, keep_data ? &zone : nullptr, geometry, nav_data, nav_data_size)) return false;
+		// no geometry in tile
+		if (!nav_data) return true;
+
+		MutexGuard guard(mutex);
+		m_navmesh_version.inc();
+		if (dtStatusFailed(zone.navmesh->addTile(nav_data, nav_data_size, DT_TILE_FREE_DATA, 0, nullptr))) {
+			dtFree(nav_data);
+			logError("Could not add Detour tile.");
+			return false;
+		}
+		return true;
+	}
+
+	// area rasterized into tile x, z, border included
+	static AABB getTileAABB(const NavmeshZone& zone, i32 x, i32 z) {
+		const i32 border_size = int(zone.agent_radius / zone.cell_size + 0.99f) + 3;
+		const float border = (1 + border_size) * zone.cell_size;
+		const float tile_size = CELLS_PER_TILE_SIDE * zone.cell_size;
+		const Vec3 min = -zone.extents;
+		const Vec3 max = zone.extents;
+		const Vec3 bmin(min.x + x * tile_size - border, min.y, min.z + z * tile_size - border);
+		const Vec3 bmax(bmin.x + tile_size + border * 2, max.y, bmin.z + tile_size + border * 2);
+		return AABB(bmin, bmax);
+	}
+
+	// builds detour data of a single tile, does not touch zone's navmesh, so the navmesh can be used while the tile is built
+	// intermediate data are kept in debug_zone, if it's not null
+	// meshes are taken from geometry, if it's not null, see gatherGeometry
+	bool buildTile(const NavmeshZone& zone, EntityRef zone_entity, int x, int z, RecastZone* debug_zone, const NavGeometry* geometry, u8*& nav_data, i32& nav_data_size) {
 		PROFILE_FUNCTION();
 		// TODO some stuff leaks on errors
-		ASSERT(zone.navmesh);
+		const bool keep_data = debug_zone != nullptr;
+		nav_data = nullptr;
+		nav_data_size = 0;
 
 		rcConfig config;
 		static const float DETAIL_SAMPLE_DIST = 6;
 		static const float DETAIL_SAMPLE_MAX_ERROR = 1;
 
-		config.cs = zone.zone.cell_size;
-		config.ch = zone.zone.cell_height;
-		config.walkableSlopeAngle = zone.zone.walkable_slope_angle;
-		config.walkableHeight = int(zone.zone.agent_height / config.ch + 0.99f);
-		config.walkableClimb = int(zone.zone.max_climb / config.ch);
-		config.walkableRadius = int(zone.zone.agent_radius / config.cs + 0.99f);
+		config.cs = zone.cell_size;
+		config.ch = zone.cell_height;
+		config.walkableSlopeAngle = zone.walkable_slope_angle;
+		config.walkableHeight = int(zone.agent_height / config.ch + 0.99f);
+		config.walkableClimb = int(zone.max_climb / config.ch);
+		config.walkableRadius = int(zone.agent_radius / config.cs + 0.99f);
 		config.maxEdgeLen = int(12 / config.cs);
 		config.maxSimplificationError = 1.3f;
 		config.minRegionArea = 8 * 8;
 		config.mergeRegionArea = 20 * 20;
 		config.maxVertsPerPoly = 6;
-		config.detailSampleDist = DETAIL_SAMPLE_DIST < 0.9f ? 0 : zone.zone.cell_size * DETAIL_SAMPLE_DIST;
+		config.detailSampleDist = DETAIL_SAMPLE_DIST < 0.9f ? 0 : zone.cell_size * DETAIL_SAMPLE_DIST;
 		config.detailSampleMaxError = config.ch * DETAIL_SAMPLE_MAX_ERROR;
 		config.borderSize = config.walkableRadius + 3;
 		config.tileSize = CELLS_PER_TILE_SIDE;
@@ -1165,19 +2177,14 @@ struct NavigationModuleImpl final : NavigationModule
 		config.height = config.tileSize + config.borderSize * 2;
 
 		rcContext ctx;
-		const Vec3 min = -zone.zone.extents;
-		const Vec3 max = zone.zone.extents;
-		Vec3 bmin(min.x + x * CELLS_PER_TILE_SIDE * zone.zone.cell_size - (1 + config.borderSize) * config.cs,
-			min.y,
-			min.z + z * CELLS_PER_TILE_SIDE * zone.zone.cell_size - (1 + config.borderSize) * config.cs);
-		Vec3 bmax(bmin.x + CELLS_PER_TILE_SIDE * zone.zone.cell_size + (1 + config.borderSize) * config.cs * 2,
-			max.y,
-			bmin.z + CELLS_PER_TILE_SIDE * zone.zone.cell_size + (1 + config.borderSize) * config.cs * 2);
+		const AABB tile_aabb = getTileAABB(zone, x, z);
+		const Vec3 bmin = tile_aabb.min;
+		const Vec3 bmax = tile_aabb.max;
 		if (keep_data) m_debug_tile_origin = bmin;
 		rcVcopy(config.bmin, &bmin.x);
 		rcVcopy(config.bmax, &bmax.x);
 		rcHeightfield* solid = rcAllocHeightfield();
-		zone.debug_heightfield = keep_data ? solid : nullptr;
+		if (keep_data) debug_zone->debug_heightfield = solid;
 		if (!solid) {
 			logError("Could not generate navmesh: Out of memory 'solid'.");
 			return false;
@@ -1190,15 +2197,14 @@ struct NavigationModuleImpl final : NavigationModule
 			return false;
 		}
 
-		const Transform tr = m_world.getTransform(zone_entity);
-		rasterizeGeometry(tr, AABB(bmin, bmax), ctx, config, *solid);
+		rasterizeGeometry(zone_entity, tile_aabb, ctx, config, *solid, geometry, x, z);
 
 		rcFilterLowHangingWalkableObstacles(&ctx, config.walkableClimb, *solid);
 		rcFilterLedgeSpans(&ctx, config.walkableHeight, config.walkableClimb, *solid);
 		rcFilterWalkableLowHeightSpans(&ctx, config.walkableHeight, *solid);
 
 		rcCompactHeightfield* chf = rcAllocCompactHeightfield();
-		zone.debug_compact_heightfield = keep_data ? chf : nullptr;
+		if (keep_data) debug_zone->debug_compact_heightfield = chf;
 		if (!chf) {
 			logError("Could not generate navmesh: Out of memory 'chf'.");
 			return false;
@@ -1209,7 +2215,7 @@ struct NavigationModuleImpl final : NavigationModule
 			return false;
 		}
 
-		if (!zone.debug_heightfield) rcFreeHeightField(solid);
+		if (!keep_data) rcFreeHeightField(solid);
 
 		if (!rcErodeWalkableArea(&ctx, config.walkableRadius, *chf)) {
 			logError("Could not generate navmesh: Could not erode.");
@@ -1227,7 +2233,7 @@ struct NavigationModuleImpl final : NavigationModule
 		}
 
 		rcContourSet* cset = rcAllocContourSet();
-		zone.debug_contours = keep_data ? cset : nullptr;
+		if (keep_data) debug_zone->debug_contours = cset;
 		if (!cset) {
 			ctx.log(RC_LOG_ERROR, "Could not generate navmesh: Out of memory 'cset'.");
 			return false;
@@ -1249,7 +2255,7 @@ struct NavigationModuleImpl final : NavigationModule
 		}
 		
 		rcPolyMeshDetail* detail_mesh = nullptr;
-		if (zone.zone.flags & NavmeshZone::DETAILED) {
+		if (zone.flags & NavmeshZone::DETAILED) {
 			detail_mesh = rcAllocPolyMeshDetail();
 			if (!detail_mesh) {
 				logError("Could not generate navmesh: Out of memory 'pmdtl'.");
@@ -1263,11 +2269,8 @@ struct NavigationModuleImpl final : NavigationModule
 			}
 		}
 
-		if (!zone.debug_compact_heightfield) rcFreeCompactHeightfield(chf);
-		if (!zone.debug_contours) rcFreeContourSet(cset);
-
-		unsigned char* nav_data = 0;
-		int nav_data_size = 0;
+		if (!keep_data) rcFreeCompactHeightfield(chf);
+		if (!keep_data) rcFreeContourSet(cset);
 
 		for (int i = 0; i < polymesh->npolys; ++i) {
 			polymesh->flags[i] = polymesh->areas[i] == RC_WALKABLE_AREA ? 1 : 0;
@@ -1299,7 +2302,6 @@ struct NavigationModuleImpl final : NavigationModule
 		params.ch = config.ch;
 		params.buildBvTree = false;
 
-		MutexGuard guard(mutex);
 		if (!dtCreateNavMeshData(&params, &nav_data, &nav_data_size)) {
 			if (polymesh->npolys == 0) {
 				// no geometry in tile
@@ -1313,12 +2315,6 @@ struct NavigationModuleImpl final : NavigationModule
 
 		rcFreePolyMesh(polymesh);
 		if (detail_mesh) rcFreePolyMeshDetail(detail_mesh);
-
-		if (dtStatusFailed(zone.navmesh->addTile(nav_data, nav_data_size, DT_TILE_FREE_DATA, 0, nullptr))) {
-			logError("Could not add Detour tile.");
-			return false;
-		}
-
 		return true;
 	}
 
@@ -1342,6 +2338,12 @@ struct NavigationModuleImpl final : NavigationModule
 			logError("Could not init Detour navmesh query");
 			return false;
 		}
+
+		zone.path_query = dtAllocNavMeshQuery();
+		if (!zone.path_query || dtStatusFailed(zone.path_query->init(zone.navmesh, 2048))) {
+			logError("Could not init Detour navmesh query");
+			return false;
+		}
 		return true;
 	}
 
@@ -1350,6 +2352,8 @@ struct NavigationModuleImpl final : NavigationModule
 	}
 
 	struct NavmeshBuildJobImpl : NavmeshBuildJob {
+		NavmeshBuildJobImpl(IAllocator& allocator) : geometry(allocator) {}
+
 		~NavmeshBuildJobImpl() {
 			jobs::wait(&signal);
 		}
@@ -1369,7 +2373,7 @@ struct NavigationModuleImpl final : NavigationModule
 					return;
 				}
 
-				if (!module->generateTile(*zone, zone_entity, i % zone->m_num_tiles_x, i / zone->m_num_tiles_x, false, mutex)) {
+				if (!module->generateTile(*zone, zone_entity, i % zone->m_num_tiles_x, i / zone->m_num_tiles_x, false, mutex, &geometry)) {
 					fail_counter.inc();
 				}
 				else {
@@ -1382,9 +2386,13 @@ struct NavigationModuleImpl final : NavigationModule
 
 		void run() {
 			total = zone->m_num_tiles_x * zone->m_num_tiles_z;
-			for (u8 i = 0; i < jobs::getWorkersCount() - 1; ++i) {
-				pushJob();
-			}
+			// tile jobs only read the gathered geometry, so they start after it's complete
+			jobs::runLambda([this](){
+				module->gatherGeometry(*zone, geometry);
+				for (u8 i = 0; i < jobs::getWorkersCount() - 1; ++i) {
+					pushJob();
+				}
+			}, &signal);
 		}
 
 		i32 total;
@@ -1395,6 +2403,7 @@ struct NavigationModuleImpl final : NavigationModule
 		RecastZone* zone;
 		EntityRef zone_entity;
 		NavigationModuleImpl* module;
+		NavGeometry geometry;
 
 		jobs::Counter signal;
 	};
@@ -1432,7 +2441,7 @@ struct NavigationModuleImpl final : NavigationModule
 			}
 		}
 
-		NavmeshBuildJobImpl* job = LUMIX_NEW(m_allocator, NavmeshBuildJobImpl);
+		NavmeshBuildJobImpl* job = LUMIX_NEW(m_allocator, NavmeshBuildJobImpl)(m_allocator);
 		job->zone = &zone;
 		job->zone_entity = zone_entity;
 		job->module = this;
@@ -1443,6 +2452,7 @@ struct NavigationModuleImpl final : NavigationModule
 
 	void addCrowdAgent(Agent& agent, RecastZone& zone) {
 		ASSERT(zone.crowd);
+		m_zone_agents_dirty = true;
 
 		const Transform zone_tr = m_world.getTransform(zone.entity);
 		const Vec3 pos = Vec3(zone_tr.invTransform(m_world.getPosition(agent.entity)));
@@ -1467,10 +2477,12 @@ struct NavigationModuleImpl final : NavigationModule
 		zone.zone.flags = NavmeshZone::AUTOLOAD | NavmeshZone::DETAILED;
 		zone.entity = entity;
 		m_zones.insert(entity, zone);
+		m_zone_agents_dirty = true;
 		m_world.onComponentCreated(entity, types::navmesh_zone, this);
 	}
 
 	void destroyZone(EntityRef entity) override {
+		m_zone_agents_dirty = true;
 		for (Agent& agent : m_agents) {
 			if (agent.zone == entity) agent.zone = INVALID_ENTITY;
 		}
@@ -1491,6 +2503,7 @@ struct NavigationModuleImpl final : NavigationModule
 	}
 
 	void assignZone(Agent& agent) {
+		m_zone_agents_dirty = true;
 		const DVec3 agent_pos = m_world.getPosition(agent.entity);
 		for (RecastZone& zone : m_zones) {
 			const Transform zone_tr = m_world.getTransform(zone.entity);
@@ -1518,6 +2531,7 @@ struct NavigationModuleImpl final : NavigationModule
 		agent.is_finished = true;
 		assignZone(agent);
 		m_agents.insert(entity, agent);
+		m_zone_agents_dirty = true;
 		m_world.onComponentCreated(entity, types::navmesh_agent, this);
 	}
 
@@ -1529,6 +2543,7 @@ struct NavigationModuleImpl final : NavigationModule
 			if (zone.crowd && agent.agent >= 0) zone.crowd->removeAgent(agent.agent);
 		}
 		m_agents.erase(iter);
+		m_zone_agents_dirty = true;
 		m_world.onComponentDestroyed(entity, types::navmesh_agent, this);
 	}
 
@@ -1599,6 +2614,7 @@ struct NavigationModuleImpl final : NavigationModule
 			}
 
 			m_zones.insert(e, zone);
+			m_zone_agents_dirty = true;
 			m_world.onComponentCreated(e, types::navmesh_zone, this);
 			if (version > (i32)NavigationModuleVersion::ZONE_GUID && (zone.zone.flags & NavmeshZone::AUTOLOAD) != 0) {
 				loadZone(e);
@@ -1620,6 +2636,7 @@ struct NavigationModuleImpl final : NavigationModule
 			m_agents.insert(agent.entity, agent);
 			m_world.onComponentCreated(agent.entity, types::navmesh_agent, this);
 		}
+		m_zone_agents_dirty = true;
 	}
 
 
@@ -1692,7 +2709,36 @@ struct NavigationModuleImpl final : NavigationModule
 	Engine& m_engine;
 	HashMap<EntityRef, RecastZone> m_zones;
 	HashMap<EntityRef, Agent> m_agents;
-	EntityPtr m_moving_agent = INVALID_ENTITY;
+	// agents grouped by zone, rebuilt when agents, zones or crowds change
+	Array<RecastZone*> m_crowd_zones;
+	Array<Agent*> m_zone_agents;
+	Array<RigidTransform> m_agent_transforms;
+	bool m_zone_agents_dirty = true;
+	Array<EntityRef> m_moved_entities;
+	Array<RigidTransform> m_moved_transforms;
+	Array<EntityRef> m_finished_agents;
+	Array<PathRequest> m_path_requests;
+	PathCache m_path_cache;
+	u32 m_path_cache_hits = 0;
+	i32 m_path_query_budget = 1000;
+	// incremented when navmesh tiles change
+	AtomicI32 m_navmesh_version = 0;
+	i32 m_path_cache_version = 0;
+	Array<DirtyTile> m_dirty_tiles;
+	HashMap<u64, bool> m_dirty_tiles_lookup;
+	Array<TileRebuild*> m_tile_rebuilds;
+	jobs::Counter m_tile_rebuild_signal;
+	u32 m_max_tile_rebuilds = 2;
+	HashMap<EntityRef, ObstacleBounds> m_obstacle_bounds;
+	// explicitly (un)tracked obstacles, see isTrackedObstacle
+	HashMap<EntityRef, bool> m_obstacle_overrides;
+	Mutex m_moved_obstacles_mutex;
+	Array<EntityRef> m_moved_obstacles;
+	float m_streaming_radius = 150;
+	u32 m_streaming_budget = 64 * 1024 * 1024;
+	// uncompressed size of resident and loading tiles
+	u32 m_streamed_bytes = 0;
+	u32 m_streaming_frame = 0;
 	bool m_is_game_running = false;
 	
 	Vec3 m_debug_tile_origin;
@@ -1700,6 +2746,11 @@ struct NavigationModuleImpl final : NavigationModule
 };
 
 
+void StreamedTile::loaded(Span<const u8> mem, bool success) {
+	stream->module.onTileLoaded(*stream, *this, mem, success);
+}
+
+
 UniquePtr<NavigationModule> NavigationModule::create(Engine& engine, ISystem& system, World& world, IAllocator& allocator)
 {
 	return UniquePtr<NavigationModuleImpl>::create(allocator, engine, system, world, allocator);
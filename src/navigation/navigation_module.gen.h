@@ -24,6 +24,7 @@ reflection::build_module("navigation")
 			.minAttribute(0)
 		.prop<&NavigationModule::getZoneAutoload, &NavigationModule::setZoneAutoload>("Autoload")
 		.prop<&NavigationModule::getZoneDetailed, &NavigationModule::setZoneDetailed>("Detailed")
+		.prop<&NavigationModule::getZoneStreamed, &NavigationModule::setZoneStreamed>("Streamed")
 	.cmp<&NavigationModule::createAgent, &NavigationModule::destroyAgent>("navmesh_agent", "Navigation / Agent")
 		.function<(bool (NavigationModule::*)(EntityRef entity, const struct DVec3& dest, float speed, float stop_distance))&NavigationModule::navigate>("navigate")
 		.function<(void (NavigationModule::*)(EntityRef entity))&NavigationModule::cancelNavigation>("cancelNavigation")
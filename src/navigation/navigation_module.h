@@ -21,7 +21,9 @@ struct IAllocator;
 struct NavmeshZone {
 	enum Flags {
 		AUTOLOAD = 1 << 0,
-		DETAILED = 1 << 1
+		DETAILED = 1 << 1,
+		// tiles are saved to separate files and loaded around the camera and agents
+		STREAMED = 1 << 2
 	};
 	Vec3 extents;						//@ property 
 	u64 guid;
@@ -58,6 +60,8 @@ struct NavigationModule : IModule {
 	virtual void setZoneAutoload(EntityRef entity, bool value) = 0;
 	virtual bool getZoneDetailed(EntityRef entity) = 0;
 	virtual void setZoneDetailed(EntityRef entity, bool value) = 0;
+	virtual bool getZoneStreamed(EntityRef entity) = 0;
+	virtual void setZoneStreamed(EntityRef entity, bool value) = 0;
 	virtual bool saveZone(EntityRef zone_entity) = 0;
 	//@ end
 	virtual void createZone(EntityRef entity) = 0;
@@ -85,6 +89,18 @@ struct NavigationModule : IModule {
 	virtual const dtCrowdAgent* getDetourAgent(EntityRef entity) = 0;
 	virtual bool isNavmeshReady(EntityRef zone) const = 0;
 	virtual bool hasDebugDrawData(EntityRef zoneko) const = 0;
+	// navigate() only queues a path request, queued requests are processed with this many pathfinding iterations per frame
+	virtual void setPathQueryBudget(u32 iterations_per_frame) = 0;
+	// tiles overlapping the world space box are rebuilt in the background and swapped in without reloading the navmesh,
+	// moved model instances are tracked while the game is running, other changes (e.g. terrain edits) must be reported here
+	virtual void markDirty(const DVec3& min, const DVec3& max) = 0;
+	// model instances are tracked only if the entity has no agent, animator, physical controller or rigid actor,
+	// use this to track (or ignore) other entities, agents are never tracked
+	virtual void setObstacleTracked(EntityRef entity, bool tracked) = 0;
+	virtual void setMaxTileRebuilds(u32 count) = 0;
+	// tiles of streamed zones within radius of the active camera or an agent are loaded, nearest first,
+	// while uncompressed size of loaded tiles fits in memory_budget, loaded tiles are unloaded only when they are one tile beyond radius
+	virtual void setStreamingParams(float radius, u32 memory_budget) = 0;
 };
 
 
@@ -679,6 +679,15 @@ struct PhysicsUIPlugin final : StudioApp::GUIPlugin
 		}
 	}
 
+	void onSimulationGUI(WorldEditor& editor) {
+		if (!ImGui::CollapsingHeader("Simulation")) return;
+
+		auto* module = static_cast<PhysicsModule*>(editor.getWorld()->getModule("physics"));
+		bool async = module->isAsyncSimulationEnabled();
+		if (ImGui::Checkbox("Async simulation", &async)) module->enableAsyncSimulation(async);
+		if (ImGui::IsItemHovered()) ImGui::SetTooltip("Simulate in parallel with rendering, contacts are reported one frame later.");
+	}
+
 	void onDebugGUI(WorldEditor& editor) {
 		if (!ImGui::CollapsingHeader("Debug")) return;
 
@@ -780,6 +789,7 @@ struct PhysicsUIPlugin final : StudioApp::GUIPlugin
 			WorldEditor& editor = m_app.getWorldEditor();
 			onLayersGUI();
 			onCollisionMatrixGUI();
+			onSimulationGUI(editor);
 			onRagdollGUI(editor);
 			onDebugGUI(editor);
 		}
@@ -22,6 +22,7 @@
 #include <PxRigidActor.h>
 #include <PxRigidStatic.h>
 #include <PxScene.h>
+#include <PxSceneLock.h>
 #include <PxSimulationEventCallback.h>
 #include <task/PxCpuDispatcher.h>
 #include <task/PxTask.h>
@@ -73,6 +74,7 @@ enum class PhysicsModuleVersion
 	INSTANCED_MESH,
 	MATERIAL,
 	CCD,
+	ASYNC_SIMULATION,
 
 	LATEST,
 };
@@ -361,6 +363,8 @@ struct PhysicsModuleImpl final : PhysicsModule
 		DynamicType dynamic_type = DynamicType::STATIC;
 		bool is_trigger = false;
 		bool ccd = false;
+		// transform is being written from physx, so it must not be written back
+		bool syncing_from_physx = false;
 	};
 
 
@@ -409,6 +413,7 @@ struct PhysicsModuleImpl final : PhysicsModule
 	const char* getName() const override { return "physics"; }
 
 	~PhysicsModuleImpl() {
+		finishSimulation();
 		for (auto& controller : m_controllers) {
 			controller.controller->release();
 		}
@@ -1727,20 +1732,36 @@ struct PhysicsModuleImpl final : PhysicsModule
 	void updateDynamicActors(bool vehicles)
 	{
 		PROFILE_FUNCTION();
-		for (EntityRef e : m_dynamic_actors) {
-			RigidActor& actor = m_actors[e];
-			m_update_in_progress = &actor;
-			PxTransform trans = actor.physx_actor->getGlobalPose();
-			m_world.setTransform(actor.entity, fromPhysx(trans));
-		}
-		m_update_in_progress = nullptr;
+		// only actors moved by the last simulation are reported, sleeping actors cost nothing
+		PxU32 active_count;
+		PxActor** active_actors = m_scene->getActiveActors(active_count);
+		m_synced_entities.clear();
+		m_synced_transforms.clear();
+		for (PxU32 i = 0; i < active_count; ++i) {
+			const EntityRef e = EntityRef{(i32)(intptr_t)active_actors[i]->userData};
+			auto iter = m_actors.find(e);
+			// controllers, vehicles and instanced actors have their own update
+			if (!iter.isValid()) continue;
+			RigidActor& actor = iter.value();
+			if (actor.physx_actor != active_actors[i] || actor.dynamic_type != DynamicType::DYNAMIC) continue;
+
+			actor.syncing_from_physx = true;
+			m_synced_entities.push(e);
+			m_synced_transforms.push(fromPhysx(extrapolatePose(actor.physx_actor)));
+		}
+		m_world.setTransforms(m_synced_entities, m_synced_transforms);
+		for (EntityRef e : m_synced_entities) {
+			m_actors[e].syncing_from_physx = false;
+		}
+		static u32 active_counter = profiler::createCounter("Physics active actors", 0);
+		profiler::pushCounter(active_counter, float(m_synced_entities.size()));
 
 		if (!vehicles) return;
 
 		for (auto iter : m_vehicles.iterated()) {
 			Vehicle* veh = iter.value().get();
 			if (veh->actor) {
-				const PxTransform car_trans = veh->actor->getGlobalPose();
+				const PxTransform car_trans = extrapolatePose(veh->actor);
 				m_world.setTransform(iter.key(), fromPhysx(car_trans));
 
 				EntityPtr wheels[4];
@@ -1774,6 +1795,43 @@ struct PhysicsModuleImpl final : PhysicsModule
 	}
 
 
+	// wait for the simulation started asynchronously in previous frame's lateUpdate
+	void finishSimulation() {
+		m_async_extrapolation = 0;
+		if (!m_is_simulating) return;
+		fetchResults();
+		m_is_simulating = false;
+	}
+
+
+	// with async simulation, fetched poses are one frame old, i.e. at the time the previous frame was rendered,
+	// so transforms are moved forward by the current frame's delta using the bodies' velocities;
+	// PhysX poses are not changed, only the entities' transforms
+	PxTransform extrapolatePose(const PxRigidActor* actor) const {
+		PxTransform pose = actor->getGlobalPose();
+		if (m_async_extrapolation <= 0) return pose;
+		const PxRigidBody* body = actor->is<PxRigidBody>();
+		if (!body) return pose;
+
+		pose.p += body->getLinearVelocity() * m_async_extrapolation;
+		const PxVec3 ang_vel = body->getAngularVelocity();
+		const float speed = ang_vel.magnitude();
+		if (speed > 1e-5f) {
+			pose.q = (PxQuat(speed * m_async_extrapolation, ang_vel / speed) * pose.q).getNormalized();
+		}
+		return pose;
+	}
+
+
+	void enableAsyncSimulation(bool enable) override {
+		if (!enable) finishSimulation();
+		m_async_simulation = enable;
+	}
+
+
+	bool isAsyncSimulationEnabled() const override { return m_async_simulation; }
+
+
 	void updateControllers(float time_delta)
 	{
 		PROFILE_FUNCTION();
@@ -1843,9 +1901,7 @@ struct PhysicsModuleImpl final : PhysicsModule
 		}
 	}
 
-	void lateUpdate(float time_delta) override {
-		if (!m_is_game_running) return;
-
+	void applyRootMotion() {
 		AnimationModule* anim_module = (AnimationModule*)m_world.getModule("animation");
 		if (!anim_module) return;
 
@@ -1858,10 +1914,23 @@ struct PhysicsModuleImpl final : PhysicsModule
 			}
 		}
 	}
+
+	void lateUpdate(float time_delta) override {
+		if (!m_is_game_running) return;
+
+		applyRootMotion();
+
+		if (m_async_simulation) {
+			// gameplay of this frame is done, simulate while the frame is rendered, results are fetched in next updateParallel
+			simulateScene(minimum(1 / 20.0f, time_delta));
+			m_is_simulating = true;
+		}
+	}
 	
 	const Array<EntityRef>& getDynamicActors() override { return m_dynamic_actors; }
 
 	void forceUpdateDynamicActors(float time_delta) override {
+		finishSimulation();
 		simulateScene(time_delta);
 		fetchResults();
 		updateDynamicActors(false);
@@ -1871,6 +1940,15 @@ struct PhysicsModuleImpl final : PhysicsModule
 		if (!m_is_game_running) return;
 
 		time_delta = minimum(1 / 20.0f, time_delta);
+		if (m_async_simulation) {
+			const bool fetched = m_is_simulating;
+			finishSimulation();
+			if (fetched) m_async_extrapolation = time_delta;
+			// vehicles are updated with this frame's delta, the scene is simulated with the same delta in lateUpdate
+			updateVehicles(time_delta);
+			return;
+		}
+
 		updateVehicles(time_delta);
 		simulateScene(time_delta);
 		fetchResults();
@@ -2276,7 +2354,10 @@ struct PhysicsModuleImpl final : PhysicsModule
 	}
 
 
-	void stopGame() override { m_is_game_running = false; }
+	void stopGame() override {
+		finishSimulation();
+		m_is_game_running = false;
+	}
 
 
 	float getControllerRadius(EntityRef entity) override { return m_controllers[entity].radius; }
@@ -2430,16 +2511,20 @@ struct PhysicsModuleImpl final : PhysicsModule
 	};
 
 	bool sweepSphere(DVec3 pos, float radius, Vec3 dir, float distance, SweepHit& result, EntityPtr ignored, i32 layer) override {
+		return sweepSphere({pos, radius, dir, distance, ignored, layer}, result);
+	}
+
+	bool sweepSphere(const SweepSphereQuery& query, SweepHit& result) {
 		PxSweepBuffer hit; 
-		physx::PxSphereGeometry sphere(radius);
-		physx::PxTransform transform(toPhysx(pos), physx::PxIdentity);
+		physx::PxSphereGeometry sphere(query.radius);
+		physx::PxTransform transform(toPhysx(query.pos), physx::PxIdentity);
 		Filter filter;
-		filter.entity = ignored;
-		filter.layer = layer;
+		filter.entity = query.ignored;
+		filter.layer = query.layer;
 		filter.module = this;
 		PxQueryFilterData filter_data;
 		filter_data.flags = PxQueryFlag::eDYNAMIC | PxQueryFlag::eSTATIC | PxQueryFlag::ePREFILTER;
-		if (!m_scene->sweep(sphere, transform, toPhysx(dir), distance, hit, physx::PxHitFlag::eDEFAULT, filter_data, &filter)) return INVALID_ENTITY;
+		if (!m_scene->sweep(sphere, transform, toPhysx(query.dir), query.distance, hit, physx::PxHitFlag::eDEFAULT, filter_data, &filter)) return false;
 		if (!hit.hasBlock) return false;
 		result.entity = EntityPtr{(int)(intptr_t)hit.block.actor->userData};
 		result.position = fromPhysx(hit.block.position);
@@ -2455,16 +2540,20 @@ struct PhysicsModuleImpl final : PhysicsModule
 		EntityPtr ignored,
 		int layer) override
 	{
-		PxVec3 physx_origin(origin.x, origin.y, origin.z);
-		PxVec3 unit_dir(dir.x, dir.y, dir.z);
-		PxReal max_distance = distance;
+		return raycast({origin, dir, distance, ignored, layer}, result);
+	}
+
+	bool raycast(const RaycastQuery& query, RaycastHit& result) {
+		PxVec3 physx_origin(query.origin.x, query.origin.y, query.origin.z);
+		PxVec3 unit_dir(query.dir.x, query.dir.y, query.dir.z);
+		PxReal max_distance = query.distance;
 
 		const PxHitFlags flags = PxHitFlag::ePOSITION | PxHitFlag::eNORMAL;
 		PxRaycastBuffer hit;
 
 		Filter filter;
-		filter.entity = ignored;
-		filter.layer = layer;
+		filter.entity = query.ignored;
+		filter.layer = query.layer;
 		filter.module = this;
 		PxQueryFilterData filter_data;
 		filter_data.flags = PxQueryFlag::eDYNAMIC | PxQueryFlag::eSTATIC | PxQueryFlag::ePREFILTER;
@@ -2484,6 +2573,68 @@ struct PhysicsModuleImpl final : PhysicsModule
 		return status;
 	}
 
+	bool overlapSphere(const OverlapSphereQuery& query, EntityPtr& result) {
+		PxOverlapBuffer hit;
+		physx::PxSphereGeometry sphere(query.radius);
+		physx::PxTransform transform(toPhysx(query.pos), physx::PxIdentity);
+		Filter filter;
+		filter.entity = query.ignored;
+		filter.layer = query.layer;
+		filter.module = this;
+		PxQueryFilterData filter_data;
+		filter_data.flags = PxQueryFlag::eDYNAMIC | PxQueryFlag::eSTATIC | PxQueryFlag::ePREFILTER | PxQueryFlag::eANY_HIT;
+		result = INVALID_ENTITY;
+		if (!m_scene->overlap(sphere, transform, hit, filter_data, &filter)) return false;
+		if (!hit.hasBlock) return false;
+		result = EntityPtr{(int)(intptr_t)hit.block.actor->userData};
+		return true;
+	}
+
+	// runs `query(i)` for all queries on job workers, returns number of hits
+	template <typename F>
+	u32 runQueryBatch(u32 count, const F& query) {
+		PROFILE_FUNCTION();
+		profiler::pushInt("count", count);
+		AtomicI32 hits = 0;
+		jobs::forEach(count, 64, [&](i32 from, i32 to){
+			PROFILE_BLOCK("physics queries");
+			PxSceneReadLock lock(*m_scene);
+			i32 local_hits = 0;
+			for (i32 i = from; i < to; ++i) {
+				if (query(i)) ++local_hits;
+			}
+			hits.add(local_hits);
+		});
+		return (u32)(i32)hits;
+	}
+
+	u32 raycastBatch(Span<const RaycastQuery> queries, Span<RaycastHit> results) override {
+		ASSERT(queries.length() == results.length());
+		return runQueryBatch(queries.length(), [&](i32 i){
+			RaycastHit& hit = results[i];
+			if (raycast(queries[i], hit) && hit.entity.isValid()) return true;
+			hit.entity = INVALID_ENTITY;
+			return false;
+		});
+	}
+
+	u32 sweepSphereBatch(Span<const SweepSphereQuery> queries, Span<SweepHit> results) override {
+		ASSERT(queries.length() == results.length());
+		return runQueryBatch(queries.length(), [&](i32 i){
+			SweepHit& hit = results[i];
+			if (sweepSphere(queries[i], hit)) return true;
+			hit.entity = INVALID_ENTITY;
+			return false;
+		});
+	}
+
+	u32 overlapSphereBatch(Span<const OverlapSphereQuery> queries, Span<EntityPtr> results) override {
+		ASSERT(queries.length() == results.length());
+		return runQueryBatch(queries.length(), [&](i32 i){
+			return overlapSphere(queries[i], results[i]);
+		});
+	}
+
 	void onEntityDestroyed(EntityRef entity)
 	{
 		for (int i = 0, c = m_joints.size(); i < c; ++i)
@@ -2510,7 +2661,7 @@ struct PhysicsModuleImpl final : PhysicsModule
 		auto iter = m_actors.find(entity);
 		ASSERT(iter.isValid());
 		RigidActor& actor = iter.value();
-		if (actor.physx_actor && m_update_in_progress != &actor) {
+		if (actor.physx_actor && !actor.syncing_from_physx) {
 			Transform trans = m_world.getTransform(entity);
 			if (actor.dynamic_type == DynamicType::KINEMATIC) {
 				auto* rigid_dynamic = (PxRigidDynamic*)actor.physx_actor;
@@ -3167,6 +3318,7 @@ struct PhysicsModuleImpl final : PhysicsModule
 
 		serializeJoints(serializer);
 		serializeVehicles(serializer);
+		serializer.write(m_async_simulation);
 	}
 
 
@@ -3595,6 +3747,11 @@ struct PhysicsModuleImpl final : PhysicsModule
 
 		deserializeJoints(serializer, entity_map);
 		deserializeVehicles(serializer, entity_map, version);
+		if (version > (i32)PhysicsModuleVersion::ASYNC_SIMULATION) {
+			bool async_simulation;
+			serializer.read(async_simulation);
+			enableAsyncSimulation(async_simulation);
+		}
 	}
 
 
@@ -3838,10 +3995,15 @@ struct PhysicsModuleImpl final : PhysicsModule
 	PxRaycastQueryResult* m_vehicle_results;
 
 	Array<EntityRef> m_dynamic_actors;
-	RigidActor* m_update_in_progress;
+	Array<EntityRef> m_synced_entities;
+	Array<RigidTransform> m_synced_transforms;
 	EntityPtr m_moving_controller = INVALID_ENTITY;
 	DelegateList<void(const ContactData&)> m_contact_callbacks;
 	bool m_is_game_running;
+	bool m_async_simulation = false;
+	bool m_is_simulating = false;
+	// time by which dynamic actors' transforms are extrapolated, see extrapolatePose
+	float m_async_extrapolation = 0;
 	u32 m_debug_visualization_flags;
 	CPUDispatcher m_cpu_dispatcher;
 	CollisionLayers& m_layers;
@@ -3865,7 +4027,8 @@ PhysicsModuleImpl::PhysicsModuleImpl(Engine& engine, World& world, PhysicsSystem
 	, m_joints(m_allocator)
 	, m_script_module(nullptr)
 	, m_debug_visualization_flags(0)
-	, m_update_in_progress(nullptr)
+	, m_synced_entities(m_allocator)
+	, m_synced_transforms(m_allocator)
 	, m_vehicle_batch_query(nullptr)
 	, m_system(&system)
 	, m_hit_report(*this)
@@ -3890,6 +4053,7 @@ UniquePtr<PhysicsModule> PhysicsModule::create(PhysicsSystem& system, World& wor
 	sceneDesc.filterShader = impl->filterShader;
 	sceneDesc.simulationEventCallback = &impl->m_contact_callback;
 	sceneDesc.flags |= PxSceneFlag::eENABLE_CCD;
+	sceneDesc.flags |= PxSceneFlag::eENABLE_ACTIVE_ACTORS;
 
 	impl->m_scene = system.getPhysics()->createScene(sceneDesc);
 	if (!impl->m_scene)
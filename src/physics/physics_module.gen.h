@@ -43,6 +43,7 @@ struct DynamicTypeEnum : reflection::EnumAttribute {
 reflection::build_module("physics")
 	.function<(EntityPtr (PhysicsModule::*)(Vec3 origin, Vec3 dir, float distance, EntityPtr ignore_entity))&PhysicsModule::raycast>("raycast")
 	.function<(void (PhysicsModule::*)(Vec3 gravity))&PhysicsModule::setGravity>("setGravity")
+	.function<(void (PhysicsModule::*)(bool enable))&PhysicsModule::enableAsyncSimulation>("enableAsyncSimulation")
 	.cmp<&PhysicsModule::createHeightfield, &PhysicsModule::destroyHeightfield>("physical_heightfield", "Physics / Heightfield")
 		.prop<&PhysicsModule::getHeightfieldSource, &PhysicsModule::setHeightfieldSource>("Heightmap")
 			.resourceAttribute(Texture::TYPE)
@@ -2,6 +2,7 @@
 
 #include "core/allocator.h"
 #include "core/math.h"
+#include "core/span.h"
 
 #include "engine/plugin.h"
 
@@ -79,6 +80,30 @@ struct PhysicsModule : IModule {
 		EntityRef e2;
 	};
 
+	struct RaycastQuery {
+		Vec3 origin;
+		Vec3 dir; // normalized
+		float distance;
+		EntityPtr ignored = INVALID_ENTITY;
+		i32 layer = -1;
+	};
+
+	struct SweepSphereQuery {
+		DVec3 pos;
+		float radius;
+		Vec3 dir; // normalized
+		float distance;
+		EntityPtr ignored = INVALID_ENTITY;
+		i32 layer = -1;
+	};
+
+	struct OverlapSphereQuery {
+		DVec3 pos;
+		float radius;
+		EntityPtr ignored = INVALID_ENTITY;
+		i32 layer = -1;
+	};
+
 	static UniquePtr<PhysicsModule> create(PhysicsSystem& system, World& world, Engine& engine, IAllocator& allocator);
 	static void reflect();
 
@@ -86,13 +111,26 @@ struct PhysicsModule : IModule {
 	virtual void forceUpdateDynamicActors(float time_delta) = 0;
 	virtual const Array<EntityRef>& getDynamicActors() = 0;
 	virtual DelegateList<void(const ContactData&)>& onContact() = 0;
+	virtual bool isAsyncSimulationEnabled() const = 0;
 	
 	//@ functions
 	virtual EntityPtr raycast(Vec3 origin, Vec3 dir, float distance, EntityPtr ignore_entity) = 0;
 	virtual void setGravity(Vec3 gravity) = 0;
+	// simulation is started at the end of the frame (lateUpdate) and its results are fetched at the start of the next frame,
+	// so it runs in parallel with rendering; fetched poses are one frame old, dynamic actors' and vehicles' transforms
+	// are extrapolated by the frame's delta to compensate, but contacts and joint breaks are reported one frame later
+	// saved with the world, off by default
+	virtual void enableAsyncSimulation(bool enable) = 0;
 	//@ end
 	virtual bool raycastEx(Vec3 origin, Vec3 dir, float distance, RaycastHit& result, EntityPtr ignored, i32 layer) = 0;
 	virtual bool sweepSphere(DVec3 pos, float radius, Vec3 dir, float distance, SweepHit& result, EntityPtr ignored, i32 layer) = 0;
+	// batched queries are executed in parallel on job workers, the calls return when all queries are done
+	// results must have the same size as queries, entity in result is INVALID_ENTITY if the query does not hit anything
+	// returns number of queries with a hit, must not be called while the scene is simulating, i.e. outside of world update with async simulation
+	virtual u32 raycastBatch(Span<const RaycastQuery> queries, Span<RaycastHit> results) = 0;
+	virtual u32 sweepSphereBatch(Span<const SweepSphereQuery> queries, Span<SweepHit> results) = 0;
+	// any overlapping entity, not necessarily the closest one
+	virtual u32 overlapSphereBatch(Span<const OverlapSphereQuery> queries, Span<EntityPtr> results) = 0;
 
 	virtual void createInstancedMesh(EntityRef entity) = 0;
 	virtual void createInstancedCube(EntityRef entity) = 0;
@@ -13,9 +13,15 @@
 
 #include "cooking/PxCooking.h"
 #include "engine/engine.h"
+#include "engine/file_system.h"
+#include "core/atomic.h"
+#include "core/hash.h"
 #include "core/log.h"
+#include "core/os.h"
+#include "core/path.h"
 #include "core/profiler.h"
 #include "engine/resource_manager.h"
+#include "core/stream.h"
 #include "core/string.h"
 #include "engine/world.h"
 #include "physics/physics_resources.h"
@@ -88,6 +94,18 @@ namespace Lumix
 
 	struct PhysicsSystemImpl final : PhysicsSystem
 	{
+		// bump when cooking params change, so blobs cooked with old params are not reused
+		static constexpr u32 COOKING_VERSION = 2;
+		static constexpr const char* COOKING_CACHE_DIR = ".lumix/resources/cooked_physics";
+
+		struct CookingCacheHeader {
+			static const u32 MAGIC = '_PHC';
+			u32 magic = MAGIC;
+			u32 version = COOKING_VERSION;
+			u32 physx_version = PX_PHYSICS_VERSION;
+			u32 size = 0;
+		};
+
 		explicit PhysicsSystemImpl(Engine& engine)
 			: m_allocator(engine.getAllocator(), "physics")
 			, m_engine(engine)
@@ -122,7 +140,10 @@ namespace Lumix
 			ASSERT(m_physics);
 
 			physx::PxTolerancesScale scale;
-			m_cooking = PxCreateCooking(PX_PHYSICS_VERSION, *m_foundation, physx::PxCookingParams(scale));
+			physx::PxCookingParams cooking_params(scale);
+			// cooking happens at import, so do all the preprocessing there, loading a cooked blob is then just deserialization
+			cooking_params.midphaseDesc = physx::PxMeshMidPhase::eBVH34;
+			m_cooking = PxCreateCooking(PX_PHYSICS_VERSION, *m_foundation, cooking_params);
 
 			if (!PxInitVehicleSDK(*m_physics)) {
 				ASSERT(false);
@@ -187,7 +208,68 @@ namespace Lumix
 			return connected;
 		}
 
+		// cooked blobs are cached by content hash, so reimporting unchanged geometry does not cook it again
+		static Path getCookingCachePath(StableHash hash) { return Path(COOKING_CACHE_DIR, "/", hash.getHashValue(), ".phc"); }
+
+		// truncated files (e.g. the editor crashed while writing) and files from other versions are ignored and cooked again
+		bool readCookingCache(StableHash hash, IOutputStream& blob) {
+			OutputMemoryStream cached(m_allocator);
+			FileSystem& fs = m_engine.getFileSystem();
+			const Path path = getCookingCachePath(hash);
+			if (!fs.fileExists(path)) return false;
+			if (!fs.getContentSync(path, cached)) return false;
+			if (cached.size() < sizeof(CookingCacheHeader)) return false;
+
+			CookingCacheHeader header;
+			memcpy(&header, cached.data(), sizeof(header));
+			if (header.magic != CookingCacheHeader::MAGIC) return false;
+			if (header.version != COOKING_VERSION || header.physx_version != PX_PHYSICS_VERSION) return false;
+			if (header.size != cached.size() - sizeof(header)) return false;
+			return blob.write(cached.data() + sizeof(header), header.size);
+		}
+
+		// written to a temporary file first and renamed, so readers never see a partially written blob
+		void writeCookingCache(StableHash hash, Span<const u8> cooked) {
+			FileSystem& fs = m_engine.getFileSystem();
+			if (!os::makePath(fs.getFullPath(COOKING_CACHE_DIR).c_str())) {
+				logWarning("Could not create ", COOKING_CACHE_DIR);
+				return;
+			}
+
+			OutputMemoryStream data(m_allocator);
+			CookingCacheHeader header;
+			header.size = cooked.length();
+			data.reserve(sizeof(header) + cooked.length());
+			data.write(header);
+			data.write(cooked.begin(), cooked.length());
+
+			// the same geometry can be cooked on several threads at once, each needs its own temporary file
+			const Path path = getCookingCachePath(hash);
+			const Path tmp_path(path.c_str(), ".", m_cooking_cache_tmp_counter.inc(), ".tmp");
+			if (!fs.saveContentSync(tmp_path, data)) {
+				logWarning("Could not write ", tmp_path);
+				return;
+			}
+			if (!fs.moveFile(tmp_path, path)) {
+				logWarning("Could not move ", tmp_path, " to ", path);
+				if (!fs.deleteFile(tmp_path)) logWarning("Could not delete ", tmp_path);
+			}
+		}
+
+		static StableHash getCookingHash(u32 kind, Span<const Vec3> verts, Span<const u32> indices) {
+			RollingStableHasher hasher;
+			hasher.begin();
+			const u32 header[] = { COOKING_VERSION, kind };
+			hasher.update(header, sizeof(header));
+			hasher.update(verts.begin(), verts.length() * sizeof(Vec3));
+			hasher.update(indices.begin(), indices.length() * sizeof(u32));
+			return hasher.end64();
+		}
+
 		bool cookTriMesh(Span<const Vec3> verts, Span<const u32> indices, IOutputStream& blob) override {
+			PROFILE_FUNCTION();
+			const StableHash hash = getCookingHash(0, verts, indices);
+			if (readCookingCache(hash, blob)) return true;
 
 			physx::PxTriangleMeshDesc meshDesc;
 			meshDesc.points.count = verts.length();
@@ -198,19 +280,31 @@ namespace Lumix
 			meshDesc.triangles.stride = 3 * sizeof(physx::PxU32);
 			meshDesc.triangles.data = indices.begin();
 
-			OutputStream writeBuffer(blob);
-			return m_cooking->cookTriangleMesh(meshDesc, writeBuffer);
+			OutputMemoryStream cooked(m_allocator);
+			OutputStream writeBuffer(cooked);
+			if (!m_cooking->cookTriangleMesh(meshDesc, writeBuffer)) return false;
+
+			writeCookingCache(hash, cooked);
+			return blob.write(cooked.data(), cooked.size());
 		}
 
 		bool cookConvex(Span<const Vec3> verts, IOutputStream& blob) override {
+			PROFILE_FUNCTION();
+			const StableHash hash = getCookingHash(1, verts, {});
+			if (readCookingCache(hash, blob)) return true;
+
 			physx::PxConvexMeshDesc meshDesc;
 			meshDesc.points.count = verts.length();
 			meshDesc.points.stride = sizeof(Vec3);
 			meshDesc.points.data = verts.begin();
 			meshDesc.flags = physx::PxConvexFlag::eCOMPUTE_CONVEX;
 
-			OutputStream writeBuffer(blob);
-			return m_cooking->cookConvexMesh(meshDesc, writeBuffer);
+			OutputMemoryStream cooked(m_allocator);
+			OutputStream writeBuffer(cooked);
+			if (!m_cooking->cookConvexMesh(meshDesc, writeBuffer)) return false;
+
+			writeCookingCache(hash, cooked);
+			return blob.write(cooked.data(), cooked.size());
 		}
 
 		int getCollisionsLayersCount() const override { return m_layers.count; }
@@ -245,6 +339,7 @@ namespace Lumix
 		CollisionLayers m_layers;
 		physx::PxPvd* m_pvd = nullptr;
 		physx::PxPvdTransport* m_pvd_transport = nullptr;
+		AtomicI32 m_cooking_cache_tmp_counter = 0;
 	};
 
 	LUMIX_PLUGIN_ENTRY(physics) {
@@ -34,6 +34,7 @@ struct PhysicsSystem : ISystem {
 	virtual int getCollisionsLayersCount() const = 0;
 	virtual void addCollisionLayer() = 0;
 	virtual void removeCollisionLayer() = 0;
+	// cooking functions can be called from multiple threads at once, cooked blobs are cached in .lumix/resources/cooked_physics
 	virtual bool cookTriMesh(Span<const struct Vec3> verts, Span<const u32> indices, struct IOutputStream& blob) = 0;
 	virtual bool cookConvex(Span<const Vec3> verts, IOutputStream& blob) = 0;
 };
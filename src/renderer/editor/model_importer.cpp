@@ -1,4 +1,5 @@
 #include "animation/animation.h"
+#include "core/atomic.h"
 #include "core/job_system.h"
 #include "core/log.h"
 #include "core/os.h"
@@ -36,6 +37,7 @@ struct BitWriter {
 		: blob(blob)
 	{
 		const u64 offset = blob.size();
+		blob.reserve(blob.size() + (total_bits + 7) / 8 + sizeof(u64)); // write() touches 8 bytes
 		blob.resize(blob.size() + (total_bits + 7) / 8);
 		ptr = blob.getMutableData() + offset;
 		memset(ptr, 0, (total_bits + 7) / 8);
@@ -67,12 +69,14 @@ struct TranslationTrack {
 	Vec3 min, max;
 	u8 bitsizes[4] = {};
 	bool is_const = false;
+	bool is_keyframed = false;
 };
 
 struct RotationTrack {
 	Quat min, max;
 	u8 bitsizes[4];
 	bool is_const;
+	bool is_keyframed = false;
 	u8 skipped_channel;
 };
 
@@ -104,6 +108,14 @@ u64 pack(const Quat& r, const RotationTrack& track) {
 	return res;
 }
 
+// with sign bit of the skipped channel
+u64 packRotation(const Quat& q, const RotationTrack& track) {
+	u64 packed = pack(q, track);
+	packed <<= 1;
+	packed |= (&q.x)[track.skipped_channel] < 0 ? 1 : 0;
+	return packed;
+}
+
 u64 pack(const Vec3& p, const TranslationTrack& track) {
 	u64 res = 0;
 	res |= pack(p.z, track.min.z, track.max.z - track.min.z, track.bitsizes[2]);
@@ -187,6 +199,95 @@ static i32 getParentIndex(Span<const ModelImporter::Bone> bones, const ModelImpo
 	return -1;
 }
 
+// keyframe reduction tolerances, chosen so that the model space error of any bone stays under `error`:
+// the error is split evenly along the deepest chain and rotation tolerance is scaled by how far the bone reaches
+struct KeyframeTolerance {
+	float translation;
+	float rotation; // radians
+};
+
+static void computeKeyframeTolerances(Span<const ModelImporter::Bone> bones, float error, Array<KeyframeTolerance>& tolerances) {
+	const u32 count = bones.length();
+	tolerances.resize(count);
+	Array<i32> parents(tolerances.getAllocator());
+	Array<u32> depths(tolerances.getAllocator());
+	Array<float> reaches(tolerances.getAllocator());
+	parents.resize(count);
+	depths.resize(count);
+	reaches.resize(count);
+
+	u32 max_depth = 1;
+	for (u32 i = 0; i < count; ++i) {
+		// bones are sorted, parents are before children
+		parents[i] = getParentIndex(bones, bones[i]);
+		depths[i] = parents[i] < 0 ? 1 : depths[parents[i]] + 1;
+		max_depth = maximum(max_depth, depths[i]);
+		// leaf bones still move skinned vertices, we consider them to be as long as the bone itself
+		const Vec3 pos = bones[i].bind_pose_matrix.getTranslation();
+		reaches[i] = parents[i] < 0 ? 0 : length(pos - bones[parents[i]].bind_pose_matrix.getTranslation());
+	}
+
+	for (u32 i = 0; i < count; ++i) {
+		const Vec3 pos = bones[i].bind_pose_matrix.getTranslation();
+		for (i32 p = parents[i]; p >= 0; p = parents[p]) {
+			reaches[p] = maximum(reaches[p], length(pos - bones[p].bind_pose_matrix.getTranslation()));
+		}
+	}
+
+	const float bone_error = error / max_depth;
+	for (u32 i = 0; i < count; ++i) {
+		tolerances[i].translation = bone_error;
+		tolerances[i].rotation = bone_error / maximum(reaches[i], bone_error);
+	}
+}
+
+static float getKeyError(const ModelImporter::Key& a, const ModelImporter::Key& b, const ModelImporter::Key& key, float t, bool rotation) {
+	if (rotation) {
+		const Quat q = nlerp(a.rot, b.rot, t);
+		const float d = fabsf(q.x * key.rot.x + q.y * key.rot.y + q.z * key.rot.z + q.w * key.rot.w);
+		return 2 * acosf(minimum(d, 1.f));
+	}
+	return length(lerp(a.pos, b.pos, t) - key.pos);
+}
+
+// frames of keys to keep, first and last frame are always kept, Douglas-Peucker - frame with the largest
+// error splits a segment between two kept keys, until interpolation reproduces all frames within `tolerance`
+static void reduceKeys(const Array<ModelImporter::Key>& keys, bool rotation, float tolerance, Array<u16>& kept) {
+	kept.clear();
+	kept.push(0);
+	if (keys.size() < 2) return;
+
+	// ends of segments to check, a segment starts at the last kept key, so kept frames are sorted
+	Array<u16> ends(kept.getAllocator());
+	ends.push(keys.size() - 1);
+	while (!ends.empty()) {
+		const u32 from = kept.last();
+		const u32 to = ends.last();
+		float max_error = tolerance;
+		u32 split = from;
+		for (u32 f = from + 1; f < to; ++f) {
+			const float t = (f - from) / float(to - from);
+			const float error = getKeyError(keys[from], keys[to], keys[f], t, rotation);
+			if (error > max_error) {
+				max_error = error;
+				split = f;
+			}
+		}
+		if (split != from) {
+			ends.push(split);
+		}
+		else {
+			kept.push(to);
+			ends.pop();
+		}
+	}
+}
+
+// store only `kept` keys if it's smaller than storing all frames
+static bool isKeyframingWorth(u32 kept_count, u32 frames_count, u32 bitsize) {
+	return u64(kept_count) * (bitsize + 16) < u64(frames_count) * bitsize;
+}
+
 static bool hasAutoLOD(const ModelMeta& meta, u32 idx) {
 	return meta.autolod_mask & (1 << idx);
 }
@@ -1373,14 +1474,25 @@ bool ModelImporter::writePhysics(const Path& src, const ModelMeta& meta) {
 	header.m_convex = (u32)to_convex;
 
 	if (meta.split) {
-		for (const ImportMesh& mesh : m_meshes) {
+		// submeshes are cooked in parallel, each to its own blob
+		Array<OutputMemoryStream> blobs(m_allocator);
+		blobs.reserve(m_meshes.size());
+		for (i32 i = 0; i < m_meshes.size(); ++i) blobs.emplace(m_allocator);
+		Array<float> cook_times(m_allocator);
+		cook_times.resize(m_meshes.size());
+		AtomicI32 failed = 0;
+		jobs::forEach(m_meshes.size(), 1, [&](i32 mesh_idx, i32){
+			PROFILE_BLOCK("cook physics");
+			os::Timer timer;
+			const ImportMesh& mesh = m_meshes[mesh_idx];
 			const ImportGeometry& geom = m_geometries[mesh.geometry_idx];
-			m_out_file.clear();
-			m_out_file.write(&header, sizeof(header));
+			OutputMemoryStream& blob = blobs[mesh_idx];
+			blob.write(&header, sizeof(header));
 
-			verts.clear();
-			int vertex_size = geom.vertex_size;
-			int vertex_count = (i32)(geom.vertex_buffer.size() / vertex_size);
+			Array<Vec3> mesh_verts(m_allocator);
+			const int vertex_size = geom.vertex_size;
+			const int vertex_count = (i32)(geom.vertex_buffer.size() / vertex_size);
+			mesh_verts.reserve(vertex_count);
 
 			const u8* vd = geom.vertex_buffer.data();
 
@@ -1388,31 +1500,31 @@ bool ModelImporter::writePhysics(const Path& src, const ModelMeta& meta) {
 				Vec3 p;
 				memcpy(&p, vd + i * vertex_size, sizeof(p));
 				p = mesh.matrix.transformPoint(p);
-				verts.push(p);
+				mesh_verts.push(p);
 			}
 
-			if (to_convex) {
-				if (!ps->cookConvex(verts, m_out_file)) {
-					logError("Failed to cook ", src);
-					return false;
-				}
-			}
-			else {
-				if (!ps->cookTriMesh(verts, geom.indices, m_out_file)) {
-					logError("Failed to cook ", src);
-					return false;
-				}
+			const bool cooked = to_convex ? ps->cookConvex(mesh_verts, blob) : ps->cookTriMesh(mesh_verts, geom.indices, blob);
+			if (!cooked) {
+				logError("Failed to cook ", mesh.name, " in ", src);
+				failed.inc();
+				return;
 			}
+			cook_times[mesh_idx] = timer.getTimeSinceStart() * 1000;
+		});
+		if (failed > 0) return false;
 
-			Path phy_path(mesh.name, ".phy:", src);
-			AssetCompiler& compiler = m_app.getAssetCompiler();
-			if (!compiler.writeCompiledResource(phy_path, Span(m_out_file.data(), (i32)m_out_file.size()))) {
+		AssetCompiler& compiler = m_app.getAssetCompiler();
+		for (i32 i = 0; i < m_meshes.size(); ++i) {
+			Path phy_path(m_meshes[i].name, ".phy:", src);
+			logInfo("Cooked ", phy_path, " in ", cook_times[i], " ms");
+			if (!compiler.writeCompiledResource(phy_path, Span(blobs[i].data(), (i32)blobs[i].size()))) {
 				return false;
 			}
 		}
 		return true;
 	}
 
+	os::Timer timer;
 	m_out_file.clear();
 	m_out_file.write(&header, sizeof(header));
 
@@ -1469,6 +1581,8 @@ bool ModelImporter::writePhysics(const Path& src, const ModelMeta& meta) {
 		}
 	}
 
+	logInfo("Cooked .phy:", src, " in ", timer.getTimeSinceStart() * 1000, " ms");
+
 	Path phy_path(".phy:", src);
 	AssetCompiler& compiler = m_app.getAssetCompiler();
 	return compiler.writeCompiledResource(phy_path, Span(m_out_file.data(), (i32)m_out_file.size()));
@@ -1535,6 +1649,12 @@ bool ModelImporter::writeAnimations(const Path& src, const ModelMeta& meta) {
 			Array<Array<Key>> all_keys(m_allocator);
 			fillTracks(anim, all_keys, from_sample, samples_count);
 
+			// key frames are stored as u16
+			const bool reduce_keys = meta.anim_keyframe_error > 0 && samples_count > 2 && samples_count <= 0x10000;
+			Array<KeyframeTolerance> tolerances(m_allocator);
+			if (reduce_keys) computeKeyframeTolerances(m_bones, meta.anim_keyframe_error, tolerances);
+			Array<u16> kept_keys(m_allocator);
+
 			{
 				u32 total_bits = 0;
 				u32 translation_curves_count = 0;
@@ -1584,21 +1704,32 @@ bool ModelImporter::writeAnimations(const Path& src, const ModelMeta& meta) {
 						bitsizes[2] = maximum(1, bitsizes[2]);
 						bitsize = (bitsizes[0] + bitsizes[1] + bitsizes[2]);
 
-						translation_tracks[bone_idx].is_const = false;
-						write(Animation::TrackType::ANIMATED);
+						TranslationTrack& track = translation_tracks[bone_idx];
+						track.is_const = false;
+						memcpy(track.bitsizes, bitsizes, sizeof(bitsizes));
+						track.max = max;
+						track.min = min;
+
+						if (reduce_keys) reduceKeys(keys, false, tolerances[bone_idx].translation, kept_keys);
+						track.is_keyframed = reduce_keys && isKeyframingWorth(kept_keys.size(), keys.size(), bitsize);
+						write(track.is_keyframed ? Animation::TrackType::KEYFRAMED : Animation::TrackType::ANIMATED);
 
 						write(min);
 						write((max.x - min.x) / ((1 << bitsizes[0]) - 1));
 						write((max.y - min.y) / ((1 << bitsizes[1]) - 1));
 						write((max.z - min.z) / ((1 << bitsizes[2]) - 1));
 						write(bitsizes);
-						write(offset_bits);
-						offset_bits += bitsize;
-
-						memcpy(translation_tracks[bone_idx].bitsizes, bitsizes, sizeof(bitsizes));
-						translation_tracks[bone_idx].max = max;
-						translation_tracks[bone_idx].min = min;
-						total_bits += bitsize * keys.size();
+						if (track.is_keyframed) {
+							write((u32)kept_keys.size());
+							for (u16 frame : kept_keys) write(frame);
+							BitWriter key_writer(m_out_file, bitsize * kept_keys.size());
+							for (u16 frame : kept_keys) key_writer.write(pack(keys[frame].pos, track), bitsize);
+						}
+						else {
+							write(offset_bits);
+							offset_bits += bitsize;
+							total_bits += bitsize * keys.size();
+						}
 					}				
 
 					++translation_curves_count;
@@ -1611,7 +1742,7 @@ bool ModelImporter::writeAnimations(const Path& src, const ModelMeta& meta) {
 						Array<Key>& keys = all_keys[bone_idx];
 						const TranslationTrack& track = translation_tracks[bone_idx];
 
-						if (!keys.empty() && !track.is_const) {
+						if (!keys.empty() && !track.is_const && !track.is_keyframed) {
 							const Key& k = keys[i];
 							Vec3 p = k.pos;
 							const u64 packed = pack(p, track);
@@ -1675,13 +1806,24 @@ bool ModelImporter::writeAnimations(const Path& src, const ModelMeta& meta) {
 					write(keys[0].rot);
 				}
 				else {
-					rotation_tracks[bone_idx].is_const = false;
-					write(Animation::TrackType::ANIMATED);
-
 					u8 skipped_channel = 0;
 					for (u32 i = 1; i < 4; ++i) {
 						if (bitsizes[i] > bitsizes[skipped_channel]) skipped_channel = i;
 					}
+					u8 bitsize = bitsizes[0] + bitsizes[1] + bitsizes[2] + bitsizes[3] + 1;
+					bitsize -= bitsizes[skipped_channel];
+					ASSERT(bitsize > 0 && bitsize <= 64);
+
+					RotationTrack& track = rotation_tracks[bone_idx];
+					track.is_const = false;
+					memcpy(track.bitsizes, bitsizes, sizeof(bitsizes));
+					track.max = max;
+					track.min = min;
+					track.skipped_channel = skipped_channel;
+
+					if (reduce_keys) reduceKeys(keys, true, tolerances[bone_idx].rotation, kept_keys);
+					track.is_keyframed = reduce_keys && isKeyframingWorth(kept_keys.size(), keys.size(), bitsize);
+					write(track.is_keyframed ? Animation::TrackType::KEYFRAMED : Animation::TrackType::ANIMATED);
 
 					for (u32 i = 0; i < 4; ++i) {
 						if (skipped_channel == i) continue;
@@ -1695,19 +1837,20 @@ bool ModelImporter::writeAnimations(const Path& src, const ModelMeta& meta) {
 						if (skipped_channel == i) continue;
 						write(bitsizes[i]);
 					}
-					u8 bitsize = bitsizes[0] + bitsizes[1] + bitsizes[2] + bitsizes[3] + 1;
-					bitsize -= bitsizes[skipped_channel];
-					write(offset_bits);
-					write(skipped_channel);
 
-					offset_bits += bitsize;
-					ASSERT(bitsize > 0 && bitsize <= 64);
-				
-					memcpy(rotation_tracks[bone_idx].bitsizes, bitsizes, sizeof(bitsizes));
-					rotation_tracks[bone_idx].max = max;
-					rotation_tracks[bone_idx].min = min;
-					rotation_tracks[bone_idx].skipped_channel = skipped_channel;
-					total_bits += bitsize * keys.size();
+					if (track.is_keyframed) {
+						write(skipped_channel);
+						write((u32)kept_keys.size());
+						for (u16 frame : kept_keys) write(frame);
+						BitWriter key_writer(m_out_file, bitsize * kept_keys.size());
+						for (u16 frame : kept_keys) key_writer.write(packRotation(keys[frame].rot, track), bitsize);
+					}
+					else {
+						write(offset_bits);
+						write(skipped_channel);
+						offset_bits += bitsize;
+						total_bits += bitsize * keys.size();
+					}
 				}
 				++rotation_curves_count;
 			}
@@ -1720,17 +1863,13 @@ bool ModelImporter::writeAnimations(const Path& src, const ModelMeta& meta) {
 					Array<Key>& keys = all_keys[bone_idx];
 					const RotationTrack& track = rotation_tracks[bone_idx];
 
-					if (!keys.empty() && !track.is_const) {
+					if (!keys.empty() && !track.is_const && !track.is_keyframed) {
 						const Key& k = keys[i];
-						Quat q = k.rot;
 						u32 bitsize = (track.bitsizes[0] + track.bitsizes[1] + track.bitsizes[2] + track.bitsizes[3]);
 						bitsize -= track.bitsizes[track.skipped_channel];
 						++bitsize; // sign bit
 						ASSERT(bitsize <= 64);
-						u64 packed = pack(q, track);
-						packed <<= 1;
-						packed |= (&q.x)[track.skipped_channel] < 0 ? 1 : 0;
-						bit_writer.write(packed, bitsize);
+						bit_writer.write(packRotation(k.rot, track), bitsize);
 					}
 				}
 			}
@@ -102,6 +102,7 @@ struct ModelMeta {
 		WRITE_VALUE(min_bake_vertex_ao, 0.f);
 		WRITE_VALUE(anim_translation_error, 1.f);
 		WRITE_VALUE(anim_rotation_error, 1.f);
+		WRITE_VALUE(anim_keyframe_error, 0.f);
 		if (scene_scale != 1.f) blob << "\nscale = " << scene_scale;
 		WRITE_VALUE(culling_scale, 1.f);
 		WRITE_VALUE(root_motion_flags, Animation::Flags::NONE);
@@ -159,6 +160,7 @@ struct ModelMeta {
 			{ "force_skin", &force_skin },
 			{ "anim_rotation_error", &anim_rotation_error },
 			{ "anim_translation_error", &anim_translation_error },
+			{ "anim_keyframe_error", &anim_keyframe_error },
 			{ "scale", &scene_scale },
 			{ "culling_scale", &culling_scale },
 			{ "split", &split },
@@ -297,6 +299,7 @@ struct ModelMeta {
 	float min_bake_vertex_ao = 0.f;
 	float anim_translation_error = 1.f;
 	float anim_rotation_error = 1.f;
+	float anim_keyframe_error = 0.f; // max model space error of keyframe reduction, 0 keeps all frames
 	float culling_scale = 1.f;
 	float scene_scale = 1.f;
 	Origin origin = Origin::SOURCE;
@@ -2280,6 +2280,8 @@ struct ModelPlugin final : AssetBrowser::IPlugin, AssetCompiler::IPlugin {
 				saveUndo(ImGui::DragFloat("##aert", &m_meta.anim_translation_error, 0.01f));
 				ImGuiEx::Label("Animation rotation error");
 				saveUndo(ImGui::DragFloat("##aerr", &m_meta.anim_rotation_error, 0.01f));
+				ImGuiEx::Label("Keyframe reduction error");
+				saveUndo(ImGui::DragFloat("##aerk", &m_meta.anim_keyframe_error, 0.0001f, 0.f, FLT_MAX, "%.4f"));
 			}
 
 			if (m_meta.clips.empty()) {
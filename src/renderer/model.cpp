@@ -237,9 +237,23 @@ void Model::getRelativePose(Pose& pose)
 }
 
 
+void Model::getRelativePose(Pose& pose, u32 from, u32 to)
+{
+	ASSERT(pose.count == (u32)m_bones.size());
+	ASSERT(from <= to && to <= pose.count);
+	Vec3* pos = pose.positions;
+	Quat* rot = pose.rotations;
+	for (u32 i = from; i < to; ++i)
+	{
+		pos[i] = m_bones[i].relative_transform.pos;
+		rot[i] = m_bones[i].relative_transform.rot;
+	}
+}
+
+
 void Model::getPose(Pose& pose)
 {
-	ASSERT(pose.count == m_bones.size());
+	ASSERT(pose.count == (u32)m_bones.size());
 	Vec3* pos = pose.positions;
 	Quat* rot = pose.rotations;
 	for (int i = 0, c = m_bones.size(); i < c; ++i)
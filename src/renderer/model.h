@@ -191,6 +191,8 @@ struct LUMIX_RENDERER_API Model final : Resource {
 	BoneMap::ConstIterator getBoneIndex(BoneNameHash hash) const { return m_bone_map.find(hash); }
 	void getPose(Pose& pose);
 	void getRelativePose(Pose& pose);
+	// copies bind pose only to bones [from, to), does not change pose.is_absolute
+	void getRelativePose(Pose& pose, u32 from, u32 to);
 	//@ function
 	float getOriginBoundingRadius() const { return m_origin_bounding_radius; }
 	//@ function
@@ -7,6 +7,7 @@
 void runParticleScriptTokenizerTests();
 void runParticleScriptCompilerTests();
 void runParticleScriptCollectorTests();
+void runProfilerTests();
 
 namespace Lumix {
 	int test_count = 0;
@@ -31,6 +32,7 @@ int main(int argc, char* argv[]) {
 	runParticleScriptTokenizerTests();
 	runParticleScriptCompilerTests();
 	runParticleScriptCollectorTests();
+	runProfilerTests();
 	Lumix::logInfo("=== Test Results: ", Lumix::passed_count, "/", Lumix::test_count, " passed ===");
 
 	Lumix::unregisterLogCallback<&consoleLog>();
@@ -0,0 +1,96 @@
+#include "core/allocator.h"
+#include "core/log.h"
+#include "core/os.h"
+#include "core/profiler.h"
+#include "core/stream.h"
+#include "core/string.h"
+#include "tests/common.h"
+
+using namespace Lumix;
+
+namespace {
+
+bool contains(const OutputMemoryStream& json, const char* needle) {
+	StringView haystack((const char*)json.data(), (u32)json.size());
+	return find(haystack, StringView(needle)) != nullptr;
+}
+
+bool testChromeTraceExport() {
+	IAllocator& allocator = getGlobalAllocator();
+	profiler::init(allocator);
+	profiler::beginBlock("test_block");
+	profiler::pushInt("test_int", 42);
+	profiler::beginBlock("nested \"quoted\" block");
+	profiler::endBlock();
+	profiler::endBlock();
+	profiler::frame();
+
+	OutputMemoryStream blob(allocator);
+	profiler::serialize(blob);
+	profiler::shutdown();
+
+	OutputMemoryStream json(allocator);
+	InputMemoryStream input(blob);
+	ASSERT_TRUE(profiler::exportChromeTrace(input, json, allocator), "Export failed");
+	ASSERT_TRUE(contains(json, "\"traceEvents\":["), "Missing traceEvents");
+	ASSERT_TRUE(contains(json, "\"ph\":\"B\",\"ts\":"), "Missing begin event");
+	ASSERT_TRUE(contains(json, "\"name\":\"test_block\""), "Missing block name");
+	ASSERT_TRUE(contains(json, "\"name\":\"nested \\\"quoted\\\" block\""), "Block name not escaped");
+	ASSERT_TRUE(contains(json, "\"name\":\"test_int\",\"args\":{\"value\":42}"), "Missing int");
+	ASSERT_TRUE(contains(json, "\"s\":\"g\",\"name\":\"frame\""), "Missing frame");
+	ASSERT_TRUE(contains(json, "\n]}\n"), "Unterminated trace");
+	return true;
+}
+
+bool testSampling() {
+	IAllocator& allocator = getGlobalAllocator();
+	profiler::init(allocator);
+	profiler::beginBlock("sampled_block");
+	if (!profiler::startSampling(1000)) {
+		// not supported on this platform
+		profiler::endBlock();
+		profiler::shutdown();
+		return true;
+	}
+	ASSERT_TRUE(profiler::isSampling(), "Sampling not started");
+
+	os::Timer timer;
+	volatile u64 sum = 0;
+	while (timer.getTimeSinceStart() < 0.3f) {
+		for (u32 i = 0; i < 10000; ++i) sum = sum + i;
+	}
+	profiler::stopSampling();
+	profiler::endBlock();
+
+	OutputMemoryStream blob(allocator);
+	profiler::serialize(blob);
+	profiler::shutdown();
+
+	OutputMemoryStream json(allocator);
+	InputMemoryStream input(blob);
+	ASSERT_TRUE(profiler::exportChromeTrace(input, json, allocator), "Export failed");
+	ASSERT_TRUE(contains(json, "\"cat\":\"sample\""), "No samples recorded");
+	ASSERT_TRUE(contains(json, "\"args\":{\"stack\":[\""), "Missing sample callstack");
+	return true;
+}
+
+bool testInvalidData() {
+	IAllocator& allocator = getGlobalAllocator();
+	const u32 garbage[] = { 0xffFFffFF, 1, 2, 3 };
+	OutputMemoryStream out(allocator);
+	
+	InputMemoryStream blob(garbage, sizeof(garbage));
+	ASSERT_TRUE(!profiler::exportChromeTrace(blob, out, allocator), "Garbage exported");
+	
+	InputMemoryStream stream(garbage, sizeof(garbage));
+	ASSERT_TRUE(!profiler::streamToBlob(stream, out, allocator), "Garbage stream converted");
+	return true;
+}
+
+} // anonymous namespace
+
+void runProfilerTests() {
+	RUN_TEST(testChromeTraceExport);
+	RUN_TEST(testSampling);
+	RUN_TEST(testInvalidData);
+}
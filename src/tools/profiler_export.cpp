@@ -0,0 +1,90 @@
+// converts profiler captures (.lpd saved by Studio or .lps written by profiler::startStreaming)
+// to Chrome trace event format, which can be opened in chrome://tracing, Perfetto or other tools
+// usage: profiler_export <input.lpd|input.lps> <output.json>
+
+#include "core/debug.h"
+#include "core/default_allocator.h"
+#include "core/log.h"
+#include "core/log_callback.h"
+#include "core/os.h"
+#include "core/profiler.h"
+#include "core/stream.h"
+#include "core/string.h"
+#include <stdio.h>
+#include <string.h>
+
+using namespace Lumix;
+
+static void consoleLog(LogLevel level, const char* message) {
+	const char* prefix = "";
+	switch (level) {
+		case LogLevel::WARNING: prefix = "[WARNING] "; break;
+		case LogLevel::ERROR: prefix = "[ERROR] "; break;
+		default: break;
+	}
+	printf("%s%s\n", prefix, message);
+}
+
+static bool run(int argc, char* argv[], IAllocator& allocator) {
+	if (argc != 3) {
+		logError("Usage: profiler_export <input.lpd|input.lps> <output.json>");
+		return false;
+	}
+
+	os::InputFile file;
+	if (!file.open(argv[1])) {
+		logError("Could not open ", argv[1]);
+		return false;
+	}
+	
+	OutputMemoryStream data(allocator);
+	data.resize(file.size());
+	if (!file.read(data.getMutableData(), data.size())) {
+		logError("Could not read ", argv[1]);
+		file.close();
+		return false;
+	}
+	file.close();
+
+	profiler::StreamHeader header;
+	if (data.size() >= sizeof(header)) memcpy(&header, data.data(), sizeof(header));
+	if (data.size() >= sizeof(header) && header.magic == profiler::StreamHeader::MAGIC) {
+		OutputMemoryStream blob(allocator);
+		InputMemoryStream stream(data);
+		if (!profiler::streamToBlob(stream, blob, allocator)) {
+			logError("Invalid profiler stream ", argv[1]);
+			return false;
+		}
+		data = static_cast<OutputMemoryStream&&>(blob);
+	}
+
+	os::OutputFile out;
+	if (!out.open(argv[2])) {
+		logError("Could not create ", argv[2]);
+		return false;
+	}
+
+	InputMemoryStream blob(data);
+	const bool exported = profiler::exportChromeTrace(blob, out, allocator);
+	out.close();
+	if (!exported) {
+		logError("Invalid profiler data ", argv[1]);
+		return false;
+	}
+	if (out.isError()) {
+		logError("Could not write ", argv[2]);
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char* argv[]) {
+	registerLogCallback<&consoleLog>();
+	DefaultAllocator allocator;
+	debug::init(allocator);
+
+	const bool success = run(argc, argv, allocator);
+
+	unregisterLogCallback<&consoleLog>();
+	return success ? 0 : 1;
+}